@@ -26,6 +26,24 @@ function setData(temperatureC, temperatureF, humidity, pressure, altitude) {
     document.getElementById("altitude").textContent = altitude;
 }
 
+// Show the newest sample of the 1 s history (see /history), so the gauges do
+// not start empty while they wait for the first event
+function loadHistory() {
+    const start = x;
+    fetch("/history?tier=seconds")
+        .then((response) => response.json())
+        .then((history) => {
+            const rows = history.rows.filter((row) => row);
+            if (!rows.length || x !== start) return;
+            const [temperature, humidity, pressure] = rows[rows.length - 1];
+            const temperatureC = temperature / 100;
+            const pressureHPa = pressure / 100;
+            const altitude = 44330 * (1 - Math.pow(pressureHPa / 1013.25, 0.1903));
+            setData(temperatureC, temperatureC * 9 / 5 + 32, humidity / 100, pressureHPa, altitude);
+        })
+        .catch(() => {});
+}
+
 function setSensorStatus(isOnline, ipAddress) {
     const statusElement = document.getElementById("sensor-status");
     if (isOnline) {
@@ -122,6 +140,8 @@ if (!!window.EventSource) {
                 }
             ]
         });
+
+        loadHistory();
     });
 
     source.addEventListener('error', (e) => {
@@ -134,6 +154,11 @@ if (!!window.EventSource) {
         const readings = JSON.parse(e.data);
         setData(readings.temperatureC, readings.temperatureF, readings.humidity, readings.pressure, readings.altitude);
     });
+
+    source.addEventListener('sample', (e) => {
+        const sample = decodeSample(e.data);
+        if (sample) setData(sample.temperatureC, sample.temperatureF, sample.humidity, sample.pressure, sample.altitude);
+    });
 }
 
 // var chart = JSC.chart(
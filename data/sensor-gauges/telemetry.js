@@ -0,0 +1,46 @@
+// Decoder of the CBOR samples sent as base64 "sample" events, see
+// include/MyTelemetryCodec.h. Returns the same fields as the JSON "readings"
+// events, or null if the data is not a sample.
+
+const TELEMETRY_SCHEMA_VERSION = 1;
+const TELEMETRY_FIELDS = ["v", "sequence", "epoch", "temperatureC", "temperatureF", "humidity",
+    "pressure", "altitude", "dewPoint", "absoluteHumidity", "heatIndex", "pressureTendency", "forecast"];
+
+function decodeSample(text) {
+    const data = Uint8Array.from(atob(text), (c) => c.charCodeAt(0));
+    let pos = 0;
+
+    function header() {
+        const initial = data[pos++];
+        let value = initial & 0x1f;
+        if (value >= 24) {
+            if (value > 26) throw new Error("unsupported CBOR item");
+            const n = 1 << (value - 24);
+            value = 0;
+            for (let i = 0; i < n; i++) value = value * 256 + data[pos++];
+        }
+        return [initial >> 5, value];
+    }
+
+    try {
+        const [major, items] = header();
+        if (major !== 4 || (items !== TELEMETRY_FIELDS.length && items !== TELEMETRY_FIELDS.length - 2)) return null;
+
+        const sample = {};
+        for (let i = 0; i < items; i++) {
+            const [type, value] = header();
+            if (type > 1 || value === undefined) return null;
+            sample[TELEMETRY_FIELDS[i]] = type === 1 ? -1 - value : value;
+        }
+        if (sample.v !== TELEMETRY_SCHEMA_VERSION || pos !== data.length) return null;
+
+        // Raw values are hundredths of their unit
+        for (const name of TELEMETRY_FIELDS.slice(3, 12)) {
+            if (name in sample) sample[name] /= 100;
+        }
+        if ("forecast" in sample) sample.forecast = String.fromCharCode(sample.forecast);
+        return sample;
+    } catch (e) {
+        return null;
+    }
+}
@@ -4,228 +4,108 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SH110X.h>
 #include <Arduino.h>
+#include <algorithm>
 
 #include "MyDisplay.h"
 #include "MyLogos.h"
+#include "MyLogosPacked.h"
 
-void testdrawline(Adafruit_SH110X& display);
-void testdrawrect(Adafruit_SH110X& display);
-void testfillrect(Adafruit_SH110X& display);
-void testdrawcircle(Adafruit_SH110X& display);
-void testfillcircle(Adafruit_SH110X& display);
-void testdrawroundrect(Adafruit_SH110X& display);
-void testfillroundrect(Adafruit_SH110X& display);
-void testdrawtriangle(Adafruit_SH110X& display);
-void testfilltriangle(Adafruit_SH110X& display);
-void testdrawchar(Adafruit_SH110X& display);
-void testdrawstyles(Adafruit_SH110X& display);
-void testdrawbitmap(Adafruit_SH110X& display);
 void testanimate(const uint8_t* bitmap, uint8_t w, uint8_t h,
                  Adafruit_SH110X& display);
 void runAdafruitTestSuite(Adafruit_SH110X& display);
 
-/**
- * Run the Adafruit OLED Test Suite on the global `display` object.
- * You need to have initialized the display before calling this function.
- */
-void runAdafruitTestSuite(Adafruit_SH110X& display) {
-    // draw a single pixel
-    display.drawPixel(10, 10, SH110X_WHITE);
-    // Show the display buffer on the hardware.
-    // NOTE: You _must_ call display after making any drawing commands
-    // to make them visible on the display hardware!
-    display.display();
-    delay(2000);
-    display.clearDisplay();
-
-    testdrawline(display);       // Draw many lines
-    testdrawrect(display);       // Draw rectangles (outlines)
-    testfillrect(display);       // Draw rectangles (filled)
-    testdrawcircle(display);     // Draw circles (outlines)
-    testfillcircle(display);     // Draw circles (filled)
-    testdrawroundrect(display);  // Draw rounded rectangles (outlines)
-    testfillroundrect(display);  // Draw rounded rectangles (filled)
-    testdrawtriangle(display);   // Draw triangles (outlines)
-    testfilltriangle(display);   // Draw triangles (filled)
-    testdrawchar(display);       // Draw characters of the default font
-    testdrawstyles(display);     // Draw 'stylized' characters
-    testdrawbitmap(display);     // Draw a small bitmap image
-
-    testanimate(adafruitLogoBmp, ADAFRUIT_LOGO_WIDTH, ADAFRUIT_LOGO_HEIGHT,
-                display);  // Animate bitmaps
-}
-
-// Adafruit Test Suite
-
-void testdrawline(Adafruit_SH110X& display) {
-    int16_t i;
-
-    display.clearDisplay();  // Clear display buffer
-
-    for (i = 0; i < display.width(); i += 4) {
-        display.drawLine(0, 0, i, display.height() - 1, SH110X_WHITE);
-        display.display();  // Update screen with each newly-drawn line
-        delay(1);
-    }
-    for (i = 0; i < display.height(); i += 4) {
-        display.drawLine(0, 0, display.width() - 1, i, SH110X_WHITE);
-        display.display();
-        delay(1);
-    }
-    delay(250);
-
-    display.clearDisplay();
-
-    for (i = 0; i < display.width(); i += 4) {
-        display.drawLine(0, display.height() - 1, i, 0, SH110X_WHITE);
-        display.display();
-        delay(1);
-    }
-    for (i = display.height() - 1; i >= 0; i -= 4) {
-        display.drawLine(0, display.height() - 1, display.width() - 1, i,
-                         SH110X_WHITE);
-        display.display();
-        delay(1);
-    }
-    delay(250);
-
-    display.clearDisplay();
-
-    for (i = display.width() - 1; i >= 0; i -= 4) {
-        display.drawLine(display.width() - 1, display.height() - 1, i, 0,
-                         SH110X_WHITE);
-        display.display();
-        delay(1);
-    }
-    for (i = display.height() - 1; i >= 0; i -= 4) {
-        display.drawLine(display.width() - 1, display.height() - 1, 0, i,
-                         SH110X_WHITE);
-        display.display();
-        delay(1);
-    }
-    delay(250);
-
-    display.clearDisplay();
-
-    for (i = 0; i < display.height(); i += 4) {
-        display.drawLine(display.width() - 1, 0, 0, i, SH110X_WHITE);
-        display.display();
-        delay(1);
-    }
-    for (i = 0; i < display.width(); i += 4) {
-        display.drawLine(display.width() - 1, 0, i, display.height() - 1,
-                         SH110X_WHITE);
-        display.display();
-        delay(1);
+// Primitives
+//
+// Each draws one demo frame into the buffer. `show` is called after every
+// shape: the visual test suite passes showFrame() to animate the drawing on
+// the panel, the benchmark passes nothing and only times the rasterisation.
+
+typedef void (*OledShow)(Adafruit_GFX& display);
+
+void drawlines(Adafruit_GFX& display, OledShow show = nullptr) {
+    // A fan of lines from every corner
+    const int16_t w = display.width() - 1;
+    const int16_t h = display.height() - 1;
+    const int16_t corners[4][2] = {{0, 0}, {0, h}, {w, h}, {w, 0}};
+    for (const int16_t* c : corners) {
+        for (int16_t i = 0; i <= w; i += 4) {
+            display.drawLine(c[0], c[1], i, h - c[1], SH110X_WHITE);
+            if (show) show(display);
+        }
+        for (int16_t i = 0; i <= h; i += 4) {
+            display.drawLine(c[0], c[1], w - c[0], i, SH110X_WHITE);
+            if (show) show(display);
+        }
     }
-
-    delay(2000);  // Pause for 2 seconds
 }
 
-void testdrawrect(Adafruit_SH110X& display) {
-    display.clearDisplay();
-
+void drawrects(Adafruit_GFX& display, OledShow show = nullptr) {
     for (int16_t i = 0; i < display.height() / 2; i += 2) {
         display.drawRect(i, i, display.width() - 2 * i,
                          display.height() - 2 * i, SH110X_WHITE);
-        display.display();  // Update screen with each newly-drawn rectangle
-        delay(1);
+        if (show) show(display);
     }
-
-    delay(2000);
 }
 
-void testfillrect(Adafruit_SH110X& display) {
-    display.clearDisplay();
-
+void fillrects(Adafruit_GFX& display, OledShow show = nullptr) {
     for (int16_t i = 0; i < display.height() / 2; i += 3) {
         // The INVERSE color is used so rectangles alternate white/black
         display.fillRect(i, i, display.width() - i * 2,
                          display.height() - i * 2, SH110X_INVERSE);
-        display.display();  // Update screen with each newly-drawn rectangle
-        delay(1);
+        if (show) show(display);
     }
-
-    delay(2000);
 }
 
-void testdrawcircle(Adafruit_SH110X& display) {
-    display.clearDisplay();
-
+void drawcircles(Adafruit_GFX& display, OledShow show = nullptr) {
     for (int16_t i = 0; i < max(display.width(), display.height()) / 2;
          i += 2) {
         display.drawCircle(display.width() / 2, display.height() / 2, i,
                            SH110X_WHITE);
-        display.display();
-        delay(1);
+        if (show) show(display);
     }
-
-    delay(2000);
 }
 
-void testfillcircle(Adafruit_SH110X& display) {
-    display.clearDisplay();
-
+void fillcircles(Adafruit_GFX& display, OledShow show = nullptr) {
     for (int16_t i = max(display.width(), display.height()) / 2; i > 0;
          i -= 3) {
         // The INVERSE color is used so circles alternate white/black
         display.fillCircle(display.width() / 2, display.height() / 2, i,
                            SH110X_INVERSE);
-        display.display();  // Update screen with each newly-drawn circle
-        delay(1);
+        if (show) show(display);
     }
-
-    delay(2000);
 }
 
-void testdrawroundrect(Adafruit_SH110X& display) {
-    display.clearDisplay();
-
+void drawroundrects(Adafruit_GFX& display, OledShow show = nullptr) {
     for (int16_t i = 0; i < display.height() / 2 - 2; i += 2) {
         display.drawRoundRect(i, i, display.width() - 2 * i,
                               display.height() - 2 * i, display.height() / 4,
                               SH110X_WHITE);
-        display.display();
-        delay(1);
+        if (show) show(display);
     }
-
-    delay(2000);
 }
 
-void testfillroundrect(Adafruit_SH110X& display) {
-    display.clearDisplay();
-
+void fillroundrects(Adafruit_GFX& display, OledShow show = nullptr) {
     for (int16_t i = 0; i < display.height() / 2 - 2; i += 2) {
         // The INVERSE color is used so round-rects alternate white/black
         display.fillRoundRect(i, i, display.width() - 2 * i,
                               display.height() - 2 * i, display.height() / 4,
                               SH110X_INVERSE);
-        display.display();
-        delay(1);
+        if (show) show(display);
     }
-
-    delay(2000);
 }
 
-void testdrawtriangle(Adafruit_SH110X& display) {
-    display.clearDisplay();
-
+void drawtriangles(Adafruit_GFX& display, OledShow show = nullptr) {
     for (int16_t i = 0; i < max(display.width(), display.height()) / 2;
          i += 5) {
         display.drawTriangle(display.width() / 2, display.height() / 2 - i,
                              display.width() / 2 - i, display.height() / 2 + i,
                              display.width() / 2 + i, display.height() / 2 + i,
                              SH110X_WHITE);
-        display.display();
-        delay(1);
+        if (show) show(display);
     }
-
-    delay(2000);
 }
 
-void testfilltriangle(Adafruit_SH110X& display) {
-    display.clearDisplay();
-
+void filltriangles(Adafruit_GFX& display, OledShow show = nullptr) {
     for (int16_t i = max(display.width(), display.height()) / 2; i > 0;
          i -= 5) {
         // The INVERSE color is used so triangles alternate white/black
@@ -233,40 +113,23 @@ void testfilltriangle(Adafruit_SH110X& display) {
                              display.width() / 2 - i, display.height() / 2 + i,
                              display.width() / 2 + i, display.height() / 2 + i,
                              SH110X_INVERSE);
-        display.display();
-        delay(1);
+        if (show) show(display);
     }
-
-    delay(2000);
 }
 
-void testdrawchar(Adafruit_SH110X& display) {
-    display.clearDisplay();
-
-    display.setTextSize(1);              // Normal 1:1 pixel scale
-    display.setTextColor(SH110X_WHITE);  // Draw white text
-    display.setCursor(0, 0);             // Start at top-left corner
+void drawchars(Adafruit_GFX& display, OledShow show = nullptr) {
     display.cp437(true);  // Use full 256 char 'Code Page 437' font
 
     // Not all the characters will fit on the display. This is normal.
     // Library will draw what it can and the rest will be clipped.
     for (int16_t i = 0; i < 256; i++) {
-        if (i == '\n')
-            display.write(' ');
-        else
-            display.write(i);
+        display.write(i == '\n' ? ' ' : i);
     }
-
-    display.display();
-    delay(2000);
+    display.cp437(false);
+    if (show) show(display);
 }
 
-void testdrawstyles(Adafruit_SH110X& display) {
-    display.clearDisplay();
-
-    display.setTextSize(1);              // Normal 1:1 pixel scale
-    display.setTextColor(SH110X_WHITE);  // Draw white text
-    display.setCursor(0, 0);             // Start at top-left corner
+void drawstyles(Adafruit_GFX& display, OledShow show = nullptr) {
     display.println(F("Hello, world!"));
 
     display.setTextColor(SH110X_BLACK, SH110X_WHITE);  // Draw 'inverse' text
@@ -276,20 +139,79 @@ void testdrawstyles(Adafruit_SH110X& display) {
     display.setTextColor(SH110X_WHITE);
     display.print(F("0x"));
     display.println(0xDEADBEEF, HEX);
-
-    display.display();
-    delay(2000);
+    if (show) show(display);
 }
 
-void testdrawbitmap(Adafruit_SH110X& display) {
-    display.clearDisplay();
-
+void drawbitmap(Adafruit_GFX& display, OledShow show = nullptr) {
     display.drawBitmap((display.width() - ADAFRUIT_LOGO_WIDTH) / 2,
                        (display.height() - ADAFRUIT_LOGO_HEIGHT) / 2,
                        adafruitLogoBmp, ADAFRUIT_LOGO_WIDTH,
                        ADAFRUIT_LOGO_HEIGHT, 1);
+    if (show) show(display);
+}
+
+struct OledPrimitive {
+    const char* name;
+    void (*draw)(Adafruit_GFX& display, OledShow show);
+};
+
+const OledPrimitive oledPrimitives[] = {
+    {"lines", drawlines},
+    {"rects", drawrects},
+    {"fillrects", fillrects},
+    {"circles", drawcircles},
+    {"fillcircles", fillcircles},
+    {"roundrects", drawroundrects},
+    {"fillroundrects", fillroundrects},
+    {"triangles", drawtriangles},
+    {"filltriangles", filltriangles},
+    {"chars", drawchars},
+    {"styles", drawstyles},
+    {"bitmap", drawbitmap},
+};
+
+#define OLED_PRIMITIVE_COUNT (sizeof(oledPrimitives) / sizeof(oledPrimitives[0]))
+
+/**
+ * Text settings every primitive starts with.
+ */
+void resetText(Adafruit_GFX& display) {
+    display.setTextSize(1);              // Normal 1:1 pixel scale
+    display.setTextColor(SH110X_WHITE);  // Draw white text
+    display.setCursor(0, 0);             // Start at top-left corner
+}
+
+/**
+ * Update the screen with each newly drawn shape.
+ */
+void showFrame(Adafruit_GFX& display) {
+    static_cast<Adafruit_SH110X&>(display).display();
+    delay(1);
+}
+
+/**
+ * Run the Adafruit OLED Test Suite on the global `display` object.
+ * You need to have initialized the display before calling this function.
+ */
+void runAdafruitTestSuite(Adafruit_SH110X& display) {
+    // draw a single pixel
+    display.drawPixel(10, 10, SH110X_WHITE);
+    // Show the display buffer on the hardware.
+    // NOTE: You _must_ call display after making any drawing commands
+    // to make them visible on the display hardware!
     display.display();
-    delay(1000);
+    delay(2000);
+
+    for (const OledPrimitive& primitive : oledPrimitives) {
+        display.clearDisplay();
+        resetText(display);
+        primitive.draw(display, showFrame);
+        display.display();
+        delay(2000);  // Pause for 2 seconds
+    }
+
+    testanimate(adafruitLogoBmp, ADAFRUIT_LOGO_WIDTH, ADAFRUIT_LOGO_HEIGHT,
+                display);  // Animate bitmaps
 }
 
 #define XPOS 0  // Indexes into the 'icons' array in function below
@@ -341,4 +263,183 @@ void testanimate(const uint8_t* bitmap, uint8_t w, uint8_t h,
     }
 }
 
+// Benchmark
+//
+// Times the rasterisation of every primitive above (drawn into the buffer
+// without display() and delay()) and the flush to the panel, each on its
+// own. The drawing phase never touches the bus.
+
+#define OLED_BENCH_ITERATIONS 50
+
+/**
+ * Min, median and 99th percentile of one benchmark, in cycles.
+ */
+struct OledBenchmarkResult {
+    const char* name;
+    uint32_t min;
+    uint32_t median;
+    uint32_t p99;
+};
+
+OledBenchmarkResult oledSummarize(const char* name, uint32_t* cycles,
+                                  uint16_t n) {
+    std::sort(cycles, cycles + n);
+    return {name, cycles[0], cycles[n / 2], cycles[(n * 99 + 99) / 100 - 1]};
+}
+
+/**
+ * Run every primitive and the flush `iterations` times and print the
+ * results, first as a table and then as CSV lines starting with "BENCH,"
+ * for scripts. Flushes are timed as a full refresh (after invalidate()) and
+ * as a refresh where a single pixel changed.
+ */
+void runOledBenchmark(MyDisplay& display,
+                      uint16_t iterations = OLED_BENCH_ITERATIONS) {
+    OledBenchmarkResult results[OLED_PRIMITIVE_COUNT + 2];
+    uint32_t* cycles = (uint32_t*)malloc(sizeof(uint32_t) * iterations);
+    if (!cycles || !iterations) {
+        free(cycles);
+        Serial.println("[Bench] ERROR: Failed to allocate samples");
+        return;
+    }
+    Adafruit_GFX& gfx = display.getCanvas();
+
+    for (uint8_t b = 0; b < OLED_PRIMITIVE_COUNT; b++) {
+        for (uint16_t i = 0; i < iterations; i++) {
+            display.clear();
+            resetText(gfx);
+            uint32_t start = ESP.getCycleCount();
+            oledPrimitives[b].draw(gfx, nullptr);
+            cycles[i] = ESP.getCycleCount() - start;
+            yield();
+        }
+        results[b] = oledSummarize(oledPrimitives[b].name, cycles, iterations);
+    }
+
+    // The bitmap frame is in the buffer now
+    for (uint16_t i = 0; i < iterations; i++) {
+        display.invalidate();
+        uint32_t start = ESP.getCycleCount();
+        while (!display.flush()) {
+        }
+        cycles[i] = ESP.getCycleCount() - start;
+        yield();
+    }
+    results[OLED_PRIMITIVE_COUNT] = oledSummarize("flush-full", cycles, iterations);
+
+    for (uint16_t i = 0; i < iterations; i++) {
+        gfx.drawPixel(i % gfx.width(), 0, SH110X_INVERSE);
+        uint32_t start = ESP.getCycleCount();
+        while (!display.flush()) {
+        }
+        cycles[i] = ESP.getCycleCount() - start;
+        yield();
+    }
+    results[OLED_PRIMITIVE_COUNT + 1] = oledSummarize("flush-pixel", cycles, iterations);
+    free(cycles);
+
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    Serial.printf("OLED Benchmark, %u iterations at %u MHz:\n", iterations, mhz);
+    Serial.println("                     min   median      p99 (µs)       min    median       p99 (cycles)");
+    for (const OledBenchmarkResult& r : results) {
+        Serial.printf("%-15s %8u %8u %8u       %9u %9u %9u\n", r.name,
+                      r.min / mhz, r.median / mhz, r.p99 / mhz, r.min,
+                      r.median, r.p99);
+    }
+
+    Serial.println("BENCH,name,iterations,min_us,median_us,p99_us,min_cycles,median_cycles,p99_cycles");
+    for (const OledBenchmarkResult& r : results) {
+        Serial.printf("BENCH,%s,%u,%u,%u,%u,%u,%u,%u\n", r.name, iterations,
+                      r.min / mhz, r.median / mhz, r.p99 / mhz, r.min,
+                      r.median, r.p99);
+    }
+    Serial.println();
+}
+
+/**
+ * A logo in both forms: rows for drawBitmap() and packed.
+ */
+struct LogoBenchmark {
+    const char* name;
+    const unsigned char* bitmap;
+    uint8_t width;
+    uint8_t height;
+    const PackedBitmap& packed;
+};
+
+const LogoBenchmark logoBenchmarks[] = {
+    {"adafruit", adafruitLogoBmp, ADAFRUIT_LOGO_WIDTH, ADAFRUIT_LOGO_HEIGHT, adafruitLogoPacked},
+    {"e621", e621_9da280Bmp, E621_9DA280_WIDTH, E621_9DA280_HEIGHT, e621_9da280Packed},
+    {"spinner", spinnerBmp, SPINNER_WIDTH, SPINNER_HEIGHT, spinnerPacked},
+};
+
+/**
+ * Compare the packed logos with drawBitmap(): flash size, drawing a whole
+ * frame (both replace the background) and, for animations, stepping to the
+ * next frame with one delta. Median cycles over `iterations`, each
+ * animation frame in turn.
+ */
+void runLogoBenchmark(MyDisplay& display,
+                      uint16_t iterations = OLED_BENCH_ITERATIONS) {
+    uint32_t* cycles = (uint32_t*)malloc(sizeof(uint32_t) * iterations);
+    if (!cycles || !iterations) {
+        free(cycles);
+        Serial.println("[Bench] ERROR: Failed to allocate samples");
+        return;
+    }
+    Adafruit_GFX& gfx = display.getCanvas();
+    uint8_t* buffer = display.getBuffer();
+    uint32_t mhz = ESP.getCpuFreqMHz();
+
+    Serial.printf("Logo Benchmark, %u iterations at %u MHz:\n", iterations, mhz);
+    Serial.println("Logo        raw B  packed B      drawBitmap    packed draw     step (µs)");
+    for (const LogoBenchmark& logo : logoBenchmarks) {
+        const PackedBitmap& packed = logo.packed;
+        uint16_t stride = (logo.width + 7) / 8 * logo.height;
+        display.clear();
+
+        for (uint16_t i = 0; i < iterations; i++) {
+            uint8_t frame = i % packed.frames;
+            uint32_t start = ESP.getCycleCount();
+            gfx.drawBitmap(0, 0, logo.bitmap + frame * stride, logo.width,
+                           logo.height, SH110X_WHITE, SH110X_BLACK);
+            cycles[i] = ESP.getCycleCount() - start;
+            yield();
+        }
+        uint32_t gfxCycles = oledSummarize(logo.name, cycles, iterations).median;
+
+        for (uint16_t i = 0; i < iterations; i++) {
+            uint8_t frame = i % packed.frames;
+            uint32_t start = ESP.getCycleCount();
+            MyPackedBitmap::draw(buffer, 0, 0, packed, frame);
+            cycles[i] = ESP.getCycleCount() - start;
+            yield();
+        }
+        uint32_t drawCycles = oledSummarize(logo.name, cycles, iterations).median;
+
+        uint32_t stepCycles = 0;
+        if (packed.frames > 1) {
+            uint8_t frame = 0;
+            MyPackedBitmap::draw(buffer, 0, 0, packed, frame);
+            for (uint16_t i = 0; i < iterations; i++) {
+                uint32_t start = ESP.getCycleCount();
+                frame = MyPackedBitmap::step(buffer, 0, 0, packed, frame);
+                cycles[i] = ESP.getCycleCount() - start;
+                yield();
+            }
+            stepCycles = oledSummarize(logo.name, cycles, iterations).median;
+        }
+
+        uint16_t raw = MyPackedBitmap::rawSize(packed);
+        uint16_t size = MyPackedBitmap::packedSize(packed);
+        Serial.printf("%-10s %6u %6u %3u%% %9u %14u %12u\n", logo.name, raw,
+                      size, size * 100 / raw, gfxCycles / mhz,
+                      drawCycles / mhz, stepCycles / mhz);
+        Serial.printf("LOGO,%s,%u,%u,%u,%u,%u\n", logo.name, raw, size,
+                      gfxCycles, drawCycles, stepCycles);
+    }
+    free(cycles);
+    Serial.println();
+}
+
 #endif  // _ADAFRUIT_OLED_TEST_SUITE_H_
\ No newline at end of file
@@ -0,0 +1,183 @@
+/**
+ * MyBmeCompensation.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Integer-only BME280 compensation (datasheet 4.2.3 / 8.2) for the FPU-less
+ * ESP8266. All results are scaled integers in hundredths of the display unit,
+ * so they can be formatted without touching floating point.
+ */
+
+#ifndef _MY_BME_COMPENSATION_H_
+#define _MY_BME_COMPENSATION_H_
+
+#include <Arduino.h>
+
+// Altitude lookup table: one entry every 1024 Pa starting at 300 hPa,
+// precomputed for SEALEVELPRESSURE_HPA = 1013.25 with the barometric formula
+// 44330 * (1 - (p / p0) ^ 0.1903). Linear interpolation stays within 15 cm
+// near sea level and within 1 m at 300 hPa.
+#define BME_ALTITUDE_LUT_BASE 30000  // Pa
+#define BME_ALTITUDE_LUT_SHIFT 10    // 1024 Pa per entry
+#define BME_ALTITUDE_LUT_SIZE 80
+const int32_t PROGMEM bmeAltitudeLut[BME_ALTITUDE_LUT_SIZE] = {  // cm
+    916537, 894005, 872067, 850690, 829842, 809495, 789623, 770201,
+    751208, 732623, 714427, 696602, 679132, 662001, 645195, 628700,
+    612504, 596595, 580962, 565594, 550482, 535616, 520987, 506588,
+    492410, 478445, 464688, 451130, 437766, 424589, 411594, 398776,
+    386128, 373647, 361326, 349162, 337151, 325287, 313568, 301988,
+    290545, 279236, 268055, 257001, 246070, 235259, 224565, 213986,
+    203518, 193160, 182908, 172760, 162714, 152767, 142918, 133164,
+    123504, 113934, 104454, 95062, 85755, 76533, 67392, 58333,
+    49352, 40449, 31623, 22871, 14192, 5585, -2951, -11418,
+    -19817, -28149, -36416, -44617, -52756, -60832, -68846, -76801,
+};
+
+class MyBmeCompensation {
+   private:
+    uint16_t _T1;
+    int16_t _T2, _T3;
+    uint16_t _P1;
+    int16_t _P2, _P3, _P4, _P5, _P6, _P7, _P8, _P9;
+    uint8_t _H1, _H3;
+    int16_t _H2, _H4, _H5;
+    int8_t _H6;
+
+    int32_t _tFine = 0;
+
+   public:
+    /**
+     * Parse the factory trimming parameters (datasheet 4.2.2).
+     * @param a 26 bytes read from 0x88..0xA1
+     * @param b 7 bytes read from 0xE1..0xE7
+     */
+    void setCalibration(const uint8_t* a, const uint8_t* b) {
+        _T1 = (uint16_t)(a[1] << 8 | a[0]);
+        _T2 = (int16_t)(a[3] << 8 | a[2]);
+        _T3 = (int16_t)(a[5] << 8 | a[4]);
+        _P1 = (uint16_t)(a[7] << 8 | a[6]);
+        _P2 = (int16_t)(a[9] << 8 | a[8]);
+        _P3 = (int16_t)(a[11] << 8 | a[10]);
+        _P4 = (int16_t)(a[13] << 8 | a[12]);
+        _P5 = (int16_t)(a[15] << 8 | a[14]);
+        _P6 = (int16_t)(a[17] << 8 | a[16]);
+        _P7 = (int16_t)(a[19] << 8 | a[18]);
+        _P8 = (int16_t)(a[21] << 8 | a[20]);
+        _P9 = (int16_t)(a[23] << 8 | a[22]);
+        _H1 = a[25];
+        _H2 = (int16_t)(b[1] << 8 | b[0]);
+        _H3 = b[2];
+        _H4 = (int16_t)((int8_t)b[3] * 16 | (b[4] & 0x0F));
+        _H5 = (int16_t)((int8_t)b[5] * 16 | (b[4] >> 4));
+        _H6 = (int8_t)b[6];
+    }
+
+    /**
+     * Compensate temperature. Must be called before pressure() and
+     * humidity(), which reuse its t_fine.
+     * @return temperature in 0.01 °C
+     */
+    int32_t temperature(int32_t adcT) {
+        int32_t var1 = ((((adcT >> 3) - ((int32_t)_T1 << 1))) * _T2) >> 11;
+        int32_t var2 = (((((adcT >> 4) - (int32_t)_T1) *
+                          ((adcT >> 4) - (int32_t)_T1)) >> 12) * _T3) >> 14;
+        _tFine = var1 + var2;
+        return (_tFine * 5 + 128) >> 8;
+    }
+
+    /**
+     * Compensate pressure (64 bit variant).
+     * @return pressure in Pa, i.e. 0.01 hPa
+     */
+    uint32_t pressure(int32_t adcP) const {
+        int64_t var1 = (int64_t)_tFine - 128000;
+        int64_t var2 = var1 * var1 * _P6;
+        var2 = var2 + var1 * _P5 * 131072;  // << 17, defined for negatives
+        var2 = var2 + (int64_t)_P4 * 34359738368LL;  // << 35
+        var1 = ((var1 * var1 * _P3) >> 8) + var1 * _P2 * 4096;  // << 12
+        var1 = ((((int64_t)1) << 47) + var1) * _P1 >> 33;
+        if (var1 == 0) return 0;  // avoid division by zero
+
+        int64_t p = 1048576 - adcP;
+        p = (((p << 31) - var2) * 3125) / var1;
+        var1 = ((int64_t)_P9 * (p >> 13) * (p >> 13)) >> 25;
+        var2 = ((int64_t)_P8 * p) >> 19;
+        p = ((p + var1 + var2) >> 8) + (int64_t)_P7 * 16;
+        return (uint32_t)(p >> 8);  // Q24.8 -> Pa
+    }
+
+    /**
+     * Compensate relative humidity.
+     * @return humidity in 0.01 %RH
+     */
+    uint32_t humidity(int32_t adcH) const {
+        int32_t v = _tFine - 76800;
+        v = (((((adcH << 14) - (int32_t)_H4 * 1048576 - ((int32_t)_H5 * v)) +
+               16384) >> 15) *
+             (((((((v * _H6) >> 10) * (((v * _H3) >> 11) + 32768)) >> 10) +
+                2097152) * _H2 + 8192) >> 14));
+        v = v - (((((v >> 15) * (v >> 15)) >> 7) * _H1) >> 4);
+        v = v < 0 ? 0 : v;
+        v = v > 419430400 ? 419430400 : v;
+        return ((uint32_t)(v >> 12) * 100) >> 10;  // Q22.10 -> 0.01 %RH
+    }
+
+    /**
+     * Approximate altitude from pressure using the PROGMEM lookup table.
+     * @param pressure pressure in Pa
+     * @return altitude in cm
+     */
+    static int32_t altitude(uint32_t pressure) {
+        const uint32_t span = (uint32_t)(BME_ALTITUDE_LUT_SIZE - 1)
+                              << BME_ALTITUDE_LUT_SHIFT;
+        uint32_t offset = pressure > BME_ALTITUDE_LUT_BASE
+                              ? pressure - BME_ALTITUDE_LUT_BASE
+                              : 0;
+        if (offset >= span) offset = span - 1;
+
+        uint32_t i = offset >> BME_ALTITUDE_LUT_SHIFT;
+        int32_t frac = offset & ((1 << BME_ALTITUDE_LUT_SHIFT) - 1);
+        int32_t a = (int32_t)pgm_read_dword(&bmeAltitudeLut[i]);
+        int32_t b = (int32_t)pgm_read_dword(&bmeAltitudeLut[i + 1]);
+        return a + (b - a) * frac / (1 << BME_ALTITUDE_LUT_SHIFT);
+    }
+
+    /**
+     * Reference floating point compensation (datasheet 8.1), kept for
+     * benchmarking against the integer path.
+     */
+    void compensateFloat(int32_t adcT, int32_t adcP, int32_t adcH,
+                         float& temperature, float& pressure,
+                         float& humidity, float& altitude) const {
+        float v1 = ((float)adcT / 16384.0f - (float)_T1 / 1024.0f) * _T2;
+        float v2 = (float)adcT / 131072.0f - (float)_T1 / 8192.0f;
+        v2 = v2 * v2 * _T3;
+        float tFine = v1 + v2;
+        temperature = tFine / 5120.0f;
+
+        pressure = 0;
+        v1 = tFine / 2.0f - 64000.0f;
+        v2 = v1 * v1 * _P6 / 32768.0f;
+        v2 = v2 + v1 * _P5 * 2.0f;
+        v2 = v2 / 4.0f + _P4 * 65536.0f;
+        v1 = (_P3 * v1 * v1 / 524288.0f + _P2 * v1) / 524288.0f;
+        v1 = (1.0f + v1 / 32768.0f) * _P1;
+        if (v1 != 0) {
+            float p = 1048576.0f - adcP;
+            p = (p - v2 / 4096.0f) * 6250.0f / v1;
+            v1 = _P9 * p * p / 2147483648.0f;
+            v2 = p * _P8 / 32768.0f;
+            pressure = (p + (v1 + v2 + _P7) / 16.0f) / 100.0f;
+        }
+
+        float h = tFine - 76800.0f;
+        h = (adcH - (_H4 * 64.0f + _H5 / 16384.0f * h)) *
+            (_H2 / 65536.0f *
+             (1.0f + _H6 / 67108864.0f * h * (1.0f + _H3 / 67108864.0f * h)));
+        h = h * (1.0f - _H1 * h / 524288.0f);
+        humidity = constrain(h, 0.0f, 100.0f);
+
+        altitude = 44330.0f * (1.0f - pow(pressure / 1013.25f, 0.1903f));
+    }
+};
+
+#endif  // _MY_BME_COMPENSATION_H_
@@ -0,0 +1,148 @@
+/**
+ * MyCbor.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * The part of CBOR (RFC 8949) the telemetry needs: integers up to 32 bit
+ * and arrays of definite length. The writer encodes into a caller's buffer
+ * and the reader decodes from one, neither allocates. Any CBOR decoder can
+ * read what the writer produces.
+ */
+
+#ifndef _MY_CBOR_H_
+#define _MY_CBOR_H_
+
+#include <Arduino.h>
+
+#define CBOR_UNSIGNED 0  // major types
+#define CBOR_NEGATIVE 1
+#define CBOR_ARRAY 4
+
+class MyCborWriter {
+   private:
+    uint8_t* _buf;
+    size_t _size;
+    size_t _length = 0;
+    bool _overflow = false;
+
+    void put(uint8_t byte) {
+        if (_length < _size) {
+            _buf[_length++] = byte;
+        } else {
+            _overflow = true;
+        }
+    }
+
+    /**
+     * Initial byte and argument in the shortest form.
+     */
+    void header(uint8_t major, uint32_t value) {
+        major <<= 5;
+        if (value < 24) {
+            put(major | value);
+        } else if (value <= 0xFF) {
+            put(major | 24);
+            put(value);
+        } else if (value <= 0xFFFF) {
+            put(major | 25);
+            put(value >> 8);
+            put(value);
+        } else {
+            put(major | 26);
+            put(value >> 24);
+            put(value >> 16);
+            put(value >> 8);
+            put(value);
+        }
+    }
+
+   public:
+    MyCborWriter(uint8_t* buf, size_t size) : _buf(buf), _size(size) {}
+
+    void array(uint8_t items) { header(CBOR_ARRAY, items); }
+
+    void number(uint32_t value) { header(CBOR_UNSIGNED, value); }
+
+    void integer(int32_t value) {
+        if (value < 0) {
+            header(CBOR_NEGATIVE, -1 - value);
+        } else {
+            header(CBOR_UNSIGNED, value);
+        }
+    }
+
+    /**
+     * @return bytes written, 0 if the buffer was too small
+     */
+    size_t length() const { return _overflow ? 0 : _length; }
+};
+
+class MyCborReader {
+   private:
+    const uint8_t* _buf;
+    size_t _length;
+    size_t _pos = 0;
+    bool _ok = true;
+
+    uint8_t get() {
+        if (_pos < _length) return _buf[_pos++];
+        _ok = false;
+        return 0;
+    }
+
+    /**
+     * Read an initial byte and its argument.
+     * @return the major type
+     */
+    uint8_t header(uint32_t& value) {
+        uint8_t initial = get();
+        uint8_t info = initial & 0x1F;
+        if (info < 24) {
+            value = info;
+        } else if (info <= 26) {
+            value = 0;
+            for (uint8_t i = 0; i < 1 << (info - 24); i++) value = value << 8 | get();
+        } else {
+            _ok = false;  // 64 bit, indefinite length and the like
+            value = 0;
+        }
+        return initial >> 5;
+    }
+
+   public:
+    MyCborReader(const uint8_t* buf, size_t length)
+        : _buf(buf), _length(length) {}
+
+    /**
+     * @return number of items of the array
+     */
+    uint8_t array() {
+        uint32_t items;
+        if (header(items) != CBOR_ARRAY || items > 0xFF) _ok = false;
+        return items;
+    }
+
+    int32_t integer() {
+        uint32_t value;
+        uint8_t major = header(value);
+        if (major == CBOR_UNSIGNED && value <= INT32_MAX) return value;
+        if (major == CBOR_NEGATIVE && value <= INT32_MAX) return -1 - (int32_t)value;
+        _ok = false;
+        return 0;
+    }
+
+    uint32_t number() {
+        uint32_t value;
+        if (header(value) != CBOR_UNSIGNED) _ok = false;
+        return value;
+    }
+
+    /**
+     * @return true if everything read so far was well-formed and of the
+     * expected type
+     */
+    bool ok() const { return _ok; }
+
+    bool atEnd() const { return _pos == _length; }
+};
+
+#endif  // _MY_CBOR_H_
@@ -0,0 +1,220 @@
+/**
+ * MyClockFace.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Large-digit clock face: HH:MM in 22x32 px digits, seconds and date in the
+ * GFX font below and above. The digits come from a PROGMEM atlas that is
+ * already in the SH1106 page layout (one byte = 8 vertical pixels), so
+ * drawing a digit is one memcpy_P per page row, without any pixel math.
+ * After the first frame only changed digits are blitted; between minute
+ * changes that is just the seconds.
+ */
+
+#ifndef _MY_CLOCK_FACE_H_
+#define _MY_CLOCK_FACE_H_
+
+#include <Arduino.h>
+#include <time.h>
+
+#include "MyDisplay.h"
+
+#define CLOCK_GLYPH_WIDTH 22
+#define CLOCK_GLYPH_PAGES 4  // 32 px
+#define CLOCK_GLYPH_SIZE (CLOCK_GLYPH_WIDTH * CLOCK_GLYPH_PAGES)
+#define CLOCK_COLON_WIDTH 8
+#define CLOCK_TOP_PAGE 1     // digits on pages 1-4 (y 8-39)
+#define CLOCK_SECONDS_X 52
+#define CLOCK_SECONDS_Y 46
+
+// x of the four digits and the colon
+const uint8_t clockDigitX[4] = {13, 37, 69, 93};
+#define CLOCK_COLON_X 61
+
+// Seven-segment style digits 0-9, each CLOCK_GLYPH_PAGES rows of
+// CLOCK_GLYPH_WIDTH column bytes, LSB at the top.
+const uint8_t PROGMEM clockDigits[10 * CLOCK_GLYPH_SIZE] = {
+    // 0
+    0xF8, 0xFC, 0xFE, 0xFF, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xFF, 0xFE, 0xFC, 0xF8,
+    0x1F, 0x3F, 0x3F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x3F, 0x1F,
+    0xF8, 0xFC, 0xFC, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFC, 0xFC, 0xF8,
+    0x1F, 0x3F, 0x7F, 0xFF, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xFF, 0x7F, 0x3F, 0x1F,
+    // 1
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFC, 0xFC, 0xF8,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x3F, 0x1F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFC, 0xFC, 0xF8,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x3F, 0x1F,
+    // 2
+    0x00, 0x00, 0x06, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xFF, 0xFE, 0xFC, 0xF8,
+    0x00, 0x00, 0x80, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xDF, 0xBF, 0x3F, 0x1F,
+    0xF8, 0xFC, 0xFD, 0xFB, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x01, 0x00, 0x00,
+    0x1F, 0x3F, 0x7F, 0xFF, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0x60, 0x00, 0x00,
+    // 3
+    0x00, 0x00, 0x06, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xFF, 0xFE, 0xFC, 0xF8,
+    0x00, 0x00, 0x80, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xDF, 0xBF, 0x3F, 0x1F,
+    0x00, 0x00, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFB, 0xFD, 0xFC, 0xF8,
+    0x00, 0x00, 0x60, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xFF, 0x7F, 0x3F, 0x1F,
+    // 4
+    0xF8, 0xFC, 0xFC, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFC, 0xFC, 0xF8,
+    0x1F, 0x3F, 0xBF, 0xDF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xDF, 0xBF, 0x3F, 0x1F,
+    0x00, 0x00, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFB, 0xFD, 0xFC, 0xF8,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x3F, 0x1F,
+    // 5
+    0xF8, 0xFC, 0xFE, 0xFF, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x06, 0x00, 0x00,
+    0x1F, 0x3F, 0xBF, 0xDF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x80, 0x00, 0x00,
+    0x00, 0x00, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFB, 0xFD, 0xFC, 0xF8,
+    0x00, 0x00, 0x60, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xFF, 0x7F, 0x3F, 0x1F,
+    // 6
+    0xF8, 0xFC, 0xFE, 0xFF, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x06, 0x00, 0x00,
+    0x1F, 0x3F, 0xBF, 0xDF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x80, 0x00, 0x00,
+    0xF8, 0xFC, 0xFD, 0xFB, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFB, 0xFD, 0xFC, 0xF8,
+    0x1F, 0x3F, 0x7F, 0xFF, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xFF, 0x7F, 0x3F, 0x1F,
+    // 7
+    0x00, 0x00, 0x06, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xFF, 0xFE, 0xFC, 0xF8,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x3F, 0x1F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFC, 0xFC, 0xF8,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x3F, 0x1F,
+    // 8
+    0xF8, 0xFC, 0xFE, 0xFF, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xFF, 0xFE, 0xFC, 0xF8,
+    0x1F, 0x3F, 0xBF, 0xDF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xDF, 0xBF, 0x3F, 0x1F,
+    0xF8, 0xFC, 0xFD, 0xFB, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFB, 0xFD, 0xFC, 0xF8,
+    0x1F, 0x3F, 0x7F, 0xFF, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xFF, 0x7F, 0x3F, 0x1F,
+    // 9
+    0xF8, 0xFC, 0xFE, 0xFF, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xFF, 0xFE, 0xFC, 0xF8,
+    0x1F, 0x3F, 0xBF, 0xDF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xDF, 0xBF, 0x3F, 0x1F,
+    0x00, 0x00, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFB, 0xFD, 0xFC, 0xF8,
+    0x00, 0x00, 0x60, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xFF, 0x7F, 0x3F, 0x1F,
+};
+
+const uint8_t PROGMEM clockColon[CLOCK_COLON_WIDTH * CLOCK_GLYPH_PAGES] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x1E, 0x1E, 0x1E, 0x1E, 0x00, 0x00,
+    0x00, 0x00, 0xF0, 0xF0, 0xF0, 0xF0, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+class MyClockFace {
+   private:
+    int8_t _digits[4] = {-1, -1, -1, -1};  // digits on screen, -1 = none
+    int8_t _second = -1;
+    int16_t _day = -1;  // tm_yday of the date on screen
+
+    // Statistics
+    uint32_t _blits = 0;
+    uint32_t _updateTime = 0;  // µs, last update
+    uint32_t _maxUpdateTime = 0;
+
+    /**
+     * Copy a glyph of `width` columns into the frame buffer at column `x`.
+     */
+    static void blit(uint8_t* buffer, const uint8_t* glyph, uint8_t width,
+                     uint8_t x) {
+        for (uint8_t page = 0; page < CLOCK_GLYPH_PAGES; page++) {
+            memcpy_P(buffer + (CLOCK_TOP_PAGE + page) * SCREEN_WIDTH + x,
+                     glyph + page * width, width);
+        }
+    }
+
+    void drawDigits(uint8_t* buffer, const struct tm& t) {
+        const int8_t digits[4] = {(int8_t)(t.tm_hour / 10), (int8_t)(t.tm_hour % 10),
+                                  (int8_t)(t.tm_min / 10), (int8_t)(t.tm_min % 10)};
+        for (uint8_t i = 0; i < 4; i++) {
+            if (digits[i] == _digits[i]) continue;
+            blit(buffer, clockDigits + digits[i] * CLOCK_GLYPH_SIZE,
+                 CLOCK_GLYPH_WIDTH, clockDigitX[i]);
+            _digits[i] = digits[i];
+            _blits++;
+        }
+    }
+
+    void drawSeconds(Adafruit_GFX& gfx, const struct tm& t) {
+        gfx.fillRect(CLOCK_SECONDS_X, CLOCK_SECONDS_Y, 24, 16, SH110X_BLACK);
+        gfx.setTextSize(2);
+        gfx.setCursor(CLOCK_SECONDS_X, CLOCK_SECONDS_Y);
+        gfx.printf("%02d", t.tm_sec);
+        gfx.setTextSize(1);
+        _second = t.tm_sec;
+    }
+
+    void drawDate(Adafruit_GFX& gfx, const struct tm& t) {
+        char buf[24];
+        strftime(buf, sizeof(buf), "%a %d.%m.%Y", &t);
+        gfx.fillRect(0, 0, SCREEN_WIDTH, 8, SH110X_BLACK);
+        gfx.setCursor((SCREEN_WIDTH - strlen(buf) * 6) / 2, 0);
+        gfx.print(buf);
+        _day = t.tm_yday;
+    }
+
+   public:
+    /**
+     * Draw the whole face into a cleared frame.
+     */
+    void render(MyDisplay& display, const struct tm& t) {
+        uint8_t* buffer = display.getBuffer();
+        for (uint8_t i = 0; i < 4; i++) _digits[i] = -1;
+        drawDigits(buffer, t);
+        blit(buffer, clockColon, CLOCK_COLON_WIDTH, CLOCK_COLON_X);
+        drawSeconds(display.getCanvas(), t);
+        drawDate(display.getCanvas(), t);
+    }
+
+    /**
+     * Redraw only what changed since the face's previous frame.
+     */
+    void update(MyDisplay& display, const struct tm& t) {
+        if (_second < 0) {
+            display.clear();
+            render(display, t);
+            return;
+        }
+        uint32_t start = micros();
+        drawDigits(display.getBuffer(), t);
+        if (t.tm_sec != _second) drawSeconds(display.getCanvas(), t);
+        if (t.tm_yday != _day) drawDate(display.getCanvas(), t);
+
+        _updateTime = micros() - start;
+        if (_updateTime > _maxUpdateTime) _maxUpdateTime = _updateTime;
+    }
+
+    /**
+     * Compare drawing HH:MM from the atlas with the Adafruit_GFX text path
+     * at the same size (text size 4 = 24x32 px cells). Draws over the frame
+     * buffer; redraw the page afterwards.
+     */
+    void printBenchmark(MyDisplay& display, uint16_t iterations = 100) {
+        uint8_t* buffer = display.getBuffer();
+        Adafruit_GFX& gfx = display.getCanvas();
+
+        uint32_t start = ESP.getCycleCount();
+        for (uint16_t i = 0; i < iterations; i++) {
+            for (uint8_t d = 0; d < 4; d++) {
+                blit(buffer, clockDigits + (i + d) % 10 * CLOCK_GLYPH_SIZE,
+                     CLOCK_GLYPH_WIDTH, clockDigitX[d]);
+            }
+            blit(buffer, clockColon, CLOCK_COLON_WIDTH, CLOCK_COLON_X);
+        }
+        uint32_t atlas = (ESP.getCycleCount() - start) / iterations;
+
+        start = ESP.getCycleCount();
+        for (uint16_t i = 0; i < iterations; i++) {
+            gfx.fillRect(0, CLOCK_TOP_PAGE * 8, SCREEN_WIDTH,
+                         CLOCK_GLYPH_PAGES * 8, SH110X_BLACK);
+            gfx.setTextSize(4);
+            gfx.setCursor(4, CLOCK_TOP_PAGE * 8);
+            gfx.printf("%02u:%02u", i % 24, i % 60);
+        }
+        gfx.setTextSize(1);
+        uint32_t text = (ESP.getCycleCount() - start) / iterations;
+        if (!atlas) atlas = 1;
+
+        uint32_t mhz = ESP.getCpuFreqMHz();
+        Serial.println("Clock Face (HH:MM, per frame):");
+        Serial.printf("Atlas blit: %u cycles (%u µs)\n", atlas, atlas / mhz);
+        Serial.printf("GFX text:   %u cycles (%u µs), %u.%ux slower\n", text,
+                      text / mhz, text / atlas, text * 10 / atlas % 10);
+        Serial.printf("Digit blits: %u, last update %u µs (max. %u µs)\n",
+                      _blits, _updateTime, _maxUpdateTime);
+        Serial.println();
+    }
+};
+
+#endif  // _MY_CLOCK_FACE_H_
@@ -0,0 +1,90 @@
+/**
+ * MyDeadband.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Report-by-exception for one published value. A value is reported when it
+ * moved by at least its deadband since the last report (at most every
+ * DEADBAND_MIN_INTERVAL), at once when it jumped by its jump threshold, and
+ * at least every DEADBAND_HEARTBEAT_INTERVAL as a heartbeat, so subscribers
+ * can tell a steady value from a dead device.
+ */
+
+#ifndef _MY_DEADBAND_H_
+#define _MY_DEADBAND_H_
+
+#include <Arduino.h>
+
+#define DEADBAND_HEARTBEAT_INTERVAL 300000  // ms, max. time between reports
+#define DEADBAND_MIN_INTERVAL 10000        // ms between reports of small changes
+
+enum DeadbandReason {
+    DEADBAND_SUPPRESSED,  // not reported
+    DEADBAND_FIRST,       // never reported yet
+    DEADBAND_CHANGE,      // moved by the deadband
+    DEADBAND_JUMP,        // moved by the jump threshold
+    DEADBAND_HEARTBEAT,   // unchanged for DEADBAND_HEARTBEAT_INTERVAL
+};
+
+class MyDeadband {
+   private:
+    const char* _name;
+    int32_t _deadband;  // raw units, 0: report every sample
+    int32_t _jump;      // raw units, 0: no immediate reports
+
+    int32_t _value = 0;  // last reported
+    unsigned long _reportedAt = 0;
+    bool _reported = false;
+
+    uint32_t _sent = 0;
+    uint32_t _suppressed = 0;
+
+   public:
+    MyDeadband(const char* name, int32_t deadband, int32_t jump)
+        : _name(name), _deadband(deadband), _jump(jump) {}
+
+    /**
+     * Decide whether `value` is to be reported now. Call commit() after
+     * the report went out or suppress() if it is not sent.
+     */
+    DeadbandReason check(int32_t value, unsigned long now) const {
+        if (!_reported) return DEADBAND_FIRST;
+        if (now - _reportedAt >= DEADBAND_HEARTBEAT_INTERVAL) {
+            return DEADBAND_HEARTBEAT;
+        }
+
+        int32_t delta = abs(value - _value);
+        if (_jump && delta >= _jump) return DEADBAND_JUMP;
+        if (!_deadband) return DEADBAND_CHANGE;
+        if (delta >= _deadband && now - _reportedAt >= DEADBAND_MIN_INTERVAL) {
+            return DEADBAND_CHANGE;
+        }
+        return DEADBAND_SUPPRESSED;
+    }
+
+    void commit(int32_t value, unsigned long now) {
+        _value = value;
+        _reportedAt = now;
+        _reported = true;
+        _sent++;
+    }
+
+    void suppress() { _suppressed++; }
+
+    /**
+     * Report the next value regardless of the deadband, e.g. after a
+     * reconnect.
+     */
+    void reset() { _reported = false; }
+
+    void setDeadband(int32_t deadband) { _deadband = deadband; }
+
+    void setJump(int32_t jump) { _jump = jump; }
+
+    const char* getName() const { return _name; }
+    int32_t getDeadband() const { return _deadband; }
+    int32_t getJump() const { return _jump; }
+    uint32_t getSent() const { return _sent; }
+    uint32_t getSuppressed() const { return _suppressed; }
+};
+
+#endif  // _MY_DEADBAND_H_
@@ -0,0 +1,186 @@
+/**
+ * MyDerivedMetrics.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Values derived from a BME280 reading: dew point, absolute humidity, heat
+ * index, 3 hour pressure tendency and a Zambretti forecast. Updated once per
+ * new sample from rolling state, results are scaled integers like the raw
+ * readings.
+ */
+
+#ifndef _MY_DERIVED_METRICS_H_
+#define _MY_DERIVED_METRICS_H_
+
+#include <Arduino.h>
+
+#define TENDENCY_SLOT 600000UL  // ms per pressure slot (10 minutes)
+#define TENDENCY_SLOTS 18       // 3 hours
+#define TENDENCY_STEADY 160     // Pa per 3 h still considered steady
+
+/**
+ * Derived values, in hundredths of their unit like SensorSnapshot.
+ */
+struct DerivedMetrics {
+    int32_t dewPoint = 0;          // 0.01 °C
+    int32_t absoluteHumidity = 0;  // 0.01 g/m³
+    int32_t heatIndex = 0;         // 0.01 °C
+    int32_t pressureTendency = 0;  // 0.01 hPa per 3 h
+    char forecast = '?';           // Zambretti letter A-Z, '?' = not yet known
+    bool tendencyValid = false;    // false until 3 h of pressure data exist
+};
+
+// Zambretti forecast texts, indexed by letter
+const char* const zambrettiForecasts[26] = {
+    "Settled fine",
+    "Fine weather",
+    "Becoming fine",
+    "Fine, becoming less settled",
+    "Fine, possible showers",
+    "Fairly fine, improving",
+    "Fairly fine, possible showers early",
+    "Fairly fine, showery later",
+    "Showery early, improving",
+    "Changeable, mending",
+    "Fairly fine, showers likely",
+    "Rather unsettled, clearing later",
+    "Unsettled, probably improving",
+    "Showery, bright intervals",
+    "Showery, becoming less settled",
+    "Changeable, some rain",
+    "Unsettled, short fine intervals",
+    "Unsettled, rain later",
+    "Unsettled, some rain",
+    "Mostly very unsettled",
+    "Occasional rain, worsening",
+    "Rain at times, very unsettled",
+    "Rain at frequent intervals",
+    "Rain, very unsettled",
+    "Stormy, may improve",
+    "Stormy, much rain",
+};
+
+class MyDerivedMetrics {
+   private:
+    // Average pressure of the last TENDENCY_SLOTS completed slots
+    int32_t _slots[TENDENCY_SLOTS];
+    uint8_t _head = 0;
+    uint8_t _filled = 0;
+
+    // Slot being accumulated
+    uint32_t _slotStart = 0;  // millis() where it began
+    int32_t _sum = 0;
+    uint16_t _count = 0;
+
+    DerivedMetrics _metrics;
+
+    /**
+     * Add a pressure sample to the current slot, closing it when a new slot
+     * starts. Slots are timed by differences of millis(), so they run on
+     * across its wrap after 49.7 days. O(1) per sample.
+     */
+    void addPressure(int32_t pressure, unsigned long now) {
+        if (!_count) _slotStart = now;  // first sample
+        uint32_t elapsed = now - _slotStart;
+        if (elapsed >= TENDENCY_SLOT) {
+            uint32_t slots = elapsed / TENDENCY_SLOT;
+            if (slots == 1) {
+                _slots[_head] = _sum / _count;
+                _head = (_head + 1) % TENDENCY_SLOTS;
+                if (_filled < TENDENCY_SLOTS) _filled++;
+            } else {
+                // Slots missed while the sensor was down break the window
+                _filled = 0;
+            }
+            _slotStart += slots * TENDENCY_SLOT;
+            _count = 0;
+            _sum = 0;
+        }
+        _sum += pressure;
+        _count++;
+    }
+
+    /**
+     * Simplified Zambretti forecaster (Negretti & Zambra, 1915) on the
+     * station pressure, without wind and season corrections.
+     */
+    static char zambretti(int32_t pressure, int32_t tendency) {
+        // Z = 127 - 0.12 P, 144 - 0.13 P and 185 - 0.16 P with P in hPa
+        static const char falling[] = "ABDHORUXZ";
+        static const char steady[] = "ABEKNPSWXZ";
+        static const char rising[] = "ABCFGIJLMQTYZ";
+
+        if (tendency < -TENDENCY_STEADY) {
+            int32_t z = 127 - (12 * pressure + 5000) / 10000;
+            return falling[constrain(z - 1, 0, 8)];
+        }
+        if (tendency > TENDENCY_STEADY) {
+            int32_t z = 185 - (16 * pressure + 5000) / 10000;
+            return rising[constrain(z - 20, 0, 12)];
+        }
+        int32_t z = 144 - (13 * pressure + 5000) / 10000;
+        return steady[constrain(z - 10, 0, 9)];
+    }
+
+   public:
+    /**
+     * Update all metrics with a new reading.
+     * @param temperature 0.01 °C
+     * @param humidity 0.01 %RH
+     * @param pressure Pa
+     * @param now millis() of the reading
+     */
+    const DerivedMetrics& update(int32_t temperature, int32_t humidity,
+                                 int32_t pressure, unsigned long now) {
+        float t = temperature / 100.0f;
+        float rh = max(humidity, (int32_t)1) / 100.0f;
+
+        // Magnus formula (Sonntag 1990 constants)
+        float gamma = logf(rh / 100.0f) + 17.62f * t / (243.12f + t);
+        _metrics.dewPoint = lroundf(243.12f * gamma / (17.62f - gamma) * 100);
+
+        // Saturation vapour pressure (hPa) -> water vapour density
+        float es = 6.112f * expf(17.62f * t / (243.12f + t));
+        _metrics.absoluteHumidity =
+            lroundf(216.7f * es * rh / 100.0f / (273.15f + t) * 100);
+
+        // NOAA heat index (Rothfusz regression with Steadman below 80 °F)
+        float f = t * 1.8f + 32;
+        float hi = 0.5f * (f + 61.0f + (f - 68.0f) * 1.2f + rh * 0.094f);
+        if ((hi + f) / 2 >= 80) {
+            hi = -42.379f + 2.04901523f * f + 10.14333127f * rh -
+                 0.22475541f * f * rh - 0.00683783f * f * f -
+                 0.05481717f * rh * rh + 0.00122874f * f * f * rh +
+                 0.00085282f * f * rh * rh - 0.00000199f * f * f * rh * rh;
+            if (rh < 13 && f >= 80 && f <= 112) {
+                hi -= (13 - rh) / 4 * sqrtf((17 - fabsf(f - 95)) / 17);
+            } else if (rh > 85 && f >= 80 && f <= 87) {
+                hi += (rh - 85) / 10 * (87 - f) / 5;
+            }
+        }
+        _metrics.heatIndex = lroundf((hi - 32) / 1.8f * 100);
+
+        addPressure(pressure, now);
+        _metrics.tendencyValid = _filled == TENDENCY_SLOTS;
+        if (_metrics.tendencyValid) {
+            // _head points at the oldest slot once the ring is full
+            _metrics.pressureTendency = pressure - _slots[_head];
+            _metrics.forecast = zambretti(pressure, _metrics.pressureTendency);
+        } else {
+            _metrics.pressureTendency = 0;
+            _metrics.forecast = '?';
+        }
+        return _metrics;
+    }
+
+    const DerivedMetrics& get() const { return _metrics; }
+
+    /**
+     * Get the forecast text of a Zambretti letter.
+     */
+    static const char* getForecastText(char letter) {
+        if (letter < 'A' || letter > 'Z') return "Unknown";
+        return zambrettiForecasts[letter - 'A'];
+    }
+};
+
+#endif  // _MY_DERIVED_METRICS_H_
@@ -12,34 +12,63 @@
 #include <SPI.h>
 #include <Wire.h>
 
+#include "MyFormat.h"
+#include "MyI2CBus.h"
 #include "MyLogos.h"
+#include "MySensor.h"
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
 #define OLED_RESET -1
 
+#define OLED_PAGES (SCREEN_HEIGHT / 8)
+#define OLED_COLUMN_OFFSET 2  // SH1106 RAM is 132 columns, the panel starts at 2
+#define OLED_CONTRAST 0x80    // SH1106 reset default
+#define OLED_I2C_CHUNK 64     // data bytes per I2C transaction (Wire buffer is 128)
+
 class MyDisplay {
    private:
-    uint8_t _address;
+    MyI2CBus& _bus;
+    I2CDevice _device;
     Adafruit_SH1106G _display;
 
+    // Copy of what the panel currently shows, same layout as the GFX buffer:
+    // one byte per column and 8-row page, LSB at the top.
+    uint8_t _shadow[SCREEN_WIDTH * OLED_PAGES];
+    bool _flushing = false;  // a flush was interrupted for the sensor
+
+    // Flush statistics
+    uint32_t _frames = 0;
+    uint32_t _unchanged = 0;  // frames that sent nothing
+    uint32_t _slices = 0;     // flushes that had to be continued later
+    uint32_t _failures = 0;   // flushes cut short by a failed write
+    uint32_t _totalBytes = 0;
+    uint16_t _frameBytes = 0;  // last frame
+    uint32_t _frameTime = 0;   // µs, last frame
+    uint32_t _maxFrameTime = 0;
+    uint16_t _pendingBytes = 0;  // frame being flushed
+    uint32_t _pendingTime = 0;
+
    public:
-    MyDisplay(uint8_t address = 0x3C)
-        : _address(address),
-          _display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET) {}
+    MyDisplay(MyI2CBus& bus, uint8_t address = 0x3C)
+        : _bus(bus),
+          _device("SH1106", address),
+          _display(SCREEN_WIDTH, SCREEN_HEIGHT, &bus.getWire(), OLED_RESET,
+                   bus.getClock(), bus.getClock()) {}
 
     /**
      * Initialize the OLED display.
      */
     void begin() {
-        _display.begin(_address, true);
-
-        // _display.setContrast(0); // dim display
+        _bus.attach(_device);
+        _display.begin(_device.address, true);
 
         // Show image buffer on the display hardware.
         // Since the buffer is intialized with an Adafruit splashscreen
         // internally, this will display the splashscreen.
         _display.display();
+        memcpy(_shadow, _display.getBuffer(), sizeof(_shadow));
+        setContrast(OLED_CONTRAST);
 
         delay(2000);
 
@@ -48,35 +77,198 @@ class MyDisplay {
     }
 
     /**
-     * I2C Scanner: prints to Serial.
+     * Transmit only what differs from the shadow: per page, the column range
+     * between the first and the last changed byte. Replaces display(), which
+     * always sends the full 1 KB buffer.
+     * Data goes out in OLED_I2C_CHUNK transactions, and the flush stops
+     * before a chunk that would run into the sensor's next bus access.
+     * The shadow is only updated for chunks the panel acknowledged, so after
+     * a failed write the rest goes out with the next flush.
+     * @return true if the panel is up to date, false if flush() has to be
+     * called again
      */
-    void scanI2C() {
-        Serial.println("[I2C Scanner] I2C devices found:");
-        Wire.begin();
+    bool flush() {
+        uint32_t start = micros();
+        const uint8_t* buffer = _display.getBuffer();
+        uint16_t bytes = 0;
+        bool done = true;
+        bool failed = false;  // NACK, the shadow keeps what the panel has
 
-        uint8_t count = 0;
+        for (uint8_t page = 0; page < OLED_PAGES && done; page++) {
+            const uint8_t* row = buffer + page * SCREEN_WIDTH;
+            uint8_t* shadow = _shadow + page * SCREEN_WIDTH;
 
-        for (uint8_t i = 1; i < 120; i++) {
-            Wire.beginTransmission(i);
-            if (Wire.endTransmission() == 0) {
-                Serial.printf("[I2C Scanner] Found address: %d (0x%02X)\n", i, i);
-                count++;
-                delay(1);
+            uint8_t first = 0;
+            while (first < SCREEN_WIDTH && row[first] == shadow[first]) first++;
+            if (first == SCREEN_WIDTH) continue;
+            uint8_t last = SCREEN_WIDTH - 1;
+            while (row[last] == shadow[last]) last--;
+
+            for (uint16_t x = first; x <= last;) {
+                uint8_t n = last - x + 1;
+                if (n > OLED_I2C_CHUNK) n = OLED_I2C_CHUNK;
+                if (bytes && !_bus.mayTransfer(n + 1)) {
+                    done = false;
+                    break;
+                }
+                if (x == first) {
+                    uint8_t column = first + OLED_COLUMN_OFFSET;
+                    const uint8_t address[] = {(uint8_t)(0xB0 | page),
+                                               (uint8_t)(0x10 | column >> 4),
+                                               (uint8_t)(column & 0x0F)};
+                    // Co = 0, D/C = 0: command stream
+                    bytes += sizeof(address) + 1;
+                    if (!_bus.write(_device, 0x00, address, sizeof(address))) {
+                        failed = true;
+                        done = false;
+                        break;
+                    }
+                }
+                // Co = 0, D/C = 1: data stream
+                bytes += n + 1;
+                if (!_bus.write(_device, 0x40, row + x, n)) {
+                    failed = true;
+                    done = false;
+                    break;
+                }
+                memcpy(shadow + x, row + x, n);
+                x += n;
             }
         }
 
-        Serial.printf("[I2C Scanner] Done. Found %d device(s).\n", count);
+        _pendingBytes += bytes;
+        _pendingTime += micros() - start;
+        _flushing = !done;
+        if (failed) {
+            _failures++;
+            return false;
+        }
+        if (!done) {
+            _slices++;
+            return false;
+        }
+
+        _frames++;
+        if (!_pendingBytes) _unchanged++;
+        _totalBytes += _pendingBytes;
+        _frameBytes = _pendingBytes;
+        _frameTime = _pendingTime;
+        if (_frameTime > _maxFrameTime) _maxFrameTime = _frameTime;
+        _pendingBytes = 0;
+        _pendingTime = 0;
+        return true;
     }
 
     /**
-     * Display WiFi info.
+     * Bus time of a flush that sends the whole frame, in µs: per page the
+     * address command and the row in OLED_I2C_CHUNK transactions.
      */
-    void showWiFiInfo(bool connected, const String& ssid, const String& ip) {
+    uint32_t getFullFlushTime() const {
+        uint32_t page = _bus.transferTime(3 + 1);
+        for (uint16_t x = 0; x < SCREEN_WIDTH; x += OLED_I2C_CHUNK) {
+            page += _bus.transferTime(min(OLED_I2C_CHUNK, SCREEN_WIDTH - x) + 1);
+        }
+        return page * OLED_PAGES;
+    }
+
+    /**
+     * True while a flush is waiting to be continued.
+     */
+    bool isFlushing() const { return _flushing; }
+
+    uint32_t getFailures() const { return _failures; }
+
+    /**
+     * Print flush statistics to the Serial Monitor.
+     */
+    void printStats() {
+        Serial.println("Display:");
+        Serial.printf("Frames: %u, %u without changes, %u split for the sensor\n",
+                      _frames, _unchanged, _slices);
+        if (_failures) Serial.printf("Failed flushes: %u\n", _failures);
+        Serial.printf("Last frame: %u B in %u µs (max. %u µs)\n", _frameBytes,
+                      _frameTime, _maxFrameTime);
+        if (_frames) {
+            Serial.printf("Average: %u B/frame, full refresh is %u B\n",
+                          _totalBytes / _frames, (unsigned)sizeof(_shadow));
+        }
+        Serial.println();
+    }
+
+    uint16_t getFrameBytes() const { return _frameBytes; }
+    uint32_t getFrameTime() const { return _frameTime; }
+
+    /**
+     * Forget what is on the panel, so the next flush sends the full frame.
+     */
+    void invalidate() {
+        const uint8_t* buffer = _display.getBuffer();
+        for (uint16_t i = 0; i < sizeof(_shadow); i++) _shadow[i] = ~buffer[i];
+    }
+
+    /**
+     * FNV-1a hash of the frame buffer. Two renders of the same screen with
+     * the same inputs give the same value, which makes it usable as a golden
+     * reference across builds.
+     */
+    uint32_t getChecksum() {
+        const uint8_t* buffer = _display.getBuffer();
+        uint32_t hash = 2166136261UL;
+        for (uint16_t i = 0; i < sizeof(_shadow); i++) {
+            hash = (hash ^ buffer[i]) * 16777619UL;
+        }
+        return hash;
+    }
+
+    /**
+     * Write the frame buffer as a plain PBM (P1) image, lit pixels as 1.
+     * Paste the output into a .pbm file to view it.
+     */
+    void printPbm(Print& out, const char* name) {
+        const uint8_t* buffer = _display.getBuffer();
+        out.printf("P1\n# %s, checksum %08x\n%u %u\n", name, getChecksum(),
+                   SCREEN_WIDTH, SCREEN_HEIGHT);
+
+        char line[SCREEN_WIDTH + 1];
+        line[SCREEN_WIDTH] = '\0';
+        for (uint8_t y = 0; y < SCREEN_HEIGHT; y++) {
+            const uint8_t* row = buffer + (y / 8) * SCREEN_WIDTH;
+            for (uint8_t x = 0; x < SCREEN_WIDTH; x++) {
+                line[x] = row[x] & 1 << (y & 7) ? '1' : '0';
+            }
+            out.println(line);
+        }
+    }
+
+    /**
+     * Start a new frame: clear the buffer and reset the text settings.
+     */
+    void clear() {
         _display.clearDisplay();
         _display.setTextSize(1);
         _display.setTextColor(SH110X_WHITE);
         _display.setCursor(0, 0);
+    }
 
+    /**
+     * Graphics context for drawing a frame.
+     */
+    Adafruit_GFX& getCanvas() { return _display; }
+
+    /**
+     * Frame buffer, same layout as the panel RAM.
+     */
+    uint8_t* getBuffer() { return _display.getBuffer(); }
+
+    void setContrast(uint8_t contrast) {
+        const uint8_t command[] = {0x81, contrast};
+        _bus.write(_device, 0x00, command, sizeof(command));
+    }
+
+    /**
+     * Draw WiFi info.
+     */
+    void drawWiFiInfo(bool connected, const String& ssid, const String& ip) {
         _display.println("WiFi Info:");
         _display.println("----------");
 
@@ -88,20 +280,13 @@ class MyDisplay {
             _display.print("IP: ");
             _display.println(ip);
         }
-
-        _display.display();
     }
 
     /**
-     * Show AP info.
+     * Draw AP info.
      */
-    void showAPInfo(const String& ssid, const String& password,
+    void drawAPInfo(const String& ssid, const String& password,
                     const String& ip) {
-        _display.clearDisplay();
-        _display.setTextSize(1);
-        _display.setTextColor(SH110X_WHITE);
-        _display.setCursor(0, 0);
-
         _display.println("WiFi Info:");
         _display.println("----------");
         _display.print("SSID: ");
@@ -110,48 +295,81 @@ class MyDisplay {
         _display.println(password);
         _display.print("IP: ");
         _display.println(ip);
-
-        _display.display();
     }
 
-    /** Overload: no args = "connecting" */
-    void showWiFiInfo() { showWiFiInfo(false, "", ""); }
-
     /**
-     * Display current time.
+     * Draw the current time.
      */
-    void showTime(const String& timeStr) {
-        _display.clearDisplay();
-        _display.setTextSize(1);
-        _display.setTextColor(SH110X_WHITE);
-        _display.setCursor(0, 0);
-
+    void drawTime(const String& timeStr) {
         _display.println("Current Time:");
         _display.println("-------------");
         _display.println(timeStr);
-
-        _display.display();
     }
 
     /**
-     * Display BME280 sensor data.
+     * Draw BME280 sensor data.
      */
-    void showSensorValues(float temperature, float humidity, float pressure,
-                          float altitude) {
-        _display.clearDisplay();
-        _display.setTextSize(1);
-        _display.setTextColor(SH110X_WHITE);
-        _display.setCursor(0, 0);
-
+    void drawSensorValues(const SensorSnapshot& snapshot) {
         _display.println("Sensor Values:");
         _display.println("--------------");
 
-        _display.printf("Temp: %.2f %c\n", temperature, (char)247);  // ° symbol
-        _display.printf("Pres: %.2f hPa\n", pressure);
-        _display.printf("Hum:  %.2f %%\n", humidity);
-        _display.printf("Alt:  %.2f m\n", altitude);
+        if (!snapshot.valid) {
+            _display.println("Sensor offline,");
+            _display.println("retrying...");
+            return;
+        }
 
-        _display.display();
+        char buf[16];
+        _display.printf("Temp: %s %c\n", MyFormat::centi(snapshot.temperatureC, buf, sizeof(buf)), (char)247);  // ° symbol
+        _display.printf("Pres: %s hPa\n", MyFormat::centi(snapshot.pressure, buf, sizeof(buf)));
+        _display.printf("Hum:  %s %%\n", MyFormat::centi(snapshot.humidity, buf, sizeof(buf)));
+        _display.printf("Alt:  %s m\n", MyFormat::centi(snapshot.altitude, buf, sizeof(buf)));
+        _display.printf("Dew:  %s %c\n", MyFormat::centi(snapshot.derived.dewPoint, buf, sizeof(buf)), (char)247);
+        if (snapshot.derived.tendencyValid) {
+            _display.printf("Fcst: %c %s hPa\n", snapshot.derived.forecast, MyFormat::centi(snapshot.derived.pressureTendency, buf, sizeof(buf)));
+        } else {
+            _display.println("Fcst: collecting...");
+        }
+    }
+
+    /**
+     * Display WiFi info.
+     */
+    void showWiFiInfo(bool connected, const String& ssid, const String& ip) {
+        clear();
+        drawWiFiInfo(connected, ssid, ip);
+        flush();
+    }
+
+    /**
+     * Show AP info.
+     */
+    void showAPInfo(const String& ssid, const String& password,
+                    const String& ip) {
+        clear();
+        drawAPInfo(ssid, password, ip);
+        flush();
+    }
+
+    /** Overload: no args = "connecting" */
+    void showWiFiInfo() { showWiFiInfo(false, "", ""); }
+
+    /**
+     * Display current time.
+     */
+    void showTime(const String& timeStr) {
+        clear();
+        drawTime(timeStr);
+        flush();
+    }
+
+    /**
+     * Display BME280 sensor data.
+     */
+    void showSensorValues(const SensorSnapshot& snapshot) {
+        clear();
+        drawSensorValues(snapshot);
+        flush();
     }
 };
 
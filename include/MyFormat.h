@@ -0,0 +1,38 @@
+/**
+ * MyFormat.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Number formatting shared by the display, the Serial Monitor, the sensor
+ * log and the telemetry encodings. No hardware dependencies.
+ */
+
+#ifndef _MY_FORMAT_H_
+#define _MY_FORMAT_H_
+
+#include <Arduino.h>
+
+#define FORMAT_CENTI_SIZE 13  // longest centi() output, "-21474836.48", and NUL
+
+class MyFormat {
+   public:
+    /**
+     * Format a value in hundredths of its unit as a decimal string, e.g.
+     * -5 -> "-0.05". Integer-only replacement for printf("%.2f").
+     * @return buf, empty rather than a cut-off number if `len` is smaller
+     * than FORMAT_CENTI_SIZE and the value does not fit
+     */
+    static char* centi(int32_t value, char* buf, size_t len) {
+        uint32_t abs = value < 0 ? -(uint32_t)value : value;
+        char text[FORMAT_CENTI_SIZE];  // always large enough
+        int n = snprintf(text, sizeof(text), "%s%u.%02u", value < 0 ? "-" : "",
+                         (unsigned)(abs / 100), (unsigned)(abs % 100));
+        if (n < 0 || (size_t)n >= len) {
+            if (len) buf[0] = '\0';
+        } else {
+            memcpy(buf, text, n + 1);
+        }
+        return buf;
+    }
+};
+
+#endif  // _MY_FORMAT_H_
@@ -0,0 +1,275 @@
+/**
+ * MyI2CBus.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Owner of the shared Wire bus (D1/D2). Sets it up once at I2C_CLOCK, runs
+ * every transaction of the attached devices and records per-device counts,
+ * bytes, errors and a latency histogram.
+ *
+ * Scheduling is cooperative: the sensor announces when it needs the bus next
+ * with reserve(), and bulk transfers (display flushes) ask mayTransfer()
+ * before every chunk, so they pause and resume on a later loop instead of
+ * delaying a sensor read.
+ *
+ * Register writes that belong together go out batched in one transaction
+ * with writeRegisters(), which saves a start, address byte and stop each.
+ */
+
+#ifndef _MY_I2C_BUS_H_
+#define _MY_I2C_BUS_H_
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define I2C_CLOCK 400000  // Hz, fast mode: supported by the BME280 and SH1106
+#define I2C_MAX_DEVICES 4
+#define I2C_TRANSACTION_OVERHEAD 40  // µs per transaction besides the bytes
+#define I2C_HISTOGRAM_BUCKETS 8      // <32 µs, <64 µs, ... , >= 2 ms
+#define I2C_HISTOGRAM_FIRST 5        // log2 of the first bucket limit
+
+/**
+ * A device on the bus and its statistics.
+ */
+struct I2CDevice {
+    const char* name;
+    uint8_t address;
+
+    uint32_t transactions = 0;
+    uint32_t bytes = 0;
+    uint32_t errors = 0;
+    uint32_t maxLatency = 0;  // µs
+    uint32_t histogram[I2C_HISTOGRAM_BUCKETS] = {};
+
+    I2CDevice(const char* name, uint8_t address)
+        : name(name), address(address) {}
+};
+
+class MyI2CBus {
+   private:
+    TwoWire& _wire;
+    uint32_t _clock;
+    I2CDevice* _devices[I2C_MAX_DEVICES];
+    uint8_t _count = 0;
+
+    bool _reserved = false;
+    unsigned long _reservedAt = 0;  // millis() of the next priority access
+    uint32_t _yields = 0;           // bulk chunks deferred for it
+    uint32_t _recoveries = 0;       // recover() calls, each re-inits Wire
+
+    void record(I2CDevice& device, uint32_t start, uint16_t bytes, bool ok) {
+        uint32_t latency = micros() - start;
+        device.transactions++;
+        device.bytes += bytes;
+        if (!ok) device.errors++;
+        if (latency > device.maxLatency) device.maxLatency = latency;
+
+        uint8_t bucket = 0;
+        uint32_t limit = 1UL << I2C_HISTOGRAM_FIRST;
+        while (latency >= limit && bucket < I2C_HISTOGRAM_BUCKETS - 1) {
+            bucket++;
+            limit <<= 1;
+        }
+        device.histogram[bucket]++;
+    }
+
+   public:
+    MyI2CBus(uint32_t clock = I2C_CLOCK, TwoWire& wire = Wire)
+        : _wire(wire), _clock(clock) {}
+
+    /**
+     * Initialize Wire and set the bus clock. Called once in setup().
+     */
+    void begin() {
+        _wire.begin();
+        _wire.setClock(_clock);
+    }
+
+    uint32_t getClock() const { return _clock; }
+
+    /**
+     * The Wire instance, for drivers that need it directly. The host tests
+     * pass an emulated bus here.
+     */
+    TwoWire& getWire() { return _wire; }
+
+    /**
+     * Add a device to the statistics.
+     */
+    void attach(I2CDevice& device) {
+        if (_count < I2C_MAX_DEVICES) _devices[_count++] = &device;
+    }
+
+    /**
+     * Read `len` bytes starting at register `reg` in one transaction.
+     */
+    bool readRegisters(I2CDevice& device, uint8_t reg, uint8_t* buf,
+                       uint8_t len) {
+        uint32_t start = micros();
+        _wire.beginTransmission(device.address);
+        _wire.write(reg);
+        bool ok = _wire.endTransmission(false) == 0 &&
+                  _wire.requestFrom(device.address, len) == len;
+        if (ok) {
+            for (uint8_t i = 0; i < len; i++) buf[i] = _wire.read();
+        }
+        record(device, start, len + 1, ok);
+        return ok;
+    }
+
+    /**
+     * Write a single register.
+     */
+    bool writeRegister(I2CDevice& device, uint8_t reg, uint8_t value) {
+        return write(device, reg, &value, 1);
+    }
+
+    /**
+     * Write `count` register/value pairs in one transaction, for devices
+     * that take them in a single write (BME280, datasheet 6.2.1). They are
+     * applied in order.
+     */
+    bool writeRegisters(I2CDevice& device, const uint8_t* pairs, uint8_t count) {
+        uint32_t start = micros();
+        _wire.beginTransmission(device.address);
+        _wire.write(pairs, 2 * count);
+        bool ok = _wire.endTransmission() == 0;
+        record(device, start, 2 * count, ok);
+        return ok;
+    }
+
+    /**
+     * Write a control (or register) byte followed by `len` data bytes in
+     * one transaction.
+     */
+    bool write(I2CDevice& device, uint8_t control, const uint8_t* data,
+               uint8_t len) {
+        uint32_t start = micros();
+        _wire.beginTransmission(device.address);
+        _wire.write(control);
+        _wire.write(data, len);
+        bool ok = _wire.endTransmission() == 0;
+        record(device, start, len + 1, ok);
+        return ok;
+    }
+
+    /**
+     * Announce that a priority device needs the bus at millis() `at`.
+     */
+    void reserve(unsigned long at) {
+        _reserved = true;
+        _reservedAt = at;
+    }
+
+    /**
+     * Estimated duration of a transaction of `bytes` bytes in µs, 9 clocks
+     * per byte plus the address byte and start/stop.
+     */
+    uint32_t transferTime(uint16_t bytes) const {
+        return (bytes + 1) * 9000000UL / _clock + I2C_TRANSACTION_OVERHEAD;
+    }
+
+    /**
+     * Check whether a bulk transaction of `bytes` fits in before the next
+     * reserved access. Bulk writers call this before every chunk but the
+     * first, so they always make progress.
+     */
+    bool mayTransfer(uint16_t bytes) {
+        if (!_reserved) return true;
+        long left = (long)(_reservedAt - millis());
+        if (left > 0 && (uint32_t)left * 1000 > transferTime(bytes)) {
+            return true;
+        }
+        _yields++;
+        return false;
+    }
+
+    /**
+     * Check whether a slave holds SDA low on the idle bus.
+     */
+    bool isHung() const { return digitalRead(SDA) == LOW; }
+
+    /**
+     * Release a slave that holds SDA low after an interrupted transfer by
+     * clocking SCL until it lets go, then issue a STOP and re-init Wire.
+     * Takes well under a millisecond, but re-initializing Wire resets the
+     * clock under every other device, so only call it when the bus is hung
+     * (isHung()) or transactions kept failing.
+     * @return true if SDA was held low
+     */
+    bool recover() {
+        _recoveries++;
+        pinMode(SDA, INPUT_PULLUP);
+        pinMode(SCL, OUTPUT_OPEN_DRAIN);
+        digitalWrite(SCL, HIGH);
+
+        bool hung = digitalRead(SDA) == LOW;
+        if (hung) Serial.println("[I2C] SDA held low, clearing bus...");
+
+        for (uint8_t i = 0; i < 9 && digitalRead(SDA) == LOW; i++) {
+            digitalWrite(SCL, LOW);
+            delayMicroseconds(5);
+            digitalWrite(SCL, HIGH);
+            delayMicroseconds(5);
+        }
+
+        // STOP: SDA rises while SCL is high
+        pinMode(SDA, OUTPUT_OPEN_DRAIN);
+        digitalWrite(SDA, LOW);
+        delayMicroseconds(5);
+        digitalWrite(SDA, HIGH);
+        delayMicroseconds(5);
+
+        begin();
+        return hung;
+    }
+
+    /**
+     * I2C Scanner: prints to Serial.
+     */
+    void scan() {
+        Serial.println("[I2C Scanner] I2C devices found:");
+
+        uint8_t count = 0;
+
+        for (uint8_t i = 1; i < 120; i++) {
+            _wire.beginTransmission(i);
+            if (_wire.endTransmission() == 0) {
+                Serial.printf("[I2C Scanner] Found address: %d (0x%02X)\n", i, i);
+                count++;
+                delay(1);
+            }
+        }
+
+        Serial.printf("[I2C Scanner] Done. Found %d device(s).\n", count);
+    }
+
+    uint32_t getRecoveries() const { return _recoveries; }
+
+    /**
+     * Print per-device statistics to the Serial Monitor.
+     */
+    void printStats() {
+        Serial.printf("I2C Bus: %u kHz, %u bulk chunks deferred, %u recoveries\n",
+                      _clock / 1000, _yields, _recoveries);
+        for (uint8_t i = 0; i < _count; i++) {
+            const I2CDevice& d = *_devices[i];
+            Serial.printf("%s (0x%02X): %u transactions, %u B, %u errors, "
+                          "max. %u µs\n",
+                          d.name, d.address, d.transactions, d.bytes, d.errors,
+                          d.maxLatency);
+            Serial.print("  µs:");
+            for (uint8_t b = 0; b < I2C_HISTOGRAM_BUCKETS; b++) {
+                uint32_t limit = 1UL << (I2C_HISTOGRAM_FIRST + b);
+                if (b < I2C_HISTOGRAM_BUCKETS - 1) {
+                    Serial.printf(" <%u:%u", limit, d.histogram[b]);
+                } else {
+                    Serial.printf(" >=%u:%u", limit >> 1, d.histogram[b]);
+                }
+            }
+            Serial.println();
+        }
+        Serial.println();
+    }
+};
+
+#endif  // _MY_I2C_BUS_H_
@@ -4,6 +4,10 @@
  * Draw your own logos with
  * https://www.espboards.dev/tools/monochrome-bitmap-tool/ or
  * https://javl.github.io/image2cpp/ Benjamin Hartmann | 10/2025
+ *
+ * tools/pack_logos.py packs every bitmap here into MyLogosPacked.h on each
+ * build. Name them <name>Bmp with <NAME>_WIDTH and <NAME>_HEIGHT defines;
+ * animations store their frames one after another and add <NAME>_FRAMES.
  */
 
 #ifndef _MY_LOGOS_H_
@@ -69,4 +73,32 @@ const unsigned char PROGMEM e621_9da280Bmp[] = {
     0xcf, 0xf9, 0xfc, 0x7f, 0xff, 0x0f, 0xfe, 0xfe, 0xff, 0xff, 0xfe, 0x3f,
     0xfe, 0x1f, 0xbf, 0xff, 0xff, 0xfd, 0xfe, 0x1f};
 
+// Busy spinner, 16x16px, 8 frames one after another
+#define SPINNER_HEIGHT 16
+#define SPINNER_WIDTH 16
+#define SPINNER_FRAMES 8
+const unsigned char PROGMEM spinnerBmp[] = {
+    0x00, 0x00, 0x01, 0xc0, 0x01, 0xc0, 0x19, 0xc0, 0x18, 0x10, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x20, 0x04, 0x00, 0x00, 0x00, 0x00, 0x08, 0x10,
+    0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x80,
+    0x01, 0x80, 0x00, 0x38, 0x08, 0x38, 0x00, 0x38, 0x00, 0x00, 0x00, 0x00,
+    0x20, 0x04, 0x00, 0x00, 0x00, 0x00, 0x08, 0x10, 0x00, 0x00, 0x00, 0x80,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x30,
+    0x08, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0e, 0x20, 0x0e, 0x00, 0x0e,
+    0x00, 0x00, 0x08, 0x10, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x08, 0x10, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x0c, 0x20, 0x0c, 0x00, 0x00, 0x00, 0x38, 0x08, 0x38,
+    0x00, 0x38, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x80, 0x00, 0x00, 0x08, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x20, 0x04, 0x00, 0x00, 0x00, 0x30, 0x08, 0x30, 0x01, 0xc0, 0x01, 0xc0,
+    0x01, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00,
+    0x08, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x04, 0x00, 0x00,
+    0x1c, 0x00, 0x1c, 0x10, 0x1d, 0x80, 0x01, 0x80, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x08, 0x10, 0x00, 0x00,
+    0x00, 0x00, 0x70, 0x00, 0x70, 0x04, 0x70, 0x00, 0x18, 0x00, 0x18, 0x10,
+    0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x80, 0x1c, 0x00, 0x1c, 0x10, 0x1c, 0x00, 0x00, 0x00, 0x60, 0x00,
+    0x60, 0x04, 0x00, 0x00, 0x00, 0x00, 0x08, 0x10, 0x00, 0x00, 0x00, 0x80,
+    0x00, 0x00, 0x00, 0x00};
+
 #endif  // _MY_LOGOS_H_
\ No newline at end of file
@@ -0,0 +1,79 @@
+/**
+ * MyLogosPacked.h
+ * Generated by tools/pack_logos.py from MyLogos.h, do not edit.
+ *
+ * Run-length encoded page layout bitmaps for MyPackedBitmap.
+ */
+
+#ifndef _MY_LOGOS_PACKED_H_
+#define _MY_LOGOS_PACKED_H_
+
+#include "MyPackedBitmap.h"
+
+// adafruitLogoBmp: 16x16 px, 1 frame(s), 32 B instead of 32 B, unencoded
+const uint8_t PROGMEM adafruitLogoPackedData[] = {
+    0x30, 0x70, 0xf0, 0xf0, 0x60, 0x60, 0xf8, 0x9e, 0xff, 0x7f, 0x78, 0xe0,
+    0xe0, 0xc0, 0xc0, 0xc0, 0x00, 0x60, 0x78, 0x7d, 0x3f, 0x3b, 0x1d, 0x1f,
+    0x3d, 0x7b, 0xff, 0xf3, 0x01, 0x01, 0x00, 0x00};
+const PackedBitmap adafruitLogoPacked = {16, 16, 2, 1, false, 32, adafruitLogoPackedData, nullptr};
+
+// e621_9da280Bmp: 64x64 px, 1 frame(s), 439 B instead of 512 B
+const uint8_t PROGMEM e621_9da280PackedData[] = {
+    0x80, 0x7f, 0x07, 0xe7, 0xf9, 0xfe, 0xfc, 0xf3, 0xdf, 0x7f, 0x7f, 0x83,
+    0xff, 0x25, 0x7f, 0x3f, 0xdf, 0xef, 0x77, 0xc3, 0x7d, 0xbf, 0x3f, 0xbf,
+    0xdf, 0xef, 0xef, 0xf7, 0x77, 0xbf, 0x3b, 0xfd, 0xfe, 0xfc, 0xf3, 0x1f,
+    0x9e, 0x30, 0x0e, 0x7d, 0xfb, 0xf7, 0xef, 0x87, 0x67, 0xf3, 0xf9, 0xfc,
+    0xfe, 0xff, 0xff, 0xbf, 0x85, 0xff, 0x05, 0x3f, 0xc0, 0xff, 0xff, 0xe3,
+    0x3f, 0x81, 0xff, 0x00, 0xdf, 0x82, 0xff, 0x13, 0xfe, 0xff, 0xfd, 0xdb,
+    0xf8, 0xfe, 0xff, 0x9f, 0xdf, 0x78, 0xfe, 0xcd, 0xdd, 0xf7, 0xff, 0xf8,
+    0x7f, 0xdf, 0xfe, 0xff, 0x81, 0xf7, 0x07, 0xcf, 0xff, 0xad, 0xf7, 0x7f,
+    0xfe, 0x1a, 0xc0, 0x82, 0xff, 0x06, 0xfe, 0xf1, 0x7f, 0x4b, 0xeb, 0xf7,
+    0xfd, 0x85, 0xff, 0x01, 0x0f, 0xe0, 0x82, 0xff, 0x0b, 0xfc, 0xe7, 0x1f,
+    0x0f, 0x3f, 0x3f, 0xfe, 0xff, 0xf1, 0xe5, 0xcf, 0x39, 0x83, 0xff, 0x1e,
+    0xfd, 0x63, 0xeb, 0xde, 0xb1, 0xb7, 0x6f, 0xff, 0xba, 0x77, 0x77, 0xba,
+    0xdf, 0x7f, 0xbb, 0xdd, 0xcc, 0xa7, 0xf2, 0xd1, 0xbc, 0x9c, 0x7f, 0xff,
+    0xff, 0x7f, 0xbf, 0xdf, 0xc3, 0xcd, 0xef, 0x81, 0xff, 0x0a, 0xbf, 0xff,
+    0xef, 0xf7, 0xf7, 0xf3, 0x78, 0x38, 0xcd, 0xf1, 0xfd, 0x81, 0xff, 0x1c,
+    0x8f, 0x6f, 0xdc, 0xf8, 0xa8, 0x98, 0x1b, 0x37, 0x6f, 0x1f, 0x7b, 0xc6,
+    0xfd, 0xfb, 0x3f, 0xb7, 0xb7, 0x3c, 0xbc, 0xbd, 0x9f, 0xbe, 0x3f, 0xfe,
+    0xff, 0xff, 0xfa, 0xfd, 0xfe, 0x81, 0xff, 0x02, 0xdf, 0xeb, 0xcf, 0x81,
+    0xf7, 0x04, 0xf3, 0xf2, 0xdb, 0xfb, 0xf3, 0x81, 0xff, 0x0f, 0xbf, 0xff,
+    0x7d, 0xfb, 0xff, 0xff, 0x7f, 0x7f, 0x1f, 0xe7, 0xf9, 0xff, 0x7f, 0x1f,
+    0x0f, 0x0f, 0x81, 0xff, 0x0d, 0xfe, 0xf9, 0xf7, 0xdf, 0xbf, 0x3f, 0x7e,
+    0xfe, 0xfe, 0xf9, 0xfb, 0xe3, 0xff, 0xfd, 0x91, 0xff, 0x01, 0xde, 0xef,
+    0x82, 0xff, 0x00, 0xfe, 0x82, 0xff, 0x19, 0x7f, 0xff, 0xff, 0xef, 0x77,
+    0x7b, 0xff, 0xbf, 0x5f, 0x9f, 0xe6, 0xf8, 0xfc, 0x7e, 0xb6, 0xd2, 0x69,
+    0xff, 0xff, 0xf7, 0xf7, 0xeb, 0xcb, 0xdb, 0xbd, 0xbd, 0x81, 0x7e, 0x10,
+    0x7d, 0x7f, 0x7b, 0x6f, 0x3f, 0xbf, 0x67, 0xef, 0xef, 0xff, 0x3f, 0x9f,
+    0x9f, 0xbf, 0xfe, 0xbf, 0x3f, 0x82, 0xff, 0x0b, 0x7f, 0xff, 0xff, 0x9f,
+    0xcf, 0xef, 0xf7, 0xff, 0xfb, 0xff, 0xf9, 0xfa, 0x81, 0xfb, 0x0f, 0xff,
+    0xdd, 0xc5, 0x9c, 0x3d, 0x1d, 0xc3, 0xee, 0xf7, 0xfb, 0xfd, 0xfe, 0xff,
+    0x3f, 0xe3, 0xfc, 0x87, 0xff, 0x07, 0x7e, 0xbc, 0xdc, 0xe1, 0xf3, 0xfb,
+    0xff, 0xfe, 0x84, 0xff, 0x03, 0xfd, 0xf7, 0x7f, 0x9f, 0x93, 0xff, 0x0f,
+    0xef, 0xff, 0xdf, 0xdf, 0x5f, 0x1e, 0xec, 0xfd, 0xfb, 0xfb, 0xff, 0xff,
+    0x07, 0xcc, 0xf3, 0xf9, 0x85, 0xff, 0x10, 0x7f, 0x3f, 0x1f, 0x06, 0x80,
+    0xc0, 0xfa, 0xfc, 0xfc, 0xfd, 0x7f, 0xff, 0xff, 0xdf, 0xdf, 0xff, 0xbf,
+    0x85, 0xff, 0x0a, 0xbf, 0xff, 0xff, 0xdf, 0xdf, 0xff, 0xef, 0xff, 0xff,
+    0xf7, 0xfb, 0x81, 0xff, 0x01, 0xdf, 0x4f, 0x83, 0xff, 0x06, 0xfc, 0xf0,
+    0xc3, 0x0f, 0x1f, 0x3f, 0x7f, 0x83, 0xff};
+const PackedBitmap e621_9da280Packed = {64, 64, 8, 1, true, 439, e621_9da280PackedData, nullptr};
+
+// spinnerBmp: 16x16 px, 8 frame(s), 174 B instead of 256 B
+const uint8_t PROGMEM spinnerPackedData[] = {
+    0x81, 0x00, 0x80, 0x18, 0x80, 0x00, 0x81, 0x0e, 0x01, 0x00, 0x10, 0x84,
+    0x00, 0x02, 0x01, 0x00, 0x08, 0x81, 0x00, 0x07, 0x20, 0x00, 0x00, 0x08,
+    0x00, 0x01, 0x00, 0x00, 0x81, 0x00, 0x09, 0x18, 0x08, 0x00, 0x00, 0x08,
+    0x08, 0x0e, 0x38, 0x28, 0x38, 0x91, 0x00, 0x85, 0x00, 0x07, 0x06, 0x02,
+    0x00, 0x20, 0x20, 0xb8, 0x80, 0x80, 0x8b, 0x00, 0x03, 0x03, 0x02, 0x03,
+    0x00, 0x88, 0x00, 0x04, 0x18, 0x08, 0x00, 0x00, 0x80, 0x89, 0x00, 0x05,
+    0x1c, 0x14, 0x1e, 0x02, 0x03, 0x00, 0x8a, 0x00, 0x80, 0x80, 0x87, 0x00,
+    0x05, 0x70, 0x50, 0x70, 0x10, 0x10, 0x1d, 0x81, 0x00, 0x91, 0x00, 0x08,
+    0x1c, 0x14, 0x1c, 0x00, 0x40, 0x40, 0x70, 0x0c, 0x04, 0x82, 0x00, 0x00,
+    0x00, 0x81, 0x80, 0x8b, 0x00, 0x07, 0x03, 0x02, 0x13, 0x10, 0x1c, 0x00,
+    0x30, 0x10, 0x85, 0x00, 0x81, 0x00, 0x02, 0xb8, 0x28, 0x38, 0x89, 0x00,
+    0x80, 0x02, 0x01, 0x0f, 0x04, 0x89, 0x00, 0x09, 0x00, 0x80, 0x80, 0x20,
+    0x20, 0x38, 0x00, 0x0e, 0x0a, 0x0e, 0x85, 0x00, 0x00, 0x01, 0x8c, 0x00};
+const uint16_t PROGMEM spinnerPackedOffsets[] = {0, 28, 43, 61, 78, 93, 107, 124, 139};
+const PackedBitmap spinnerPacked = {16, 16, 2, 8, true, 156, spinnerPackedData, spinnerPackedOffsets};
+
+#endif  // _MY_LOGOS_PACKED_H_
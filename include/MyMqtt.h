@@ -8,136 +8,877 @@
 
 #include <ESP8266WiFi.h>
 #include <PubSubClient.h>
+#include <array>
+#include <functional>
 
 #include "MqttCredentials.h"
+#include "MyDeadband.h"
+#include "MyFormat.h"
+#include "MyMqttCommand.h"
+#include "MyMqttLoopback.h"
+#include "MyMqttQueue.h"
+#include "MyMqttSocket.h"
+#include "MySensor.h"
+#include "MyTelemetryCodec.h"
 
 #define QOS 1        // Quality of Service Level
 #define RETAIN true  // retained message
 
+#define MQTT_BACKOFF_MIN 1000     // ms before the first retry
+#define MQTT_BACKOFF_MAX 60000    // ms, upper bound of the retry delay
+#define MQTT_READ_TIMEOUT 1       // s PubSubClient may wait for a packet, see MyMqttSocket
+
+#define MQTT_BUFFER_SIZE 512      // PubSubClient packet buffer, default 256
+#define MQTT_TOPIC_SIZE 96        // topic base + longest topic name
+#define MQTT_PAYLOAD_SIZE 384     // telemetry document or backlog message
+#define MQTT_NAME_SIZE 32         // device name and place
+#define MQTT_REPLAY_INTERVAL 250  // ms between backlog messages
+#define MQTT_REPLAY_BATCH 8       // queued samples per backlog message
+#define MQTT_PUBLISH_INTERVAL 1000  // ms between samples, default
+#define MQTT_INTERVAL_MIN 100       // ms, limits of the interval command
+#define MQTT_INTERVAL_MAX 3600000
+#define MQTT_HEAP_TEST_SLACK 512    // B the largest free block may dip, Wi-Fi buffers
+
+// PubSubClient already defines MQTT_CONNECTED etc. for its return codes
+enum MqttLinkState {
+    MQTT_LINK_WAITING,     // not connected, next attempt at _nextAttempt
+    MQTT_LINK_CONNECTING,  // attempt under way, until the broker's CONNACK
+    MQTT_LINK_UP,          // connected to the broker
+};
+
+/**
+ * How a sample is published.
+ * Fields: every value as a plain string on its own topic, as before.
+ * Batch: one JSON document with all values, the time and the schema version
+ * on the telemetry topic.
+ * CBOR: the same sample as compact binary on its own topic, see
+ * MyTelemetryCodec.
+ */
+enum MqttPublishMode {
+    MQTT_PUBLISH_FIELDS,
+    MQTT_PUBLISH_BATCH,
+    MQTT_PUBLISH_CBOR,
+};
+
+/**
+ * Published sensor values, in the order of their topics. The last two are
+ * only known once the pressure tendency is.
+ */
+enum MqttField {
+    MQTT_FIELD_TEMPERATURE,
+    MQTT_FIELD_HUMIDITY,
+    MQTT_FIELD_PRESSURE,
+    MQTT_FIELD_ALTITUDE,
+    MQTT_FIELD_DEW_POINT,
+    MQTT_FIELD_ABSOLUTE_HUMIDITY,
+    MQTT_FIELD_HEAT_INDEX,
+    MQTT_FIELD_PRESSURE_TENDENCY,
+    MQTT_FIELD_FORECAST,
+    MQTT_FIELD_COUNT
+};
+
+// Topic names below the topic base
+const char* const mqttFieldTopics[MQTT_FIELD_COUNT] = {
+    "BME280_Temperature_°C",
+    "BME280_Humidity_%",
+    "BME280_Pressure_hPa",
+    "BME280_Altitude_m",
+    "BME280_DewPoint_°C",
+    "BME280_AbsoluteHumidity_g_m³",
+    "BME280_HeatIndex_°C",
+    "BME280_PressureTendency_hPa_3h",
+    "BME280_Forecast",
+};
+#define MQTT_TOPIC_LWT "WifiStatus"
+#define MQTT_TOPIC_DEVICE_NAME "DeviceName"
+#define MQTT_TOPIC_DEVICE_PLACE "DevicePlace"
+#define MQTT_TOPIC_WIFI_SSID "WiFi_SSID"
+#define MQTT_TOPIC_WIFI_IP "WiFi_IP"
+#define MQTT_TOPIC_TIMESTAMP "TimeStamp"
+#define MQTT_TOPIC_TELEMETRY "BME280_Telemetry"
+#define MQTT_TOPIC_TELEMETRY_CBOR "BME280_Telemetry_CBOR"
+#define MQTT_TOPIC_BACKLOG "BME280_Backlog"
+#define MQTT_TOPIC_COMMAND "Command"
+#define MQTT_TOPIC_COMMAND_ACK "CommandAck"
+
+/**
+ * Handles the commands MyMqtt does not know itself, see handleCommand().
+ * @return false if the command is unknown
+ */
+typedef std::function<bool(MyMqttCommand& command)> MqttCommandHandler;
+
+/**
+ * Publish statistics. Bytes are whole MQTT packets as sent.
+ */
+struct MqttPublishStats {
+    uint32_t messages = 0;
+    uint32_t bytes = 0;
+    uint32_t samples = 0;
+    uint32_t sampleMessages = 0;
+    uint32_t sampleBytes = 0;
+    uint32_t sampleTime = 0;  // µs, sum over all samples
+    uint32_t suppressed = 0;  // messages not sent thanks to the deadbands
+    uint32_t jumps = 0;
+    uint32_t heartbeats = 0;
+};
+
+/**
+ * The publish path works on fixed buffers only: topics are written behind
+ * the topic base that is already in `_topic`, payloads are formatted in
+ * place into `_payload` or a small stack buffer, and PubSubClient keeps its
+ * packet buffer from begin() on. Publishing a sample does not touch the
+ * heap.
+ */
 class MyMqtt {
    private:
-    String _clientId =
-        "ESP-" + String(ESP.getChipId()) + "-" + String(random(0xffff), HEX);
-    WiFiClient _wifi;
-    PubSubClient _client = PubSubClient(_wifi);
-
-    String _allTopics;
-    String _lwtTopic;
-    String _deviceNameTopic;
-    String _devicePlaceTopic;
-    String _wifiSsidTopic;
-    String _wifiIpTopic;
-    String _timestampTopic;
-    String _debugTopic;
-    String _bmeTemperatureTopic;
-    String _bmeHumidityTopic;
-    String _bmePressureTopic;
-    String _bmeAltitudeTopic;
-
-    String _deviceName;
-    String _devicePlace;
-
-    /**
-     * Send initial MQTT messages (LWT, device info, WiFi info).
+    char _clientId[24];
+    MyMqttSocket _socket;
+    PubSubClient _client = PubSubClient(_socket);
+
+    char _topic[MQTT_TOPIC_SIZE];  // topic base, then the current topic name
+    size_t _baseLength;
+    char _payload[MQTT_PAYLOAD_SIZE];
+
+    char _deviceName[MQTT_NAME_SIZE];
+    char _devicePlace[MQTT_NAME_SIZE];
+
+    MqttLinkState _state = MQTT_LINK_WAITING;
+    unsigned long _stateSince = 0;
+    unsigned long _nextAttempt = 0;  // millis()
+    uint8_t _failures = 0;           // failed attempts in a row
+
+    // Connection statistics
+    uint32_t _attempts = 0;
+    uint32_t _connects = 0;
+    uint32_t _drops = 0;  // established connections lost
+    int _lastError = 0;   // PubSubClient state() of the last failure
+    uint32_t _attemptTime = 0;  // ms, last attempt from open() to the result
+    uint32_t _maxAttemptTime = 0;
+    uint32_t _lastDelay = 0;  // ms, last backoff
+
+    MqttPublishMode _mode = MQTT_PUBLISH_FIELDS;
+    unsigned long _interval = MQTT_PUBLISH_INTERVAL;
+    PubSubClient* _publisher = &_client;  // the heap test's loopback client
+
+    // Deadband and jump threshold per field, in raw units (0.01 °C, 0.01 %RH,
+    // Pa, cm, 0.01 g/m³). Any forecast change is reported at once.
+    std::array<MyDeadband, MQTT_FIELD_COUNT> _fields = {{
+        {"temperature", 10, 100},
+        {"humidity", 50, 500},
+        {"pressure", 10, 100},
+        {"altitude", 100, 1000},
+        {"dewPoint", 10, 100},
+        {"absoluteHumidity", 10, 100},
+        {"heatIndex", 10, 100},
+        {"pressureTendency", 10, 100},
+        {"forecast", 1, 1},
+    }};
+
+    // Samples taken while offline, sent on the backlog topic afterwards
+    MyMqttQueue _queue;
+    unsigned long _lastReplay = 0;
+
+    MqttPublishStats _stats;
+
+    MqttCommandHandler _commandHandler;
+    uint32_t _commands = 0;
+
+    /**
+     * Size of a QoS 0 PUBLISH packet: fixed header with the remaining
+     * length, topic with its length prefix and the payload.
+     */
+    static uint32_t packetSize(const char* topic, size_t length) {
+        uint32_t remaining = 2 + strlen(topic) + length;
+        uint8_t lengthBytes = remaining < 128 ? 1 : remaining < 16384 ? 2 : 3;
+        return 1 + lengthBytes + remaining;
+    }
+
+    /**
+     * Full topic for `name`. Valid until the next call.
+     */
+    const char* topic(const char* name) {
+        strlcpy(_topic + _baseLength, name, sizeof(_topic) - _baseLength);
+        return _topic;
+    }
+
+    static int32_t fieldValue(const SensorSnapshot& snapshot, uint8_t field) {
+        switch (field) {
+            case MQTT_FIELD_TEMPERATURE:
+                return snapshot.temperatureC;
+            case MQTT_FIELD_HUMIDITY:
+                return snapshot.humidity;
+            case MQTT_FIELD_PRESSURE:
+                return snapshot.pressure;
+            case MQTT_FIELD_ALTITUDE:
+                return snapshot.altitude;
+            case MQTT_FIELD_DEW_POINT:
+                return snapshot.derived.dewPoint;
+            case MQTT_FIELD_ABSOLUTE_HUMIDITY:
+                return snapshot.derived.absoluteHumidity;
+            case MQTT_FIELD_HEAT_INDEX:
+                return snapshot.derived.heatIndex;
+            case MQTT_FIELD_PRESSURE_TENDENCY:
+                return snapshot.derived.pressureTendency;
+            default:
+                return snapshot.derived.forecast;
+        }
+    }
+
+    static uint8_t fieldCount(const SensorSnapshot& snapshot) {
+        return snapshot.derived.tendencyValid ? MQTT_FIELD_COUNT
+                                              : MQTT_FIELD_PRESSURE_TENDENCY;
+    }
+
+    void countReason(DeadbandReason reason) {
+        if (reason == DEADBAND_JUMP) _stats.jumps++;
+        if (reason == DEADBAND_HEARTBEAT) _stats.heartbeats++;
+    }
+
+    bool publish(const char* topic, const char* payload) {
+        return publish(topic, (const uint8_t*)payload, strlen(payload));
+    }
+
+    bool publish(const char* topic, const uint8_t* payload, size_t length,
+                 bool retain = RETAIN) {
+        // PubSubClient takes the socket's CONNACK, the broker may still refuse
+        if (_publisher == &_client && _state != MQTT_LINK_UP) return false;
+        if (!_publisher->publish(topic, payload, length, retain)) {
+            return false;
+        }
+        _stats.messages++;
+        _stats.bytes += packetSize(topic, length);
+        return true;
+    }
+
+    /**
+     * Send initial MQTT messages (LWT, device info, WiFi info). Only on
+     * connect, so the Strings of the WiFi API are fine here.
      */
     void sendInitMessages() {
-        _client.publish(_lwtTopic.c_str(), "online", RETAIN);
-        _client.publish(_deviceNameTopic.c_str(), _deviceName.c_str(), RETAIN);
-        _client.publish(_devicePlaceTopic.c_str(), _devicePlace.c_str(), RETAIN);
-        _client.publish(_wifiSsidTopic.c_str(), WiFi.SSID().c_str(), RETAIN);
-        _client.publish(_wifiIpTopic.c_str(), WiFi.localIP().toString().c_str(),
-                       RETAIN);
+        publish(topic(MQTT_TOPIC_LWT), "online");
+        publish(topic(MQTT_TOPIC_DEVICE_NAME), _deviceName);
+        publish(topic(MQTT_TOPIC_DEVICE_PLACE), _devicePlace);
+        publish(topic(MQTT_TOPIC_WIFI_SSID), WiFi.SSID().c_str());
+        publish(topic(MQTT_TOPIC_WIFI_IP), WiFi.localIP().toString().c_str());
     }
 
     /**
-     * Connect to the MQTT broker.
-     * This function is blocking.
+     * Send the oldest queued samples as one backlog message, not retained:
+     * {"v":1,"s":[[1760000000,21.50,45.20,1013.25],...]}
+     * with epoch, °C, %RH and hPa per sample. Paced by MQTT_REPLAY_INTERVAL,
+     * so catching up never crowds out live messages.
      */
-    void connect() {
-        // Loop until we're reconnected
-        while (!_client.connected()) {
-            Serial.print("Attempting MQTT connection...");
-
-            // Attempt to connect
-            if (_client.connect(_clientId.c_str(), MY_MQTT_USERNAME, MY_MQTT_PASSWORD, _lwtTopic.c_str(), QOS, RETAIN, "offline")) {
-                Serial.printf(" - Connected to MQTT Broker: %s:%d\n", MY_MQTT_BROKER, MY_MQTT_PORT);
-                _client.subscribe(_allTopics.c_str());
-                sendInitMessages();
-            } else {
-                Serial.printf("failed, rc=%d, trying again in 5 seconds\n", _client.state());
-                delay(5000);
+    void replay() {
+        if (!_queue.isReady() || millis() - _lastReplay < MQTT_REPLAY_INTERVAL) {
+            return;
+        }
+        _lastReplay = millis();
+
+        QueuedSample samples[MQTT_REPLAY_BATCH];
+        uint16_t n = _queue.peek(samples, MQTT_REPLAY_BATCH);
+        if (n) {
+            size_t length = snprintf(_payload, sizeof(_payload), "{\"v\":%u,\"s\":[",
+                                     TELEMETRY_SCHEMA_VERSION);
+            for (uint16_t i = 0; i < n && length < sizeof(_payload); i++) {
+                char temperature[16], humidity[16], pressure[16];
+                const HistorySample& s = samples[i].sample;
+                length += snprintf(_payload + length, sizeof(_payload) - length,
+                                   "%s[%u,%s,%s,%s]", i ? "," : "", samples[i].epoch,
+                                   MyFormat::centi(s.temperature, temperature, sizeof(temperature)),
+                                   MyFormat::centi(s.humidity, humidity, sizeof(humidity)),
+                                   MyFormat::centi(s.pressure + 100000L, pressure, sizeof(pressure)));
+            }
+            if (length + 2 >= sizeof(_payload)) return;  // cannot happen with 8 samples
+            length += snprintf(_payload + length, sizeof(_payload) - length, "]}");
+
+            if (!publish(topic(MQTT_TOPIC_BACKLOG), (const uint8_t*)_payload, length, false)) {
+                return;
             }
         }
+        _queue.pop();
     }
 
-   public:
-    MyMqtt(String deviceName, String devicePlace, String topicBase) {
-        _allTopics = topicBase + "#";
-        _lwtTopic = topicBase + "WifiStatus";
+    /**
+     * Publish each field that its deadband lets through at `now`, or all
+     * of them if `force` is set.
+     * @return true if at least one field was published
+     */
+    bool publishFields(const SensorSnapshot& snapshot, unsigned long now,
+                       bool force) {
+        if (!snapshot.valid) return false;
+
+        bool sent = false;
+        for (uint8_t f = 0; f < fieldCount(snapshot); f++) {
+            int32_t value = fieldValue(snapshot, f);
+            DeadbandReason reason = _fields[f].check(value, now);
+            if (reason == DEADBAND_SUPPRESSED && !force) {
+                _fields[f].suppress();
+                _stats.suppressed++;
+                continue;
+            }
+
+            char buf[16];
+            const char* payload =
+                f == MQTT_FIELD_FORECAST
+                    ? MyDerivedMetrics::getForecastText(value)
+                    : MyFormat::centi(value, buf, sizeof(buf));
+            if (!publish(topic(mqttFieldTopics[f]), payload)) continue;
+            _fields[f].commit(value, now);
+            countReason(reason);
+            sent = true;
+        }
+        return sent;
+    }
+
+    /**
+     * Publish a sample as one telemetry document, JSON or CBOR (see
+     * MyTelemetryCodec). The document always holds every field, it is sent
+     * when any field's deadband lets it through at `now`, or if `force` is
+     * set.
+     */
+    void publishDocument(const SensorSnapshot& snapshot, TelemetryEncoding encoding,
+                         unsigned long now, bool force) {
+        if (!snapshot.valid) return;
+
+        DeadbandReason reasons[MQTT_FIELD_COUNT];
+        bool due = force;
+        for (uint8_t f = 0; f < fieldCount(snapshot); f++) {
+            reasons[f] = _fields[f].check(fieldValue(snapshot, f), now);
+            if (reasons[f] != DEADBAND_SUPPRESSED) due = true;
+        }
+        if (!due) {
+            for (uint8_t f = 0; f < fieldCount(snapshot); f++) _fields[f].suppress();
+            _stats.suppressed++;
+            return;
+        }
+
+        size_t length;
+        const char* name;
+        if (encoding == TELEMETRY_CBOR) {
+            length = MyTelemetryCodec::encodeCbor(snapshot, (uint8_t*)_payload, sizeof(_payload));
+            name = MQTT_TOPIC_TELEMETRY_CBOR;
+        } else {
+            length = MyTelemetryCodec::formatJson(snapshot, _payload, sizeof(_payload));
+            name = MQTT_TOPIC_TELEMETRY;
+        }
+        if (!length || !publish(topic(name), (const uint8_t*)_payload, length)) {
+            return;
+        }
+        for (uint8_t f = 0; f < fieldCount(snapshot); f++) {
+            _fields[f].commit(fieldValue(snapshot, f), now);
+            countReason(reasons[f]);
+        }
+    }
+
+    /**
+     * Publish a sample in the configured mode as of `now` and record its
+     * cost.
+     */
+    void publishSample(const SensorSnapshot& snapshot, const char* timeStamp,
+                       unsigned long now) {
+        uint32_t start = micros();
+        uint32_t messages = _stats.messages;
+        uint32_t bytes = _stats.bytes;
+
+        if (_mode != MQTT_PUBLISH_FIELDS) {
+            publishDocument(snapshot, getEncoding(_mode), now, false);
+        } else if (publishFields(snapshot, now, false)) {
+            publishTimeStamp(timeStamp);
+        }
+
+        if (_stats.messages == messages) return;
+        _stats.samples++;
+        _stats.sampleMessages += _stats.messages - messages;
+        _stats.sampleBytes += _stats.bytes - bytes;
+        _stats.sampleTime += micros() - start;
+    }
+
+    void setState(MqttLinkState state) {
+        _state = state;
+        _stateSince = millis();
+    }
+
+    /**
+     * Schedule the next attempt after `_failures` failures: the delay
+     * doubles from MQTT_BACKOFF_MIN up to MQTT_BACKOFF_MAX, and its second
+     * half is random, so devices that lost the broker together do not retry
+     * in lockstep.
+     */
+    void backoff() {
+        uint32_t wait = MQTT_BACKOFF_MAX;
+        if (_failures <= 16) {
+            wait = min((uint32_t)MQTT_BACKOFF_MIN << (_failures - 1),
+                       (uint32_t)MQTT_BACKOFF_MAX);
+        }
+        _lastDelay = wait / 2 + random(wait / 2 + 1);
+        _nextAttempt = millis() + _lastDelay;
+    }
+
+    /**
+     * Start a connection attempt. It runs on in attempt() over the
+     * following passes, none of which waits for the broker.
+     */
+    void connect() {
+        _attempts++;
+        setState(MQTT_LINK_CONNECTING);
+        _socket.open(MY_MQTT_BROKER, MY_MQTT_PORT);
+    }
+
+    /**
+     * Follow the attempt: once TCP is up, PubSubClient sends CONNECT, which
+     * returns at once with the socket's CONNACK. The link is up when the
+     * broker's CONNACK accepted it. MyMqttSocket times out both steps.
+     */
+    void attempt() {
+        if (_socket.getState() == MQTT_SOCKET_OPENING) return;
+        if (_socket.getState() == MQTT_SOCKET_OPEN && !_client.connected() &&
+            !_client.connect(_clientId, MY_MQTT_USERNAME, MY_MQTT_PASSWORD,
+                             topic(MQTT_TOPIC_LWT), QOS, RETAIN, "offline")) {
+            _socket.stop();
+        }
+        if (_socket.getState() == MQTT_SOCKET_OPEN && !_socket.isAccepted()) return;
 
-        _deviceNameTopic = topicBase + "DeviceName";
-        _devicePlaceTopic = topicBase + "DevicePlace";
-        _wifiSsidTopic = topicBase + "WiFi_SSID";
-        _wifiIpTopic = topicBase + "WiFi_IP";
-        _timestampTopic = topicBase + "TimeStamp";
-        _debugTopic = topicBase + "Debug_Info";
+        _attemptTime = millis() - _stateSince;
+        if (_attemptTime > _maxAttemptTime) _maxAttemptTime = _attemptTime;
+        if (_socket.isAccepted()) {
+            Serial.printf("[MQTT] Connected to %s:%d after %u attempt(s)\n",
+                          MY_MQTT_BROKER, MY_MQTT_PORT, _failures + 1);
+            _connects++;
+            _failures = 0;
+            setState(MQTT_LINK_UP);
+            _client.subscribe(topic(MQTT_TOPIC_COMMAND), QOS);
+            sendInitMessages();
+            for (MyDeadband& field : _fields) field.reset();
+            return;
+        }
+
+        _lastError = _socket.getError() ? _socket.getError() : _client.state();
+        _client.disconnect();  // forget the socket's CONNACK
+        if (_failures < UINT8_MAX) _failures++;
+        setState(MQTT_LINK_WAITING);
+        backoff();
+        Serial.printf("[MQTT] Connect failed, rc=%d, retrying in %u ms\n",
+                      _lastError, _lastDelay);
+    }
+
+    /**
+     * Commands MyMqtt handles itself.
+     * @return false if the command is not one of them
+     */
+    bool runCommand(MyMqttCommand& command) {
+        const MqttToken& name = command.getName();
+        MqttToken word;
+        long value, jump;
 
-        _bmeTemperatureTopic = topicBase + "BME280_Temperature_°C";
-        _bmeHumidityTopic = topicBase + "BME280_Humidity_%";
-        _bmePressureTopic = topicBase + "BME280_Pressure_hPa";
-        _bmeAltitudeTopic = topicBase + "BME280_Altitude_m";
+        if (name.equals("interval")) {
+            if (!command.number(value, MQTT_INTERVAL_MIN, MQTT_INTERVAL_MAX)) {
+                command.fail("usage: interval <ms>, 100 ms to 1 h");
+                return true;
+            }
+            _interval = value;
+            command.ok();
+            command.reply(" %lu ms", _interval);
+        } else if (name.equals("mode")) {
+            command.next(word);
+            for (MqttPublishMode m : {MQTT_PUBLISH_FIELDS, MQTT_PUBLISH_BATCH, MQTT_PUBLISH_CBOR}) {
+                if (!word.equals(getModeName(m))) continue;
+                _mode = m;
+                command.ok();
+                command.reply(" %s", getModeName(m));
+                return true;
+            }
+            command.fail("usage: mode <fields|batch|cbor>");
+        } else if (name.equals("deadband")) {
+            command.next(word);
+            for (MyDeadband& field : _fields) {
+                if (!word.equals(field.getName())) continue;
+                if (!command.number(value, 0, INT32_MAX) ||
+                    !command.number(jump, 0, INT32_MAX)) {
+                    break;
+                }
+                field.setDeadband(value);
+                field.setJump(jump);
+                command.ok();
+                command.reply(" %s %ld %ld", field.getName(), value, jump);
+                return true;
+            }
+            command.fail("usage: deadband <field> <deadband> <jump>");
+        } else if (name.equals("queue")) {
+            command.next(word);
+            value = _queue.getSpan();
+            for (QueuePolicy p : {QUEUE_DROP_OLDEST, QUEUE_DOWNSAMPLE}) {
+                if (!word.equals(MyMqttQueue::getPolicyName(p))) continue;
+                if (!command.atEnd() &&
+                    !command.number(value, MQTT_QUEUE_SPAN_MIN, MQTT_QUEUE_SPAN_MAX)) {
+                    break;
+                }
+                _queue.setPolicy(p, value);
+                command.ok();
+                command.reply(" %s %ld", MyMqttQueue::getPolicyName(p), value);
+                return true;
+            }
+            command.fail("usage: queue <drop-oldest|downsample> [<span s>]");
+        } else if (name.equals("dump")) {
+            // Everyone adds their counters: MyMqtt first, then the handler
+            command.ok();
+            command.reply(" uptime=%lu heap=%u block=%u mqtt.messages=%u "
+                          "mqtt.bytes=%u mqtt.samples=%u mqtt.us=%u "
+                          "mqtt.suppressed=%u mqtt.drops=%u mqtt.interval=%lu",
+                          millis() / 1000, ESP.getFreeHeap(),
+                          ESP.getMaxFreeBlockSize(), _stats.messages,
+                          _stats.bytes, _stats.samples,
+                          _stats.samples ? _stats.sampleTime / _stats.samples : 0,
+                          _stats.suppressed, _drops, _interval);
+            if (_commandHandler) _commandHandler(command);
+        } else {
+            return false;
+        }
+        return true;
+    }
 
-        _deviceName = deviceName;
-        _devicePlace = devicePlace;
+   public:
+    /**
+     * @param log sensor log the offline queue spills to
+     * @param topicBase prefix of all topics, ending with '/'
+     */
+    MyMqtt(MySensorLog& log, const char* deviceName, const char* devicePlace,
+           const char* topicBase)
+        : _queue(log) {
+        snprintf(_clientId, sizeof(_clientId), "ESP-%u-%lx", ESP.getChipId(),
+                 random(0xffff));
+        strlcpy(_deviceName, deviceName, sizeof(_deviceName));
+        strlcpy(_devicePlace, devicePlace, sizeof(_devicePlace));
+        strlcpy(_topic, topicBase, sizeof(_topic));
+        _baseLength = strlen(_topic);
     }
 
     /**
      * Initialize MQTT client and connect to broker.
      */
     void begin() {
+        _client.setSocketTimeout(MQTT_READ_TIMEOUT);
+        _client.setBufferSize(MQTT_BUFFER_SIZE);
+        _queue.begin();
         _client.setServer(MY_MQTT_BROKER, MY_MQTT_PORT);
         _client.setCallback(
             [this](const char* topic, const byte* payload, unsigned int length) {
-                if (strcmp(topic, _allTopics.c_str()) == 0) {
-                    Serial.print("Message arrived [");
-                    Serial.print(topic);
-                    Serial.print("] ");
-                    for (unsigned int i = 0; i < length; i++) {
-                        Serial.print((char)payload[i]);
-                    }
-                    Serial.println();
+                if (strcmp(topic, this->topic(MQTT_TOPIC_COMMAND)) == 0) {
+                    handleCommand((const char*)payload, length);
                 }
             });
     }
 
     /**
-     * Maintain MQTT connection and process incoming messages.
+     * Maintain MQTT connection and process incoming messages. Never waits
+     * for the broker: attempts run asynchronously, one at a time, and a new
+     * one starts only when the backoff has expired.
      */
     void loop() {
-        // Ensure the client is connected
-        if (!_client.connected()) {
-            connect();
+        _socket.poll();
+        if (_state == MQTT_LINK_CONNECTING) {
+            attempt();
+            return;
+        }
+        if (_client.connected()) {
+            // PubSubClient takes one packet per call
+            do {
+                _client.loop();
+            } while (_client.connected() && _socket.available());
+            replay();
+            return;
         }
 
-        // Maintain MQTT connection
-        _client.loop();
+        if (_state == MQTT_LINK_UP) {
+            _drops++;
+            _lastError = _socket.getError() ? _socket.getError() : _client.state();
+            Serial.printf("[MQTT] Connection lost, rc=%d\n", _lastError);
+            setState(MQTT_LINK_WAITING);
+            _nextAttempt = millis();  // first retry right away
+        }
+        if ((long)(millis() - _nextAttempt) < 0) return;
+        connect();
+    }
+
+    bool isConnected() const { return _state == MQTT_LINK_UP; }
+
+    /**
+     * Set the handler for commands of other modules (e.g. sampling profile,
+     * page durations). It also sees "dump" to add its counters.
+     */
+    void setCommandHandler(MqttCommandHandler handler) {
+        _commandHandler = handler;
+    }
+
+    /**
+     * Run a command received on the command topic, or typed on the Serial
+     * Monitor, and acknowledge it on the CommandAck topic:
+     * "ok <command> [details]" or "error <command>: <message>".
+     * Commands: interval <ms>, mode <fields|batch|cbor>,
+     * deadband <field> <deadband> <jump>,
+     * queue <drop-oldest|downsample> [<span s>], dump, and whatever the
+     * command handler knows.
+     */
+    void handleCommand(const char* payload, size_t length) {
+        // The payload may live in PubSubClient's buffer, which the
+        // acknowledgement overwrites: parse everything before publishing.
+        MyMqttCommand command(payload, length, _payload, sizeof(_payload));
+        _commands++;
+        if (!command.getName().length) {
+            command.fail("empty command");
+        } else if (!runCommand(command) &&
+                   (!_commandHandler || !_commandHandler(command))) {
+            command.fail("unknown command");
+        } else if (!command.hasReply()) {
+            command.ok();
+        }
+
+        Serial.printf("[MQTT] Command: %s\n", command.getReply());
+        if (isConnected()) {
+            publish(topic(MQTT_TOPIC_COMMAND_ACK),
+                    (const uint8_t*)command.getReply(),
+                    strlen(command.getReply()), false);
+        }
+    }
+
+    /**
+     * Time between published samples in ms, set by the interval command.
+     */
+    unsigned long getInterval() const { return _interval; }
+
+    /**
+     * Queue a sample for later if there is no broker connection right now.
+     * Call for every new sample, also while Wi-Fi is down, after
+     * MySensorLog::add() got it.
+     */
+    void track(const SensorSnapshot& snapshot) {
+        _queue.track(snapshot, isConnected());
     }
 
     /**
-     * Publish BME280 sensor data to MQTT topics.
+     * True while samples from an outage are waiting to be replayed.
+     */
+    bool hasBacklog() const { return _queue.hasBacklog(); }
+
+    /**
+     * Overflow policy of the offline queue, see MyMqttQueue.
      */
-    void publishSensorData(float temperature, float humidity, float pressure, float altitude) {
-        _client.publish(_bmeTemperatureTopic.c_str(), String(temperature).c_str(), RETAIN);
-        _client.publish(_bmeHumidityTopic.c_str(), String(humidity).c_str(), RETAIN);
-        _client.publish(_bmePressureTopic.c_str(), String(pressure).c_str(), RETAIN);
-        _client.publish(_bmeAltitudeTopic.c_str(), String(altitude).c_str(), RETAIN);
+    void setQueuePolicy(QueuePolicy policy, uint32_t span = MQTT_QUEUE_SPAN) {
+        _queue.setPolicy(policy, span);
+    }
+
+    /**
+     * Print connection statistics to the Serial Monitor.
+     */
+    void printStats() {
+        unsigned long since = (millis() - _stateSince) / 1000;
+        Serial.printf("MQTT: %s:%d\n", MY_MQTT_BROKER, MY_MQTT_PORT);
+        if (_state == MQTT_LINK_UP) {
+            Serial.printf("Connected for %lu s\n", since);
+        } else if (_state == MQTT_LINK_CONNECTING) {
+            Serial.printf("Connecting for %lu ms\n", millis() - _stateSince);
+        } else {
+            long wait = (long)(_nextAttempt - millis());
+            Serial.printf("Disconnected for %lu s, %u failed attempt(s) in a "
+                          "row, next in %ld ms\n",
+                          since, _failures, wait > 0 ? wait : 0);
+        }
+        Serial.printf("Attempts: %u, connects: %u, drops: %u, last rc: %d\n",
+                      _attempts, _connects, _drops, _lastError);
+        Serial.printf("Attempt time: last %u ms, max. %u ms (cap %u ms + %u ms)\n",
+                      _attemptTime, _maxAttemptTime, MQTT_CONNECT_TIMEOUT,
+                      MQTT_CONNACK_TIMEOUT);
+        Serial.printf("Publish mode: %s, %u messages, %u B in total\n",
+                      getModeName(_mode), _stats.messages, _stats.bytes);
+        if (_stats.samples) {
+            Serial.printf("Per sample: %u messages, %u B, %u µs (%u samples)\n",
+                          _stats.sampleMessages / _stats.samples,
+                          _stats.sampleBytes / _stats.samples,
+                          _stats.sampleTime / _stats.samples, _stats.samples);
+        }
+        _queue.printStats();
+        Serial.printf("Replay: max. %u samples per %u ms\n", MQTT_REPLAY_BATCH,
+                      MQTT_REPLAY_INTERVAL);
+        Serial.printf("Commands: %u on %s, publish interval %lu ms\n",
+                      _commands, topic(MQTT_TOPIC_COMMAND), _interval);
+        Serial.printf("Deadbands: %u messages suppressed, %u jumps, %u "
+                      "heartbeats (every %u s)\n",
+                      _stats.suppressed, _stats.jumps, _stats.heartbeats,
+                      DEADBAND_HEARTBEAT_INTERVAL / 1000);
+        Serial.println("Field              deadband    jump      sent  suppressed");
+        for (const MyDeadband& field : _fields) {
+            Serial.printf("%-18s %8d %7d %9u %11u\n", field.getName(),
+                          field.getDeadband(), field.getJump(),
+                          field.getSent(), field.getSuppressed());
+        }
+        Serial.println();
+    }
+
+    /**
+     * Publish BME280 sensor data to MQTT topics: each field that its
+     * deadband lets through, or all of them if `force` is set.
+     * @return true if at least one field was published
+     */
+    bool publishSensorData(const SensorSnapshot& snapshot, bool force = false) {
+        return publishFields(snapshot, millis(), force);
+    }
+
+    /**
+     * Publish a sample as one telemetry document, see publishDocument().
+     */
+    void publishTelemetry(const SensorSnapshot& snapshot,
+                          TelemetryEncoding encoding = TELEMETRY_JSON,
+                          bool force = false) {
+        publishDocument(snapshot, encoding, millis(), force);
+    }
+
+    /**
+     * Publish a sample in the configured mode. In fields mode the time stamp
+     * goes to its own topic whenever a field was published, the telemetry
+     * document carries the sample's epoch as "t".
+     */
+    void publishSample(const SensorSnapshot& snapshot, const char* timeStamp) {
+        publishSample(snapshot, timeStamp, millis());
+    }
+
+    void setMode(MqttPublishMode mode) { _mode = mode; }
+
+    MqttPublishMode getMode() const { return _mode; }
+
+    static const char* getModeName(MqttPublishMode mode) {
+        switch (mode) {
+            case MQTT_PUBLISH_BATCH:
+                return "batch";
+            case MQTT_PUBLISH_CBOR:
+                return "cbor";
+            default:
+                return "fields";
+        }
+    }
+
+    static TelemetryEncoding getEncoding(MqttPublishMode mode) {
+        return mode == MQTT_PUBLISH_CBOR ? TELEMETRY_CBOR : TELEMETRY_JSON;
+    }
+
+    /**
+     * Publish the same sample `iterations` times in each mode, bypassing the
+     * deadbands, and print messages, MQTT bytes and publish time per sample.
+     * Needs a broker connection; the messages are real (retained) publishes.
+     */
+    void printBenchmark(const SensorSnapshot& snapshot, const char* timeStamp,
+                        uint8_t iterations = 10) {
+        if (!isConnected() || !snapshot.valid || !iterations) {
+            Serial.println("[MQTT] Benchmark needs a broker and a valid sample");
+            return;
+        }
+        Serial.println("Mode      messages   bytes   µs/sample");
+        for (MqttPublishMode m : {MQTT_PUBLISH_FIELDS, MQTT_PUBLISH_BATCH, MQTT_PUBLISH_CBOR}) {
+            uint32_t messages = _stats.messages;
+            uint32_t bytes = _stats.bytes;
+            uint32_t start = micros();
+            for (uint8_t i = 0; i < iterations; i++) {
+                if (m != MQTT_PUBLISH_FIELDS) {
+                    publishTelemetry(snapshot, getEncoding(m), true);
+                } else {
+                    publishSensorData(snapshot, true);
+                    publishTimeStamp(timeStamp);
+                }
+                _client.loop();
+            }
+            uint32_t time = (micros() - start) / iterations;
+            Serial.printf("%-8s %9u %7u %11u\n", getModeName(m),
+                          (_stats.messages - messages) / iterations,
+                          (_stats.bytes - bytes) / iterations, time);
+        }
+        Serial.println();
+    }
+
+    /**
+     * Run `hours` of simulated one-second samples through the publish path
+     * of each mode, with a drifting temperature so deadbands, jumps and
+     * heartbeats all trigger. The messages go through a second PubSubClient
+     * on a MyMqttLoopback, so only the socket write is skipped and the
+     * broker connection is left alone. Prints free heap and the largest
+     * free block before, at their lowest and after, and PASS if the largest
+     * block stayed within MQTT_HEAP_TEST_SLACK of where it started in every
+     * mode and the client wrote exactly the bytes counted. Statistics and
+     * deadband state are restored afterwards. Takes a few seconds per
+     * simulated day.
+     * @return true if the test passed
+     */
+    bool printHeapTest(const SensorSnapshot& snapshot, uint8_t hours = 24) {
+        MyMqttLoopback loopback;
+        PubSubClient client(loopback);
+        client.setBufferSize(MQTT_BUFFER_SIZE);
+        if (!client.connect(_clientId)) {
+            Serial.println("[MQTT] Heap test: loopback connect failed");
+            return false;
+        }
+
+        MqttPublishStats stats = _stats;
+        bool flat = true;
+        bool counted = true;
+        std::array<MyDeadband, MQTT_FIELD_COUNT> fields = _fields;
+        SensorSnapshot s = snapshot;
+        s.valid = true;
+        _publisher = &client;
+
+        Serial.printf("Heap test, %u simulated hours per mode:\n", hours);
+        Serial.println("Mode      messages   heap before / min / after    max. block before / min / after");
+        for (MqttPublishMode m : {MQTT_PUBLISH_FIELDS, MQTT_PUBLISH_BATCH, MQTT_PUBLISH_CBOR}) {
+            MqttPublishMode mode = _mode;
+            _mode = m;
+            for (MyDeadband& field : _fields) field.reset();
+            uint32_t messages = _stats.messages;
+            uint32_t bytes = _stats.bytes;
+            uint32_t written = loopback.getBytes();
+            uint32_t heap = ESP.getFreeHeap();
+            uint32_t block = ESP.getMaxFreeBlockSize();
+            uint32_t minHeap = heap;
+            uint32_t minBlock = block;
+
+            for (uint32_t second = 0; second < hours * 3600UL; second++) {
+                s.sequence++;
+                s.epoch = snapshot.epoch + second;
+                // Up and down by 1.8 °C every two hours, a jump now and then
+                uint32_t ramp = second % 7200 < 3600 ? second % 3600 : 3600 - second % 3600;
+                s.temperatureC = snapshot.temperatureC + ramp / 20;
+                if (second % 10000 == 5000) s.temperatureC += 150;
+                publishSample(s, "simulated", second * 1000UL);
+
+                if (second % 100 == 0) {
+                    minHeap = min(minHeap, ESP.getFreeHeap());
+                    minBlock = min(minBlock, (uint32_t)ESP.getMaxFreeBlockSize());
+                    yield();
+                }
+            }
+            Serial.printf("%-8s %9u   %6u / %6u / %6u      %6u / %6u / %6u\n",
+                          getModeName(m), _stats.messages - messages, heap,
+                          minHeap, ESP.getFreeHeap(), block, minBlock,
+                          ESP.getMaxFreeBlockSize());
+            flat &= minBlock + MQTT_HEAP_TEST_SLACK >= block;
+            counted &= loopback.getBytes() - written == _stats.bytes - bytes;
+            _mode = mode;
+        }
+        if (!flat) {
+            Serial.println("Heap test: FAIL, the largest free block shrank\n");
+        } else if (!counted) {
+            Serial.println("Heap test: FAIL, the client wrote other bytes than counted\n");
+        } else {
+            Serial.println("Heap test: PASS\n");
+        }
+
+        _publisher = &_client;
+        client.disconnect();
+        _fields = fields;
+        _stats = stats;
+        return flat && counted;
     }
 
     /**
      * Publish current time to MQTT topic.
      */
-    void publishTimeStamp(String timeStamp) {
-        _client.publish(_timestampTopic.c_str(), timeStamp.c_str(), RETAIN);
+    void publishTimeStamp(const char* timeStamp) {
+        publish(topic(MQTT_TOPIC_TIMESTAMP), timeStamp);
     }
 };
 
@@ -0,0 +1,133 @@
+/**
+ * MyMqttCommand.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * A command received on the MQTT command topic, e.g. "deadband temperature
+ * 20 200". Words are read straight from the received payload, which is not
+ * NUL-terminated and not copied: a token is a pointer and a length into it.
+ * The acknowledgement is built into a buffer of the caller's while parsing.
+ */
+
+#ifndef _MY_MQTT_COMMAND_H_
+#define _MY_MQTT_COMMAND_H_
+
+#include <Arduino.h>
+
+/**
+ * A word of the payload.
+ */
+struct MqttToken {
+    const char* text = nullptr;
+    uint8_t length = 0;
+
+    bool equals(const char* word) const {
+        return strncmp(text, word, length) == 0 && word[length] == '\0';
+    }
+};
+
+class MyMqttCommand {
+   private:
+    const char* _pos;
+    const char* _end;
+    MqttToken _name;
+
+    char* _reply;
+    size_t _replySize;
+    size_t _replyLength = 0;
+    bool _replied = false;
+
+    void skipSpaces() {
+        while (_pos < _end && isspace((unsigned char)*_pos)) _pos++;
+    }
+
+   public:
+    MyMqttCommand(const char* payload, size_t length, char* reply,
+                  size_t replySize)
+        : _pos(payload), _end(payload + length), _reply(reply),
+          _replySize(replySize) {
+        _reply[0] = '\0';
+        next(_name);
+    }
+
+    /**
+     * The first word.
+     */
+    const MqttToken& getName() const { return _name; }
+
+    /**
+     * Read the next word.
+     * @return false at the end of the payload
+     */
+    bool next(MqttToken& token) {
+        skipSpaces();
+        const char* start = _pos;
+        while (_pos < _end && !isspace((unsigned char)*_pos) && _pos - start < UINT8_MAX) _pos++;
+        token.text = start;
+        token.length = _pos - start;
+        return token.length;
+    }
+
+    /**
+     * Read the next word as decimal integer within [min, max].
+     * @return false if it is missing, not a number or out of range
+     */
+    bool number(long& value, long min, long max) {
+        MqttToken token;
+        if (!next(token)) return false;
+        bool negative = *token.text == '-';
+        uint8_t i = negative ? 1 : 0;
+        if (i == token.length) return false;
+        long n = 0;
+        for (; i < token.length; i++) {
+            if (!isdigit((unsigned char)token.text[i]) || n > 100000000L) return false;
+            n = n * 10 + token.text[i] - '0';
+        }
+        value = negative ? -n : n;
+        return value >= min && value <= max;
+    }
+
+    /**
+     * @return true if only spaces are left
+     */
+    bool atEnd() {
+        skipSpaces();
+        return _pos == _end;
+    }
+
+    /**
+     * Append to the acknowledgement, printf style.
+     */
+    void reply(const char* format, ...) {
+        if (_replyLength >= _replySize) return;
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(_reply + _replyLength, _replySize - _replyLength,
+                          format, args);
+        va_end(args);
+        if (n > 0) _replyLength = min(_replyLength + n, _replySize - 1);
+        _replied = true;
+    }
+
+    /**
+     * Acknowledge failure: "error <command>: <message>".
+     */
+    void fail(const char* message) {
+        _replyLength = 0;
+        reply("error %.*s: %s", _name.length, _name.text, message);
+    }
+
+    /**
+     * Start a positive acknowledgement: "ok <command>", details are
+     * appended with reply().
+     */
+    void ok() {
+        _replyLength = 0;
+        reply("ok %.*s", _name.length, _name.text);
+    }
+
+    bool hasReply() const { return _replied; }
+
+    const char* getReply() const { return _reply; }
+};
+
+#endif  // _MY_MQTT_COMMAND_H_
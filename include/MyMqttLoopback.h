@@ -0,0 +1,98 @@
+/**
+ * MyMqttLoopback.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * A Client with no network behind it that stands in for the broker: it takes
+ * every packet PubSubClient writes, answers CONNECT with an accepted CONNACK
+ * and PINGREQ with PINGRESP, and counts the bytes. A PubSubClient on it runs
+ * its whole publish path, only the socket write is left out. Used by the
+ * heap test of MyMqtt.
+ */
+
+#ifndef _MY_MQTT_LOOPBACK_H_
+#define _MY_MQTT_LOOPBACK_H_
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+class MyMqttLoopback : public Client {
+   private:
+    bool _open = false;
+    uint8_t _reply[4];  // CONNACK or PINGRESP
+    uint8_t _replyLength = 0;
+    uint8_t _replyPos = 0;
+    uint32_t _bytes = 0;
+    uint32_t _packets = 0;
+
+    void reply(const uint8_t* packet, uint8_t length) {
+        memcpy(_reply, packet, length);
+        _replyLength = length;
+        _replyPos = 0;
+    }
+
+   public:
+    int connect(IPAddress ip, uint16_t port) override {
+        _open = true;
+        return 1;
+    }
+
+    int connect(const char* host, uint16_t port) override {
+        _open = true;
+        return 1;
+    }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+
+    /**
+     * PubSubClient writes each packet with a single write(), so the first
+     * byte is always a fixed header.
+     */
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (!_open || !size) return 0;
+        static const uint8_t connack[] = {0x20, 0x02, 0x00, 0x00};
+        static const uint8_t pingresp[] = {0xD0, 0x00};
+        switch (buffer[0] >> 4) {
+            case 1:  // CONNECT
+                reply(connack, sizeof(connack));
+                break;
+            case 12:  // PINGREQ
+                reply(pingresp, sizeof(pingresp));
+                break;
+        }
+        _bytes += size;
+        _packets++;
+        return size;
+    }
+
+    int available() override { return _replyLength - _replyPos; }
+
+    int read() override { return available() ? _reply[_replyPos++] : -1; }
+
+    int read(uint8_t* buffer, size_t size) override {
+        size_t n = 0;
+        while (n < size && available()) buffer[n++] = _reply[_replyPos++];
+        return n;
+    }
+
+    int peek() override { return available() ? _reply[_replyPos] : -1; }
+
+    bool flush(unsigned int maxWaitMs = 0) override { return true; }
+
+    bool stop(unsigned int maxWaitMs = 0) override {
+        _open = false;
+        _replyLength = _replyPos = 0;
+        return true;
+    }
+
+    uint8_t connected() override { return _open; }
+
+    operator bool() override { return _open; }
+
+    /**
+     * Bytes and packets PubSubClient wrote.
+     */
+    uint32_t getBytes() const { return _bytes; }
+    uint32_t getPackets() const { return _packets; }
+};
+
+#endif  // _MY_MQTT_LOOPBACK_H_
@@ -0,0 +1,302 @@
+/**
+ * MyMqttQueue.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Store-and-forward queue for samples taken while there is no broker
+ * connection. The newest MQTT_QUEUE_RAM of them are kept in a RAM ring, so
+ * a short outage is replayed without reading flash. When the ring is full,
+ * its oldest sample spills to the sensor log: MySensorLog already stores
+ * every sample the ring takes (one per SENSOR_LOG_INTERVAL), so spilling
+ * writes nothing, it only moves the boundary between the two tiers.
+ * Spilled samples are read back through a LogCursor, which continues at
+ * the block it stopped at.
+ *
+ * The cursor and the end of the outage are saved to MQTT_BACKLOG_FILE when
+ * an outage starts and ends and every MQTT_REPLAY_SAVE messages. After a
+ * reboot the RAM ring is gone and the whole backlog comes from the log.
+ *
+ * Spilled samples more than a span (one day by default) older than the
+ * newest spilled one are an overflow, handled by the policy: drop-oldest
+ * skips them, downsample thins them out the older they are: of those one
+ * to two spans older every second goes out, two to four spans older every
+ * fourth, and so on. Either way the newest span goes out in full.
+ *
+ * Samples come out oldest first: spilled ones, then the RAM ring.
+ */
+
+#ifndef _MY_MQTT_QUEUE_H_
+#define _MY_MQTT_QUEUE_H_
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#include "MySensorHistory.h"
+#include "MySensorLog.h"
+
+#define MQTT_QUEUE_RAM 64       // samples in RAM, 10 min at SENSOR_LOG_INTERVAL
+#define MQTT_QUEUE_SPAN 86400   // s of spilled samples replayed in full, default
+#define MQTT_QUEUE_SPAN_MIN 600 // s, limits of the queue command
+#define MQTT_QUEUE_SPAN_MAX 1209600
+#define MQTT_REPLAY_SAVE 16     // backlog messages between cursor saves
+#define MQTT_BACKLOG_FILE "/mqtt-backlog.bin"  // cursor and end, 4 x u32
+
+/**
+ * A queued sample.
+ */
+struct QueuedSample {
+    uint32_t epoch;
+    HistorySample sample;
+};
+
+enum QueuePolicy { QUEUE_DROP_OLDEST, QUEUE_DOWNSAMPLE };
+
+class MyMqttQueue {
+   private:
+    MySensorLog& _log;
+
+    QueuedSample _ram[MQTT_QUEUE_RAM];
+    uint16_t _head = 0;  // oldest sample in RAM
+    uint16_t _count = 0;
+    uint32_t _last = 0;  // epoch of the last sample the log kept
+
+    // Backlog: the samples after _cursor.epoch up to _end, 0 while the
+    // outage lasts. The spilled ones go up to _spillEnd, 0 if none.
+    bool _pending = false;
+    LogCursor _cursor = {};
+    uint32_t _end = 0;
+    uint32_t _spillEnd = 0;
+    uint32_t _kept = 0;  // epoch of the last sample downsampling kept
+
+    QueuePolicy _policy = QUEUE_DOWNSAMPLE;
+    uint32_t _span = MQTT_QUEUE_SPAN;
+
+    // What the last peek() took
+    LogCursor _next;
+    uint32_t _nextKept = 0;
+    uint16_t _taken = 0;
+    uint16_t _fromRam = 0;
+    uint32_t _skipped = 0;
+    bool _short = false;
+
+    // Statistics since boot
+    uint32_t _queued = 0;
+    uint32_t _spilled = 0;
+    uint32_t _dropped = 0;  // s of spilled samples skipped
+    uint32_t _thinned = 0;  // samples downsampling skipped
+    uint32_t _replayed = 0;
+    uint32_t _replayedFromLog = 0;
+    uint32_t _messages = 0;
+
+    void save() {
+        if (!_pending) {
+            LittleFS.remove(MQTT_BACKLOG_FILE);
+            return;
+        }
+        uint32_t cursor[4] = {_cursor.segment, _cursor.offset, _cursor.epoch, _end};
+        File file = LittleFS.open(MQTT_BACKLOG_FILE, "w");
+        if (!file) return;
+        file.write((const uint8_t*)cursor, sizeof(cursor));
+        file.close();
+    }
+
+    void load() {
+        uint32_t cursor[4] = {};
+        File file = LittleFS.open(MQTT_BACKLOG_FILE, "r");
+        if (!file) return;
+        if (file.read((uint8_t*)cursor, sizeof(cursor)) == sizeof(cursor)) {
+            _cursor = {cursor[0], cursor[1], cursor[2]};
+            _end = cursor[3];
+            _kept = _cursor.epoch;
+            _pending = true;
+            _spillEnd = UINT32_MAX;  // the RAM ring did not survive
+        }
+        file.close();
+        if (_pending) {
+            Serial.printf("[MQTT] Backlog pending since %u\n", _cursor.epoch + 1);
+        }
+    }
+
+    void push(uint32_t epoch, const HistorySample& sample) {
+        if (_count == MQTT_QUEUE_RAM) {
+            _spillEnd = _ram[_head].epoch;
+            _head = (_head + 1) % MQTT_QUEUE_RAM;
+            _count--;
+            _spilled++;
+        }
+        _ram[(_head + _count) % MQTT_QUEUE_RAM] = {epoch, sample};
+        _count++;
+        _queued++;
+    }
+
+    /**
+     * Drop-oldest: skip the spilled samples up to `to` beyond the span.
+     */
+    void drop(uint32_t to) {
+        if (_policy != QUEUE_DROP_OLDEST || to - _cursor.epoch <= _span) return;
+        _dropped += to - _cursor.epoch - _span;
+        _cursor.epoch = to - _span;
+        _kept = _cursor.epoch;
+    }
+
+    /**
+     * Downsample: seconds between replayed samples that are `age` seconds
+     * older than the newest spilled one.
+     */
+    uint32_t gap(uint32_t age) const {
+        if (_policy != QUEUE_DOWNSAMPLE || age < _span) return 0;
+        uint32_t stride = 1;
+        while (stride * _span <= age) stride <<= 1;
+        return stride * SENSOR_LOG_INTERVAL;
+    }
+
+   public:
+    MyMqttQueue(MySensorLog& log) : _log(log) {}
+
+    /**
+     * Pick up the backlog of an outage before the reboot.
+     */
+    void begin() { load(); }
+
+    /**
+     * Follow the samples: the first one taken while `online` is false
+     * starts an outage, the first one taken online again ends it. Offline
+     * samples go into the RAM ring, the same ones the log keeps. Call for
+     * every new sample, after MySensorLog::add().
+     */
+    void track(const SensorSnapshot& snapshot, bool online) {
+        uint32_t epoch = snapshot.epoch;
+        if (!snapshot.valid || epoch < SENSOR_LOG_MIN_EPOCH) return;
+        if (!online) {
+            if (!_pending) {
+                _pending = true;
+                _cursor = _log.recent(epoch - 1);
+                _kept = _cursor.epoch;
+                save();
+            }
+            _end = 0;
+        } else if (_pending && !_end) {
+            _end = epoch - 1;
+            save();
+        }
+
+        if (_last && epoch - _last < SENSOR_LOG_INTERVAL) return;
+        _last = epoch;
+        if (!online) push(epoch, MySensorHistory::encode(snapshot));
+    }
+
+    /**
+     * True while samples from an outage are waiting to be replayed.
+     */
+    bool hasBacklog() const { return _pending; }
+
+    /**
+     * True once the outage is over and its samples can go out.
+     */
+    bool isReady() const { return _pending && _end; }
+
+    /**
+     * Copy up to `count` of the oldest samples, leaving them queued until
+     * pop(). Reads at most the log blocks these samples are in.
+     */
+    uint16_t peek(QueuedSample* samples, uint16_t count) {
+        _next = _cursor;
+        _taken = _fromRam = 0;
+        _skipped = 0;
+        if (!isReady()) return 0;
+
+        uint32_t to = min(_spillEnd, _end);
+        if (_count && _ram[_head].epoch - 1 < to) to = _ram[_head].epoch - 1;
+        if (_spillEnd && to > _cursor.epoch) {
+            drop(to);
+            uint32_t kept = _kept;
+            uint16_t n = 0;
+            _next = _cursor;
+            _taken = _log.read(_next, to,
+                               [&](uint32_t epoch, const HistorySample& s) {
+                                   if (epoch - kept < gap(to - epoch)) {
+                                       _skipped++;
+                                       return false;
+                                   }
+                                   kept = epoch;
+                                   samples[n++] = {epoch, s};
+                                   return true;
+                               },
+                               count);
+            // Nothing left in the log up to `to`
+            if (_taken < count) _next.epoch = to;
+        }
+
+        while (_taken < count && _fromRam < _count) {
+            const QueuedSample& s = _ram[(_head + _fromRam) % MQTT_QUEUE_RAM];
+            if (s.epoch > _end) break;
+            samples[_taken++] = s;
+            _fromRam++;
+        }
+        _short = _taken < count;
+        _nextKept = _taken ? samples[_taken - 1].epoch : _kept;
+        _next.epoch = max(_next.epoch, _nextKept);
+        return _taken;
+    }
+
+    /**
+     * Remove the samples of the last peek(). When it came up short, the
+     * backlog is done.
+     */
+    void pop() {
+        _cursor = _next;
+        _kept = _nextKept;
+        _head = (_head + _fromRam) % MQTT_QUEUE_RAM;
+        _count -= _fromRam;
+        _replayedFromLog += _taken - _fromRam;
+        _replayed += _taken;
+        _thinned += _skipped;
+        if (_taken) _messages++;
+        if (!_short) {
+            if (_messages % MQTT_REPLAY_SAVE == 0) save();
+            return;
+        }
+        Serial.printf("[MQTT] Backlog sent, %u samples\n", _replayed);
+        _pending = false;
+        _end = 0;
+        _spillEnd = 0;
+        save();
+    }
+
+    void setPolicy(QueuePolicy policy, uint32_t span) {
+        _policy = policy;
+        _span = span;
+    }
+
+    QueuePolicy getPolicy() const { return _policy; }
+
+    uint32_t getSpan() const { return _span; }
+
+    static const char* getPolicyName(QueuePolicy policy) {
+        return policy == QUEUE_DROP_OLDEST ? "drop-oldest" : "downsample";
+    }
+
+    uint32_t getReplayed() const { return _replayed; }
+
+    /**
+     * Print queue contents and statistics to the Serial Monitor.
+     */
+    void printStats() {
+        Serial.printf("Queue: %u of %u samples in RAM, %u queued, %u "
+                      "spilled to the log since boot\n",
+                      _count, MQTT_QUEUE_RAM, _queued, _spilled);
+        Serial.printf("Overflow: %s beyond %u s, %u s dropped, %u samples "
+                      "thinned\n",
+                      getPolicyName(_policy), _span, _dropped, _thinned);
+        Serial.printf("Backlog: %u samples replayed, %u of them from the "
+                      "log\n",
+                      _replayed, _replayedFromLog);
+        if (_pending && _end) {
+            Serial.printf("Pending: %u to %u, log at %u:%u\n", _cursor.epoch + 1,
+                          _end, _cursor.segment, _cursor.offset);
+        } else if (_pending) {
+            Serial.printf("Pending: since %u, still offline\n", _cursor.epoch + 1);
+        }
+    }
+};
+
+#endif  // _MY_MQTT_QUEUE_H_
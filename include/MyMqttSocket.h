@@ -0,0 +1,227 @@
+/**
+ * MyMqttSocket.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * The TCP connection of MyMqtt: a Client for PubSubClient on top of an
+ * AsyncClient, so that neither the connect nor the wait for the broker
+ * blocks the loop. open() starts DNS and the TCP connect and returns at
+ * once, poll() gives up on a connection that takes too long.
+ *
+ * PubSubClient::connect() writes CONNECT and then spins until it can read
+ * a CONNACK, while an AsyncClient only receives between loop() passes. So
+ * the socket answers CONNECT itself with an accepted CONNACK and checks
+ * the broker's one when it arrives, taking it out of the stream: a refusal,
+ * or no CONNACK within MQTT_CONNACK_TIMEOUT, closes the connection.
+ * isAccepted() tells whether the broker's CONNACK is in. Incoming packets
+ * are handed to PubSubClient only once complete, so it never waits for the
+ * rest of one either.
+ */
+
+#ifndef _MY_MQTT_SOCKET_H_
+#define _MY_MQTT_SOCKET_H_
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESPAsyncTCP.h>
+#include <PubSubClient.h>
+
+#define MQTT_CONNECT_TIMEOUT 5000  // ms for DNS and TCP connect
+#define MQTT_CONNACK_TIMEOUT 5000  // ms for the broker's CONNACK
+#define MQTT_SOCKET_BUFFER 1024    // B of received packets, 2 x PubSubClient buffer
+
+enum MqttSocketState {
+    MQTT_SOCKET_CLOSED,
+    MQTT_SOCKET_OPENING,  // DNS and TCP connect under way
+    MQTT_SOCKET_OPEN,
+};
+
+class MyMqttSocket : public Client {
+   private:
+    AsyncClient _tcp;
+    MqttSocketState _state = MQTT_SOCKET_CLOSED;
+    unsigned long _since = 0;  // millis() of open() or of CONNECT
+    int _error = 0;            // PubSubClient state() for the last failure
+
+    // CONNACK: given to PubSubClient, expected from the broker
+    bool _connectSent = false;
+    bool _accepted = false;
+    uint8_t _connack[4];
+    uint8_t _connackLength = 0;
+
+    // Received bytes, the first _ready of them whole packets
+    uint8_t _rx[MQTT_SOCKET_BUFFER];
+    size_t _rxLength = 0;
+    size_t _ready = 0;
+    size_t _pos = 0;  // read position
+
+    void fail(int error) {
+        _error = error;
+        stop();
+    }
+
+    /**
+     * Length of the packet at the start of `data`, 0 if incomplete.
+     */
+    static size_t packetLength(const uint8_t* data, size_t length) {
+        size_t pos = 1;
+        size_t remaining = 0;
+        uint8_t shift = 0;
+        do {
+            if (pos >= length || shift > 21) return 0;
+            remaining |= (size_t)(data[pos] & 0x7F) << shift;
+            shift += 7;
+        } while (data[pos++] & 0x80);
+        return pos + remaining <= length ? pos + remaining : 0;
+    }
+
+    void receive(const uint8_t* data, size_t length) {
+        // The broker's CONNACK: 0x20, 2, session present, return code
+        while (_connectSent && !_accepted && length) {
+            _connack[_connackLength++] = *data++;
+            length--;
+            if (_connackLength < sizeof(_connack)) continue;
+            if (_connack[0] != 0x20 || _connack[3] != 0) {
+                fail(_connack[0] == 0x20 ? _connack[3] : MQTT_CONNECT_FAILED);
+                return;
+            }
+            _accepted = true;
+        }
+        if (!length || _state != MQTT_SOCKET_OPEN) return;
+
+        memmove(_rx, _rx + _pos, _rxLength - _pos);
+        _rxLength -= _pos;
+        _ready -= _pos;
+        _pos = 0;
+        if (length > sizeof(_rx) - _rxLength) {
+            Serial.println("[MQTT] Receive buffer full, closing");
+            fail(MQTT_CONNECTION_LOST);
+            return;
+        }
+        memcpy(_rx + _rxLength, data, length);
+        _rxLength += length;
+        size_t n;
+        while ((n = packetLength(_rx + _ready, _rxLength - _ready))) _ready += n;
+    }
+
+   public:
+    MyMqttSocket() {
+        _tcp.onConnect([this](void*, AsyncClient*) {
+            _state = MQTT_SOCKET_OPEN;
+        });
+        _tcp.onData([this](void*, AsyncClient*, void* data, size_t length) {
+            receive((const uint8_t*)data, length);
+        });
+        _tcp.onError([this](void*, AsyncClient*, int8_t error) {
+            if (_state == MQTT_SOCKET_OPENING) _error = MQTT_CONNECT_FAILED;
+        });
+        _tcp.onDisconnect([this](void*, AsyncClient*) {
+            if (_state == MQTT_SOCKET_OPEN && !_error) _error = MQTT_CONNECTION_LOST;
+            _state = MQTT_SOCKET_CLOSED;
+        });
+    }
+
+    MyMqttSocket(const MyMqttSocket&) = delete;  // the callbacks hold `this`
+    MyMqttSocket& operator=(const MyMqttSocket&) = delete;
+
+    /**
+     * Start connecting. Check getState() for the result.
+     * @return false if the connect could not even be started
+     */
+    bool open(const char* host, uint16_t port) {
+        stop();
+        _error = 0;
+        _connectSent = _accepted = false;
+        _connackLength = 0;
+        _rxLength = _ready = _pos = 0;
+        _since = millis();
+        _state = MQTT_SOCKET_OPENING;
+        if (!_tcp.connect(host, port)) {
+            fail(MQTT_CONNECT_FAILED);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Close a connection whose connect or CONNACK timed out.
+     */
+    void poll() {
+        if (_state == MQTT_SOCKET_OPENING && millis() - _since >= MQTT_CONNECT_TIMEOUT) {
+            fail(MQTT_CONNECT_FAILED);
+        } else if (_state == MQTT_SOCKET_OPEN && _connectSent && !_accepted &&
+                   millis() - _since >= MQTT_CONNACK_TIMEOUT) {
+            fail(MQTT_CONNECTION_TIMEOUT);
+        }
+    }
+
+    MqttSocketState getState() const { return _state; }
+
+    /**
+     * True once the broker accepted the CONNECT of this connection.
+     */
+    bool isAccepted() const { return _state == MQTT_SOCKET_OPEN && _accepted; }
+
+    /**
+     * Why the last connection failed or closed, as PubSubClient state():
+     * MQTT_CONNECT_FAILED, MQTT_CONNECTION_TIMEOUT (no CONNACK),
+     * MQTT_CONNECTION_LOST, or the broker's CONNACK return code.
+     */
+    int getError() const { return _error; }
+
+    /**
+     * PubSubClient::connect() calls this: the connection has to be opened
+     * with open() beforehand.
+     */
+    int connect(IPAddress ip, uint16_t port) override { return connected(); }
+    int connect(const char* host, uint16_t port) override { return connected(); }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+
+    /**
+     * PubSubClient writes each packet with a single write(). A packet that
+     * does not fit into the TCP send buffer is not written at all, so the
+     * stream stays intact and the publish fails.
+     */
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (_state != MQTT_SOCKET_OPEN || !size || size > _tcp.space()) return 0;
+        if (!_connectSent && buffer[0] >> 4 == 1) {
+            static const uint8_t connack[] = {0x20, 0x02, 0x00, 0x00};
+            memcpy(_rx, connack, sizeof(connack));
+            _rxLength = _ready = sizeof(connack);
+            _pos = 0;
+            _connectSent = true;
+            _since = millis();
+        }
+        if (_tcp.add((const char*)buffer, size) != size) return 0;
+        _tcp.send();
+        return size;
+    }
+
+    int available() override { return _ready - _pos; }
+
+    int read() override { return available() ? _rx[_pos++] : -1; }
+
+    int read(uint8_t* buffer, size_t size) override {
+        size_t n = min(size, (size_t)available());
+        memcpy(buffer, _rx + _pos, n);
+        _pos += n;
+        return n;
+    }
+
+    int peek() override { return available() ? _rx[_pos] : -1; }
+
+    bool flush(unsigned int maxWaitMs = 0) override { return true; }
+
+    bool stop(unsigned int maxWaitMs = 0) override {
+        if (_state == MQTT_SOCKET_CLOSED) return true;
+        _state = MQTT_SOCKET_CLOSED;
+        _tcp.close(true);
+        return true;
+    }
+
+    uint8_t connected() override { return _state == MQTT_SOCKET_OPEN; }
+
+    operator bool() override { return connected(); }
+};
+
+#endif  // _MY_MQTT_SOCKET_H_
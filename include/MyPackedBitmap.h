@@ -0,0 +1,182 @@
+/**
+ * MyPackedBitmap.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Decoder for the run-length encoded bitmaps that tools/pack_logos.py
+ * generates from MyLogos.h (see MyLogosPacked.h for the assets and the
+ * script for the stream format). Bitmaps are stored in the SH1106 page
+ * layout, so runs and literals are written straight into the frame buffer
+ * row by row: no temporary copy of the image and no per-pixel drawing.
+ * Bitmaps are placed at any column, but only on a page boundary.
+ *
+ * Animations keep the first frame in full and every other frame as XOR
+ * delta, so stepping to the next frame only touches the changed bytes.
+ */
+
+#ifndef _MY_PACKED_BITMAP_H_
+#define _MY_PACKED_BITMAP_H_
+
+#include <Arduino.h>
+
+#include "MyDisplay.h"
+
+#define PACKED_RUN_MIN 2  // shortest run, stored as control byte 0x80
+
+/**
+ * A packed bitmap in PROGMEM. `offsets` is nullptr for still images;
+ * animations have one entry per stream: the first frame, the deltas to
+ * frames 1 .. frames - 1 and the delta from the last frame back to frame 0.
+ */
+struct PackedBitmap {
+    uint8_t width;   // px
+    uint8_t height;  // px
+    uint8_t pages;   // height in pages of 8 px, rounded up
+    uint8_t frames;
+    bool rle;        // false: stored unencoded, it would not get smaller
+    uint16_t size;   // bytes of data
+    const uint8_t* data;
+    const uint16_t* offsets;
+};
+
+class MyPackedBitmap {
+   private:
+    /**
+     * Write position of a stream in the frame buffer.
+     */
+    struct Target {
+        uint8_t* buffer;
+        int16_t x;
+        uint8_t page;
+        uint8_t width;
+        uint8_t pages;
+        bool xorMode;
+        uint8_t column = 0;  // within the bitmap
+        uint8_t row = 0;
+    };
+
+    /**
+     * Write `n` bytes: `literal` (PROGMEM) if set, otherwise `n` times
+     * `value`. Splits at the bitmap's row ends and clips to the screen.
+     */
+    static void emit(Target& t, const uint8_t* literal, uint8_t value,
+                     uint16_t n) {
+        while (n && t.row < t.pages) {
+            uint8_t len = n < (uint16_t)(t.width - t.column) ? n : t.width - t.column;
+            int16_t from = t.x + t.column;
+            int16_t skip = from < 0 ? -from : 0;
+            int16_t end = from + len < SCREEN_WIDTH ? from + len : SCREEN_WIDTH;
+            uint8_t line = t.page + t.row;
+
+            if (line < OLED_PAGES && from + skip < end) {
+                uint8_t* dst = t.buffer + line * SCREEN_WIDTH + from + skip;
+                uint8_t count = end - from - skip;
+                if (!t.xorMode) {
+                    if (literal) {
+                        memcpy_P(dst, literal + skip, count);
+                    } else {
+                        memset(dst, value, count);
+                    }
+                } else if (literal) {
+                    for (uint8_t i = 0; i < count; i++) {
+                        dst[i] ^= pgm_read_byte(literal + skip + i);
+                    }
+                } else if (value) {
+                    for (uint8_t i = 0; i < count; i++) dst[i] ^= value;
+                }
+            }
+
+            if (literal) literal += len;
+            n -= len;
+            t.column += len;
+            if (t.column == t.width) {
+                t.column = 0;
+                t.row++;
+            }
+        }
+    }
+
+    /**
+     * Decode stream `stream` of a bitmap into the buffer.
+     */
+    static void unpack(const PackedBitmap& bitmap, uint8_t stream,
+                       uint8_t* buffer, int16_t x, uint8_t page, bool xorMode) {
+        Target t;
+        t.buffer = buffer;
+        t.x = x;
+        t.page = page;
+        t.width = bitmap.width;
+        t.pages = bitmap.pages;
+        t.xorMode = xorMode;
+
+        const uint8_t* src = bitmap.data;
+        if (bitmap.offsets) src += pgm_read_word(bitmap.offsets + stream);
+        uint16_t left = bitmap.width * bitmap.pages;
+
+        if (!bitmap.rle) {
+            emit(t, src, 0, left);
+            return;
+        }
+        while (left) {
+            uint8_t c = pgm_read_byte(src++);
+            uint16_t n;
+            if (c & 0x80) {
+                n = (c & 0x7F) + PACKED_RUN_MIN;
+                emit(t, nullptr, pgm_read_byte(src++), n);
+            } else {
+                n = c + 1;
+                emit(t, src, 0, n);
+                src += n;
+            }
+            if (n > left) return;  // corrupt stream, never from the encoder
+            left -= n;
+        }
+    }
+
+   public:
+    /**
+     * Draw frame `frame` with its top left corner at column `x` and page
+     * `page`, replacing what was there. Later frames are rebuilt from
+     * frame 0 and the deltas up to them; use step() to play an animation.
+     */
+    static void draw(uint8_t* buffer, int16_t x, uint8_t page,
+                     const PackedBitmap& bitmap, uint8_t frame = 0) {
+        unpack(bitmap, 0, buffer, x, page, false);
+        if (frame >= bitmap.frames) frame %= bitmap.frames;
+        for (uint8_t f = 1; f <= frame; f++) {
+            unpack(bitmap, f, buffer, x, page, true);
+        }
+    }
+
+    /**
+     * Turn frame `frame`, as drawn at the same position before, into the
+     * next one by applying a single delta. Wraps from the last frame to the
+     * first.
+     * @return the frame now on screen
+     */
+    static uint8_t step(uint8_t* buffer, int16_t x, uint8_t page,
+                        const PackedBitmap& bitmap, uint8_t frame) {
+        if (bitmap.frames < 2) return 0;
+        uint8_t next = (frame + 1) % bitmap.frames;
+        unpack(bitmap, next ? next : bitmap.frames, buffer, x, page, true);
+        return next;
+    }
+
+    /**
+     * Size of all frames unencoded, as drawBitmap() stores them: rows of
+     * whole bytes, `height` rows per frame.
+     */
+    static uint16_t rawSize(const PackedBitmap& bitmap) {
+        return (bitmap.width + 7) / 8 * bitmap.height * bitmap.frames;
+    }
+
+    /**
+     * Flash used by the bitmap's data and offsets.
+     */
+    static uint16_t packedSize(const PackedBitmap& bitmap) {
+        uint16_t size = bitmap.size;
+        if (bitmap.offsets) size += (bitmap.frames + 1) * sizeof(uint16_t);
+        return size;
+    }
+};
+
+#endif  // _MY_PACKED_BITMAP_H_
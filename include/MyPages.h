@@ -0,0 +1,368 @@
+/**
+ * MyPages.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Rotating screens on top of MyDisplay. Each page declares when it is
+ * available, how long it stays on screen, which values it depends on (its
+ * model, see MyRenderScheduler) and how to draw itself. MyPages handles the
+ * rotation, skips unavailable pages, runs the transitions between them and
+ * holds off the next frame after one that went over the time budget.
+ */
+
+#ifndef _MY_PAGES_H_
+#define _MY_PAGES_H_
+
+#include <Arduino.h>
+
+#include "MyDisplay.h"
+#include "MyRenderScheduler.h"
+
+#define PAGES_MAX 8
+#define PAGE_DURATION 3000        // default ms on screen
+#define PAGE_RENDER_BUDGET 5000   // µs per frame for model and render
+#define PAGE_TRANSITION_STEPS 8   // frames per transition
+#define PAGE_TRANSITION_FRAME 40  // ms between transition frames
+
+#define OLED_FRAME_SIZE (SCREEN_WIDTH * OLED_PAGES)
+
+typedef bool (*PageAvailable)();
+typedef void (*PageModel)(MyRenderScheduler& model);
+typedef void (*PageRender)(MyDisplay& display);
+
+/**
+ * A screen. `available` may be nullptr for pages that are always shown.
+ * `render` draws into a cleared frame; it must not flush.
+ * `update` is optional: if set, it is used instead of `render` when the model
+ * changed while the page is on screen, and draws only the changes on top of
+ * the page's previous frame.
+ */
+struct Page {
+    const char* name;
+    uint16_t duration;  // ms
+    PageAvailable available;
+    PageModel model;
+    PageRender render;
+    PageRender update;
+};
+
+enum PageTransition { TRANSITION_CUT, TRANSITION_SLIDE, TRANSITION_FADE };
+
+class MyPages {
+   private:
+    MyDisplay& _display;
+    MyRenderScheduler _render;
+
+    const Page* _pages[PAGES_MAX];
+    uint16_t _durations[PAGES_MAX];  // ms, from the pages, changeable
+    uint8_t _count = 0;
+    uint8_t _current = 0;
+    unsigned long _shownSince = 0;
+
+    PageTransition _transition = TRANSITION_SLIDE;
+    bool _transitioning = false;
+    uint8_t _step = 0;      // frames of the running transition so far
+    uint8_t _incoming = 0;  // page a fade switches to at its darkest frame
+    unsigned long _nextFrame = 0;
+
+    // Outgoing and incoming frame of a slide, allocated on first use
+    uint8_t* _from = nullptr;
+    uint8_t* _to = nullptr;
+
+    // Frame budget: PAGE_RENDER_BUDGET plus a full flush at the bus clock,
+    // which every slide frame and the page switch of a fade need
+    uint32_t _budget;
+    uint32_t _frames = 0;
+    uint32_t _overruns = 0;
+    uint32_t _frameTime = 0;  // µs, last frame
+    uint32_t _maxFrameTime = 0;
+
+    bool isAvailable(uint8_t i) const {
+        return !_pages[i]->available || _pages[i]->available();
+    }
+
+    /**
+     * Find the next available page after the current one.
+     * @return the current page if no other one is available
+     */
+    uint8_t next() const {
+        for (uint8_t n = 1; n <= _count; n++) {
+            uint8_t i = (_current + n) % _count;
+            if (isAvailable(i)) return i;
+        }
+        return _current;
+    }
+
+    /**
+     * Make page `i` current and draw it into the buffer. Its model is
+     * recorded, so the scheduler knows what is on screen.
+     */
+    void enter(uint8_t i) {
+        _current = i;
+        _shownSince = millis();
+        _render.begin(_current);
+        _pages[_current]->model(_render);
+        _render.markRendered();
+        _display.clear();
+        _pages[_current]->render(_display);
+    }
+
+    /**
+     * Flush a frame and check the time it took against the budget. The
+     * budget is measured once the frame is done, not enforced while it is
+     * drawn: a frame over budget holds off the next one for as long as it
+     * took, so the display never takes more than about half of the loop
+     * time.
+     * @return true if the frame was over budget
+     */
+    bool endFrame(uint32_t start) {
+        _display.flush();
+        _frameTime = micros() - start;
+        _frames++;
+        if (_frameTime > _maxFrameTime) _maxFrameTime = _frameTime;
+
+        if (_frameTime <= _budget) return false;
+        _overruns++;
+        _nextFrame = millis() + _frameTime / 1000;
+        return true;
+    }
+
+    bool allocFrames() {
+        if (!_from) _from = (uint8_t*)malloc(OLED_FRAME_SIZE);
+        if (!_to) _to = (uint8_t*)malloc(OLED_FRAME_SIZE);
+        return _from && _to;
+    }
+
+    /**
+     * Switch to page `i` with the configured transition. A slide needs both
+     * complete frames up front; if they cannot be allocated, it falls back
+     * to a cut.
+     */
+    void show(uint8_t i) {
+        if (_transition == TRANSITION_SLIDE && allocFrames()) {
+            memcpy(_from, _display.getBuffer(), OLED_FRAME_SIZE);
+            enter(i);
+            memcpy(_to, _display.getBuffer(), OLED_FRAME_SIZE);
+        } else if (_transition == TRANSITION_FADE) {
+            _incoming = i;
+        } else {
+            uint32_t start = micros();
+            enter(i);
+            endFrame(start);
+            return;
+        }
+        _transitioning = true;
+        _step = 0;
+        stepTransition();
+    }
+
+    /**
+     * Draw the next transition frame.
+     * Slide: the old page moves out to the left and the new one follows from
+     * the right, whole page rows are moved with memcpy.
+     * Fade: the contrast goes down to zero and back up, the new page is drawn
+     * at the darkest frame. The panel is monochrome, so the contrast is the
+     * only way to fade.
+     * A frame over budget makes the next frame the final one.
+     */
+    void stepTransition() {
+        uint32_t start = micros();
+        _step++;
+
+        if (_transition == TRANSITION_FADE) {
+            uint8_t half = PAGE_TRANSITION_STEPS / 2;
+            if (_step >= half && _current != _incoming) enter(_incoming);
+            uint8_t level = _step < half ? half - _step : _step - half;
+            _display.setContrast(OLED_CONTRAST * level / half);
+        } else {
+            uint8_t shift = SCREEN_WIDTH * _step / PAGE_TRANSITION_STEPS;
+            uint8_t* buffer = _display.getBuffer();
+            for (uint8_t page = 0; page < OLED_PAGES; page++) {
+                uint16_t row = page * SCREEN_WIDTH;
+                memcpy(buffer + row, _from + row + shift, SCREEN_WIDTH - shift);
+                memcpy(buffer + row + SCREEN_WIDTH - shift, _to + row, shift);
+            }
+        }
+
+        bool overrun = endFrame(start);
+        if (_step >= PAGE_TRANSITION_STEPS) {
+            _transitioning = false;
+            _shownSince = millis();
+        } else if (overrun) {
+            _step = PAGE_TRANSITION_STEPS - 1;
+        } else {
+            _nextFrame = millis() + PAGE_TRANSITION_FRAME;
+        }
+    }
+
+   public:
+    MyPages(MyDisplay& display)
+        : _display(display),
+          _budget(PAGE_RENDER_BUDGET + display.getFullFlushTime()) {}
+
+    /**
+     * Register a page. Pages rotate in the order they were added.
+     */
+    bool add(const Page& page) {
+        if (_count >= PAGES_MAX) return false;
+        _durations[_count] = page.duration;
+        _pages[_count++] = &page;
+        return true;
+    }
+
+    /**
+     * Change how long a page stays on screen, by its name.
+     * @return false if there is no such page
+     */
+    bool setDuration(const char* name, uint16_t duration) {
+        for (uint8_t i = 0; i < _count; i++) {
+            if (strcmp(_pages[i]->name, name) != 0) continue;
+            _durations[i] = duration;
+            return true;
+        }
+        return false;
+    }
+
+    uint8_t getCount() const { return _count; }
+
+    const char* getName(uint8_t i) const { return _pages[i]->name; }
+
+    void setTransition(PageTransition transition) { _transition = transition; }
+
+    /**
+     * Rotate, transition and redraw as needed. At most one frame per call.
+     */
+    void loop() {
+        if (!_count) return;
+        if (_display.isFlushing()) {
+            // Finish the frame first, it was split for a sensor read
+            _display.flush();
+            return;
+        }
+        if ((long)(millis() - _nextFrame) < 0) return;
+
+        if (_transitioning) {
+            stepTransition();
+            return;
+        }
+
+        bool expired = millis() - _shownSince >= _durations[_current];
+        if (expired || !isAvailable(_current)) {
+            uint8_t i = next();
+            if (i != _current) {
+                show(i);
+                return;
+            }
+            _shownSince = millis();
+        }
+
+        _render.begin(_current);
+        _pages[_current]->model(_render);
+        if (!_render.shouldRender()) return;
+
+        uint32_t start = micros();
+        const Page& page = *_pages[_current];
+        if (page.update) {
+            page.update(_display);
+        } else {
+            _display.clear();
+            page.render(_display);
+        }
+        endFrame(start);
+    }
+
+    bool isTransitioning() const { return _transitioning; }
+
+    /**
+     * Name of the page on screen.
+     */
+    const char* getCurrent() const {
+        return _count ? _pages[_current]->name : "";
+    }
+
+    uint32_t getFrames() const { return _frames; }
+    uint32_t getOverruns() const { return _overruns; }
+    uint32_t getMaxFrameTime() const { return _maxFrameTime; }
+    uint32_t getBudget() const { return _budget; }
+
+    /**
+     * Print the frame on screen as a PBM image to the Serial Monitor.
+     */
+    void printScreenshot() {
+        _display.printPbm(Serial, getCurrent());
+    }
+
+    /**
+     * Time every page: render (model + draw into the buffer, averaged over
+     * `iterations`), a full flush and a flush without changes. Also prints
+     * each frame's checksum to compare renders between builds. Blocks for a
+     * few hundred ms; the current page is drawn again afterwards.
+     */
+    void printBenchmark(uint16_t iterations = 20) {
+        Serial.println("Page        render    full flush   no-change   checksum");
+        uint8_t current = _current;
+        MyRenderScheduler model;
+
+        for (uint8_t i = 0; i < _count; i++) {
+            if (!isAvailable(i)) continue;
+            const Page& page = *_pages[i];
+
+            uint32_t start = micros();
+            for (uint16_t n = 0; n < iterations; n++) {
+                model.begin(i);
+                page.model(model);
+                _display.clear();
+                page.render(_display);
+            }
+            uint32_t render = (micros() - start) / iterations;
+
+            _display.invalidate();
+            start = micros();
+            uint32_t failures = _display.getFailures();
+            while (!_display.flush() && _display.getFailures() == failures) {
+            }
+            uint32_t full = micros() - start;
+
+            start = micros();
+            _display.flush();
+            uint32_t unchanged = micros() - start;
+
+            Serial.printf("%-10s %6u µs  %8u µs  %6u µs   %08x\n", page.name,
+                          render, full, unchanged, _display.getChecksum());
+        }
+        Serial.println();
+
+        _current = current;
+        redraw();
+    }
+
+    /**
+     * Draw the current page again after something else used the display.
+     * Cancels a running transition.
+     */
+    void redraw() {
+        _transitioning = false;
+        _display.setContrast(OLED_CONTRAST);
+        enter(_current);
+        _display.flush();
+    }
+
+    /**
+     * Print pages and frame budget statistics to the Serial Monitor.
+     */
+    void printStats() {
+        Serial.println("Pages:");
+        for (uint8_t i = 0; i < _count; i++) {
+            Serial.printf("%c %-10s %5u ms%s\n", i == _current ? '>' : ' ',
+                          _pages[i]->name, _durations[i],
+                          isAvailable(i) ? "" : " (unavailable)");
+        }
+        Serial.printf("Frames: %u, %u over the %u µs budget\n", _frames,
+                      _overruns, _budget);
+        Serial.printf("Last frame: %u µs, max. %u µs\n", _frameTime,
+                      _maxFrameTime);
+        Serial.println();
+        _render.printStats();
+    }
+};
+
+#endif  // _MY_PAGES_H_
@@ -0,0 +1,113 @@
+/**
+ * MyRenderScheduler.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Decides whether a screen needs to be drawn at all. Every loop the caller
+ * feeds the values a screen shows (its model) into the scheduler; the screen
+ * is only rendered when that model differs from the last rendered frame and
+ * the frame-rate cap allows it. The model is kept as a 32 bit FNV-1a hash, so
+ * no copies of the inputs are stored.
+ */
+
+#ifndef _MY_RENDER_SCHEDULER_H_
+#define _MY_RENDER_SCHEDULER_H_
+
+#include <Arduino.h>
+
+#define RENDER_MAX_FPS 10  // upper bound for frames per second
+
+#define FNV_OFFSET 2166136261UL
+#define FNV_PRIME 16777619UL
+
+class MyRenderScheduler {
+   private:
+    uint16_t _minInterval;     // ms between frames
+    uint32_t _model = 0;       // model being built this loop
+    uint32_t _rendered = 0;    // model of the frame on the panel
+    bool _valid = false;       // false until the first frame / after invalidate()
+    unsigned long _lastFrame = 0;
+
+    uint32_t _frames = 0;
+    uint32_t _skipped = 0;    // model unchanged
+    uint32_t _throttled = 0;  // model changed, but too early
+
+    void addBytes(const void* data, size_t len) {
+        const uint8_t* p = (const uint8_t*)data;
+        for (size_t i = 0; i < len; i++) {
+            _model = (_model ^ p[i]) * FNV_PRIME;
+        }
+    }
+
+   public:
+    MyRenderScheduler(uint8_t maxFps = RENDER_MAX_FPS)
+        : _minInterval(1000 / maxFps) {}
+
+    /**
+     * Start the model of this loop's frame.
+     * @param screen id of the screen shown, so switching screens always
+     * renders
+     */
+    void begin(uint8_t screen) {
+        _model = FNV_OFFSET;
+        add(screen);
+    }
+
+    void add(int32_t value) { addBytes(&value, sizeof(value)); }
+
+    void add(const char* str) { addBytes(str, strlen(str) + 1); }
+
+    void add(const String& str) { add(str.c_str()); }
+
+    /**
+     * Check the model against the last rendered frame.
+     * @return true if the caller should render now
+     */
+    bool shouldRender() {
+        if (_valid && _model == _rendered) {
+            _skipped++;
+            return false;
+        }
+        if (_valid && millis() - _lastFrame < _minInterval) {
+            _throttled++;
+            return false;
+        }
+        markRendered();
+        return true;
+    }
+
+    /**
+     * Record the current model as being on screen, for frames rendered
+     * without asking shouldRender().
+     */
+    void markRendered() {
+        _rendered = _model;
+        _valid = true;
+        _lastFrame = millis();
+        _frames++;
+    }
+
+    /**
+     * Force the next frame to render, e.g. after drawing outside the
+     * scheduler.
+     */
+    void invalidate() { _valid = false; }
+
+    /**
+     * Print frames rendered vs. skipped to the Serial Monitor.
+     */
+    void printStats() {
+        uint32_t total = _frames + _skipped + _throttled;
+        Serial.println("Render Scheduler:");
+        Serial.printf("Rendered: %u, skipped: %u (unchanged %u, throttled %u)\n",
+                      _frames, _skipped + _throttled, _skipped, _throttled);
+        if (total) {
+            uint32_t permille = (uint64_t)_frames * 1000 / total;
+            Serial.printf("Rendered %u.%u%% of %u loop passes, cap %u fps\n",
+                          permille / 10, permille % 10, total,
+                          1000 / _minInterval);
+        }
+        Serial.println();
+    }
+};
+
+#endif  // _MY_RENDER_SCHEDULER_H_
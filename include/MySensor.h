@@ -9,67 +9,593 @@
 #include <Adafruit_BME280.h>
 #include <Adafruit_Sensor.h>
 #include <Arduino.h>
-#include <Wire.h>
+#include <time.h>
+
+#include "MyBmeCompensation.h"
+#include "MyDerivedMetrics.h"
+#include "MyFormat.h"
+#include "MyI2CBus.h"
 
 #define SEALEVELPRESSURE_HPA (1013.25)
+#define SENSOR_DEFAULT_PROFILE 1  // "indoor"
+#define SENSOR_PROBE_INTERVAL 5000  // ms between probes while absent
+#define SENSOR_MAX_FAILURES 3       // failed reads in a row before faulted
+
+// BME280 registers
+#define BME280_REG_CALIB_00 0x88  // dig_T1 .. dig_P9 (24 bytes) + dig_H1 @ 0xA1
+#define BME280_REG_CALIB_26 0xE1  // dig_H2 .. dig_H6 (7 bytes)
+#define BME280_REG_CHIP_ID 0xD0
+#define BME280_REG_RESET 0xE0
+#define BME280_REG_CTRL_HUM 0xF2
+#define BME280_REG_STATUS 0xF3
+#define BME280_REG_CTRL_MEAS 0xF4
+#define BME280_REG_CONFIG 0xF5
+#define BME280_REG_DATA 0xF7      // press[3] temp[3] hum[2]
+
+#define BME280_CHIP_ID 0x60
+#define BME280_SOFT_RESET 0xB6
+#define BME280_STATUS_IM_UPDATE 0x01
+#define BME280_STARTUP_TIME 2  // ms after power-on or soft reset
+
+enum SensorState {
+    SENSOR_ABSENT,   // no sensor answered, re-probing periodically
+    SENSOR_PROBING,  // chip found and reset, waiting for NVM copy
+    SENSOR_READY,    // configured and sampling
+    SENSOR_FAULTED,  // reads kept failing, bus will be cleared
+};
+
+/**
+ * A named BME280 configuration (datasheet 3.5, recommended modes of
+ * operation) together with the rate at which MySensor samples it.
+ */
+struct SensorProfile {
+    const char* name;
+    Adafruit_BME280::sensor_mode mode;
+    Adafruit_BME280::sensor_sampling temperature;
+    Adafruit_BME280::sensor_sampling pressure;
+    Adafruit_BME280::sensor_sampling humidity;
+    Adafruit_BME280::sensor_filter filter;
+    Adafruit_BME280::standby_duration standby;
+    unsigned long samplePeriod;  // ms
+};
+
+#define SENSOR_PROFILE_COUNT 4
+const SensorProfile sensorProfiles[SENSOR_PROFILE_COUNT] = {
+    // One forced conversion per minute, sensor sleeps in between
+    {"weather", Adafruit_BME280::MODE_FORCED, Adafruit_BME280::SAMPLING_X1,
+     Adafruit_BME280::SAMPLING_X1, Adafruit_BME280::SAMPLING_X1,
+     Adafruit_BME280::FILTER_OFF, Adafruit_BME280::STANDBY_MS_1000, 60000},
+    // Continuous, heavily filtered pressure for a steady 1 Hz display
+    {"indoor", Adafruit_BME280::MODE_NORMAL, Adafruit_BME280::SAMPLING_X2,
+     Adafruit_BME280::SAMPLING_X16, Adafruit_BME280::SAMPLING_X1,
+     Adafruit_BME280::FILTER_X16, Adafruit_BME280::STANDBY_MS_500, 1000},
+    // Short conversions with light filtering, 10 Hz
+    {"low-latency", Adafruit_BME280::MODE_NORMAL, Adafruit_BME280::SAMPLING_X1,
+     Adafruit_BME280::SAMPLING_X4, Adafruit_BME280::SAMPLING_X1,
+     Adafruit_BME280::FILTER_X4, Adafruit_BME280::STANDBY_MS_0_5, 100},
+    // Fastest possible conversions, no filtering
+    {"burst", Adafruit_BME280::MODE_NORMAL, Adafruit_BME280::SAMPLING_X1,
+     Adafruit_BME280::SAMPLING_X1, Adafruit_BME280::SAMPLING_X1,
+     Adafruit_BME280::FILTER_OFF, Adafruit_BME280::STANDBY_MS_0_5, 10},
+};
+
+// Standby time per Adafruit_BME280::standby_duration value, in µs
+const uint32_t PROGMEM bmeStandbyTimes[8] = {500,    62500,  125000, 250000,
+                                             500000, 1000000, 10000,  20000};
+
+/**
+ * One compensated reading of every BME280 channel.
+ * Taken with a single burst read, so all fields belong to the same
+ * measurement. Values are integers in hundredths of their unit (e.g. 2153 =
+ * 21.53 °C), so consumers can format them without floating point.
+ */
+struct SensorSnapshot {
+    uint32_t sequence = 0;     // incremented on every new sample
+    unsigned long millis = 0;  // millis() when the sample was taken
+    time_t epoch = 0;          // wall clock time (0 if not synced yet)
+
+    int32_t temperatureC = 0;  // 0.01 °C
+    int32_t temperatureF = 0;  // 0.01 °F
+    int32_t humidity = 0;      // 0.01 %RH
+    int32_t pressure = 0;      // 0.01 hPa (= Pa)
+    int32_t altitude = 0;      // 0.01 m (= cm)
+
+    DerivedMetrics derived;
+
+    bool valid = false;  // false while the sensor is not ready
+};
 
 class MySensor {
    private:
-    uint8_t _address;
-    Adafruit_BME280 _bme;
+    MyI2CBus& _bus;
+    I2CDevice _device;
+    MyBmeCompensation _compensation;
+    MyDerivedMetrics _derived;
+    SensorSnapshot _snapshot;
+    SensorState _state = SENSOR_ABSENT;
+    unsigned long _stateSince = 0;
+    uint8_t _failures = 0;
+    uint8_t _profile;
+    int8_t _pendingProfile = -1;
+    unsigned long _samplePeriod = 0;
+    unsigned long _conversionTime = 0;  // ms, rounded up
+    unsigned long _lastSample = 0;
+    bool _converting = false;
+
+    // Raw ADC values of the latest sample
+    int32_t _adcT = 0;
+    int32_t _adcP = 0;
+    int32_t _adcH = 0;
+
+    bool readRegisters(uint8_t reg, uint8_t* buf, uint8_t len) {
+        return _bus.readRegisters(_device, reg, buf, len);
+    }
+
+    bool writeRegister(uint8_t reg, uint8_t value) {
+        return _bus.writeRegister(_device, reg, value);
+    }
+
+    /**
+     * Load the factory trimming parameters.
+     */
+    bool readCalibration() {
+        uint8_t a[26];
+        uint8_t b[7];
+        if (!readRegisters(BME280_REG_CALIB_00, a, sizeof(a))) return false;
+        if (!readRegisters(BME280_REG_CALIB_26, b, sizeof(b))) return false;
+
+        _compensation.setCalibration(a, b);
+        return true;
+    }
+
+    void setState(SensorState state) {
+        if (state != _state) {
+            Serial.printf("[Sensor] %s -> %s\n", getStateName(_state),
+                          getStateName(state));
+        }
+        _state = state;
+        _stateSince = millis();
+        _failures = 0;
+        _converting = false;
+        if (state != SENSOR_READY) _snapshot.valid = false;
+    }
+
+    /**
+     * Count a failed bus transaction while ready. Too many in a row put the
+     * sensor into the faulted state.
+     */
+    void fail() {
+        if (++_failures >= SENSOR_MAX_FAILURES) setState(SENSOR_FAULTED);
+    }
+
+    /**
+     * Look for the chip and soft reset it. The reset takes
+     * BME280_STARTUP_TIME, which is waited out in the probing state.
+     * The bus is cleared first if SDA is held low, or with `clear` after
+     * reads kept failing: a slave left holding SDA by a reset or an
+     * interrupted transfer would otherwise make every probe fail.
+     */
+    void probe(bool clear = false) {
+        if (clear || _bus.isHung()) _bus.recover();
+
+        uint8_t id = 0;
+        if (readRegisters(BME280_REG_CHIP_ID, &id, 1) && id == BME280_CHIP_ID &&
+            writeRegister(BME280_REG_RESET, BME280_SOFT_RESET)) {
+            setState(SENSOR_PROBING);
+        } else {
+            setState(SENSOR_ABSENT);
+        }
+    }
+
+    /**
+     * Finish bring-up once the reset is done: load the calibration and
+     * configure the active profile.
+     */
+    void configure() {
+        uint8_t status = 0;
+        if (!readRegisters(BME280_REG_STATUS, &status, 1)) {
+            setState(SENSOR_ABSENT);
+            return;
+        }
+        if (status & BME280_STATUS_IM_UPDATE) return;  // NVM still copying
+
+        if (!readCalibration() || !applyProfile(_profile)) {
+            setState(SENSOR_ABSENT);
+            return;
+        }
+        setState(SENSOR_READY);
+        startSampling();
+    }
+
+    /**
+     * Schedule the first read of a freshly configured profile.
+     */
+    void startSampling() {
+        if (sensorProfiles[_profile].mode == Adafruit_BME280::MODE_FORCED) {
+            // Writing ctrl_meas already started a conversion
+            _converting = true;
+            _lastSample = millis();
+        } else {
+            // Read as soon as the first conversion is done
+            _lastSample = millis() - _samplePeriod + _conversionTime;
+        }
+    }
+
+    /**
+     * millis() at which update() will next access the bus.
+     */
+    unsigned long nextAccess() const {
+        switch (_state) {
+            case SENSOR_ABSENT:
+                return _stateSince + SENSOR_PROBE_INTERVAL;
+            case SENSOR_PROBING:
+                return _stateSince + BME280_STARTUP_TIME;
+            case SENSOR_READY:
+                if (_pendingProfile >= 0) break;
+                return _lastSample +
+                       (_converting ? _conversionTime : _samplePeriod);
+            case SENSOR_FAULTED:
+                break;
+        }
+        return millis();
+    }
+
+    /**
+     * Burst read the whole data block and compensate it into a new snapshot.
+     * Temperature is compensated once and its t_fine reused for pressure and
+     * humidity.
+     */
+    bool sample() {
+        uint8_t d[8];
+        if (!readRegisters(BME280_REG_DATA, d, sizeof(d))) {
+            fail();
+            return false;
+        }
+        _failures = 0;
+
+        int32_t adcP = (int32_t)d[0] << 12 | (int32_t)d[1] << 4 | d[2] >> 4;
+        int32_t adcT = (int32_t)d[3] << 12 | (int32_t)d[4] << 4 | d[5] >> 4;
+        int32_t adcH = (int32_t)d[6] << 8 | d[7];
+        if (adcT == 0x80000) return false;  // measurement skipped
+
+        _adcT = adcT;
+        _adcP = adcP;
+        _adcH = adcH;
+
+        int32_t temperature = _compensation.temperature(adcT);
+        uint32_t pressure = _compensation.pressure(adcP);
+
+        _snapshot.sequence++;
+        _snapshot.millis = millis();
+        _snapshot.epoch = time(nullptr);
+        _snapshot.temperatureC = temperature;
+        _snapshot.temperatureF = toFahrenheit(temperature);
+        _snapshot.humidity = _compensation.humidity(adcH);
+        _snapshot.pressure = pressure;
+        _snapshot.altitude = MyBmeCompensation::altitude(pressure);
+        _snapshot.derived =
+            _derived.update(temperature, _snapshot.humidity, pressure,
+                            _snapshot.millis);
+        _snapshot.valid = true;
+        return true;
+    }
+
+    /**
+     * Write the profile's configuration to the sensor and derive the sample
+     * timing from it.
+     */
+    bool applyProfile(uint8_t index) {
+        const SensorProfile& profile = sensorProfiles[index];
+        _profile = index;
+        _converting = false;
+
+        // config is only reliably written in sleep mode, and ctrl_hum only
+        // takes effect after the following ctrl_meas write. The pairs are
+        // applied in this order, all in one transaction.
+        const uint8_t pairs[] = {
+            BME280_REG_CTRL_MEAS, Adafruit_BME280::MODE_SLEEP,
+            BME280_REG_CTRL_HUM,  profile.humidity,
+            BME280_REG_CONFIG,    (uint8_t)(profile.standby << 5 | profile.filter << 2),
+            BME280_REG_CTRL_MEAS, (uint8_t)(profile.temperature << 5 | profile.pressure << 2 |
+                                            profile.mode)};
+        if (!_bus.writeRegisters(_device, pairs, sizeof(pairs) / 2)) return false;
+
+        _conversionTime = (getConversionTime(profile) + 999) / 1000;
+        _samplePeriod = profile.samplePeriod;
+        if (profile.mode == Adafruit_BME280::MODE_NORMAL) {
+            // A new result is only available once per measurement cycle
+            unsigned long cycle =
+                (getConversionTime(profile) +
+                 pgm_read_dword(&bmeStandbyTimes[profile.standby]) + 999) /
+                1000;
+            _samplePeriod = max(_samplePeriod, cycle);
+        }
+
+        Serial.printf("[Sensor] Profile '%s': conversion %lu ms, sample every %lu ms\n",
+                      profile.name, _conversionTime, _samplePeriod);
+        return true;
+    }
+
+    /**
+     * One step of the state machine, see update().
+     */
+    bool poll() {
+        switch (_state) {
+            case SENSOR_ABSENT:
+                if (millis() - _stateSince >= SENSOR_PROBE_INTERVAL) probe();
+                return false;
+            case SENSOR_PROBING:
+                if (millis() - _stateSince >= BME280_STARTUP_TIME) configure();
+                return false;
+            case SENSOR_FAULTED:
+                // The pass after the fault: clear the bus, probe right away
+                probe(true);
+                return false;
+            case SENSOR_READY:
+                break;
+        }
+
+        if (_pendingProfile >= 0) {
+            uint8_t index = _pendingProfile;
+            _pendingProfile = -1;
+            if (!applyProfile(index)) {
+                fail();
+                return false;
+            }
+            startSampling();
+        }
+
+        const SensorProfile& profile = sensorProfiles[_profile];
+
+        if (_converting) {
+            if (millis() - _lastSample < _conversionTime) return false;
+            _converting = false;
+            return sample();
+        }
+
+        if (millis() - _lastSample < _samplePeriod) return false;
+        _lastSample = millis();
+
+        if (profile.mode == Adafruit_BME280::MODE_FORCED) {
+            // ctrl_hum is latched from applyProfile()
+            if (!writeRegister(BME280_REG_CTRL_MEAS, profile.temperature << 5 |
+                                                         profile.pressure << 2 |
+                                                         profile.mode)) {
+                fail();
+                return false;
+            }
+            _converting = true;
+            return false;
+        }
+        return sample();
+    }
 
    public:
-    MySensor(uint8_t address = 0x76) : _address(address) {}
+    MySensor(MyI2CBus& bus, uint8_t address = 0x76,
+             uint8_t profile = SENSOR_DEFAULT_PROFILE)
+        : _bus(bus), _device("BME280", address), _profile(profile) {}
 
     /**
-     * Initialize the BME280 sensor.
+     * Start probing for the BME280 on the (already started) bus. Does not
+     * wait for the sensor: it becomes ready a few ms later through update(),
+     * or is re-probed every SENSOR_PROBE_INTERVAL if it is missing.
      */
     void begin() {
-        if (!_bme.begin(_address)) {
+        _bus.attach(_device);
+        probe();
+        if (_state == SENSOR_ABSENT) {
             Serial.println(
                 "Could not find a valid BME280 sensor, check wiring!");
-            while (1);
         }
     }
 
+    /**
+     * Drive the sensor state machine and take a new snapshot once the sample
+     * period has elapsed and the conversion is finished. In forced mode the
+     * conversion is triggered here and read back on a later call, so this
+     * never waits for the sensor. To be placed in the main loop.
+     * The next access is reserved on the bus, so display flushes make way
+     * for it.
+     * @return true if a new snapshot was taken
+     */
+    bool update() {
+        bool sampled = poll();
+        _bus.reserve(nextAccess());
+        return sampled;
+    }
+
+    /**
+     * Get the current state of the sensor state machine.
+     */
+    SensorState getState() const { return _state; }
+
+    /**
+     * 0.01 °C to 0.01 °F, rounded half away from zero so it is symmetric
+     * below 0 °C.
+     */
+    static int32_t toFahrenheit(int32_t celsius) {
+        return (celsius * 9 + (celsius < 0 ? -2 : 2)) / 5 + 3200;
+    }
+
+    static const char* getStateName(SensorState state) {
+        switch (state) {
+            case SENSOR_ABSENT:
+                return "absent";
+            case SENSOR_PROBING:
+                return "probing";
+            case SENSOR_READY:
+                return "ready";
+            case SENSOR_FAULTED:
+                return "faulted";
+        }
+        return "unknown";
+    }
+
+    /**
+     * Maximum measurement time of a profile (datasheet 9.1).
+     * @return conversion time in µs
+     */
+    static uint32_t getConversionTime(const SensorProfile& profile) {
+        auto count = [](Adafruit_BME280::sensor_sampling s) -> uint32_t {
+            return s == Adafruit_BME280::SAMPLING_NONE ? 0 : 1 << (s - 1);
+        };
+        uint32_t t = 1250 + 2300 * count(profile.temperature);
+        if (count(profile.pressure)) t += 2300 * count(profile.pressure) + 575;
+        if (count(profile.humidity)) t += 2300 * count(profile.humidity) + 575;
+        return t;
+    }
+
+    /**
+     * Switch to another sampling profile. The change is applied on the next
+     * update(), so this is safe to call from web server callbacks.
+     * @return false if there is no profile with that name
+     */
+    bool selectProfile(const char* name) {
+        for (uint8_t i = 0; i < SENSOR_PROFILE_COUNT; i++) {
+            if (strcmp(sensorProfiles[i].name, name) == 0) {
+                _pendingProfile = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Get the active sampling profile.
+     */
+    const SensorProfile& getProfile() const { return sensorProfiles[_profile]; }
+
+    /**
+     * Get the profile selected last: the pending one until the next
+     * update() applies it, the active one otherwise.
+     */
+    const SensorProfile& getRequestedProfile() const {
+        return sensorProfiles[_pendingProfile >= 0 ? _pendingProfile : _profile];
+    }
+
+    /**
+     * True while a selected profile waits for the next update().
+     */
+    bool isProfilePending() const { return _pendingProfile >= 0; }
+
+    /**
+     * Get the effective sample period of the active profile in ms.
+     */
+    unsigned long getSamplePeriod() const { return _samplePeriod; }
+
+    /**
+     * Get the latest snapshot. Does not touch the I2C bus.
+     */
+    const SensorSnapshot& getSnapshot() const { return _snapshot; }
+
+    /**
+     * Number of I2C transactions issued to the BME280 since boot.
+     */
+    uint32_t getBusTransactions() const { return _device.transactions; }
+
     /**
      * Print BME280 sensor values to the Serial Monitor.
      */
     void printValues() {
+        char buf[16];
         Serial.println("BME280 Sensor Values:");
-        Serial.printf("Temperature = %.2f °C\n", readTemperatureC());
-        Serial.printf("Temperature = %.2f °F\n", readTemperatureF());
-        Serial.printf("Pressure = %.2f hPa\n", readPressure());
-        Serial.printf("Approx. Altitude = %.2f m\n", readAltitude());
-        Serial.printf("Humidity = %.2f %%\n", readHumidity());
+        Serial.printf("State = %s%s\n", getStateName(_state),
+                      _snapshot.valid ? "" : " (values invalid)");
+        Serial.printf("Sample #%u (%lu ms ago, %u I2C transactions)\n",
+                      _snapshot.sequence, millis() - _snapshot.millis,
+                      _device.transactions);
+        Serial.printf("Profile = %s (%u µs conversion, %lu ms period)\n",
+                      getProfile().name, getConversionTime(getProfile()),
+                      _samplePeriod);
+        Serial.printf("Temperature = %s °C\n",
+                      MyFormat::centi(_snapshot.temperatureC, buf, sizeof(buf)));
+        Serial.printf("Temperature = %s °F\n",
+                      MyFormat::centi(_snapshot.temperatureF, buf, sizeof(buf)));
+        Serial.printf("Pressure = %s hPa\n",
+                      MyFormat::centi(_snapshot.pressure, buf, sizeof(buf)));
+        Serial.printf("Approx. Altitude = %s m\n",
+                      MyFormat::centi(_snapshot.altitude, buf, sizeof(buf)));
+        Serial.printf("Humidity = %s %%\n",
+                      MyFormat::centi(_snapshot.humidity, buf, sizeof(buf)));
+        Serial.printf("Dew Point = %s °C\n",
+                      MyFormat::centi(_snapshot.derived.dewPoint, buf, sizeof(buf)));
+        Serial.printf("Absolute Humidity = %s g/m³\n",
+                      MyFormat::centi(_snapshot.derived.absoluteHumidity, buf, sizeof(buf)));
+        Serial.printf("Heat Index = %s °C\n",
+                      MyFormat::centi(_snapshot.derived.heatIndex, buf, sizeof(buf)));
+        Serial.printf("Pressure Tendency = %s hPa/3h%s\n",
+                      MyFormat::centi(_snapshot.derived.pressureTendency, buf, sizeof(buf)),
+                      _snapshot.derived.tendencyValid ? "" : " (collecting)");
+        Serial.printf("Forecast = %c: %s\n", _snapshot.derived.forecast,
+                      MyDerivedMetrics::getForecastText(_snapshot.derived.forecast));
+        Serial.println();
+    }
+
+    /**
+     * Compare the integer compensation against the float reference on the
+     * latest raw sample and print the cycle count of each path.
+     */
+    void printBenchmark(uint16_t iterations = 1000) {
+        MyBmeCompensation compensation = _compensation;
+        volatile int32_t sink = 0;
+
+        uint32_t start = ESP.getCycleCount();
+        for (uint16_t i = 0; i < iterations; i++) {
+            uint32_t pressure;
+            sink = compensation.temperature(_adcT);
+            sink = pressure = compensation.pressure(_adcP);
+            sink = compensation.humidity(_adcH);
+            sink = MyBmeCompensation::altitude(pressure);
+        }
+        uint32_t intCycles = (ESP.getCycleCount() - start) / iterations;
+
+        float t, p, h, a;
+        start = ESP.getCycleCount();
+        for (uint16_t i = 0; i < iterations; i++) {
+            compensation.compensateFloat(_adcT, _adcP, _adcH, t, p, h, a);
+            sink = (int32_t)a;
+        }
+        uint32_t floatCycles = (ESP.getCycleCount() - start) / iterations;
+        (void)sink;
+
+        char temperature[16];
+        char humidity[16];
+        Serial.println("BME280 Compensation Benchmark:");
+        Serial.printf("Integer: %u cycles/sample (%s °C, %d Pa, %s %%, %d cm)\n",
+                      intCycles,
+                      MyFormat::centi(_snapshot.temperatureC, temperature, sizeof(temperature)),
+                      _snapshot.pressure,
+                      MyFormat::centi(_snapshot.humidity, humidity, sizeof(humidity)),
+                      _snapshot.altitude);
+        Serial.printf("Float:   %u cycles/sample (%.2f °C, %.2f hPa, %.2f %%, %.2f m)\n",
+                      floatCycles, t, p, h, a);
         Serial.println();
     }
 
     /**
-     * Read temperature in Celsius.
+     * Read temperature in Celsius from the latest snapshot.
      */
-    float readTemperatureC() { return _bme.readTemperature(); }
+    float readTemperatureC() { return _snapshot.temperatureC / 100.0f; }
 
     /**
-     * Read temperature in Fahrenheit.
-     *
+     * Read temperature in Fahrenheit from the latest snapshot.
      */
-    float readTemperatureF() { return 1.8 * _bme.readTemperature() + 32; }
+    float readTemperatureF() { return _snapshot.temperatureF / 100.0f; }
 
     /**
-     * Read pressure in hPa.
+     * Read pressure in hPa from the latest snapshot.
      */
-    float readPressure() { return _bme.readPressure() / 100.0F; }
+    float readPressure() { return _snapshot.pressure / 100.0f; }
 
     /**
-     * Read humidity in percentage.
+     * Read humidity in percentage from the latest snapshot.
      */
-    float readHumidity() { return _bme.readHumidity(); }
+    float readHumidity() { return _snapshot.humidity / 100.0f; }
 
     /**
-     * Read altitude in meters.
+     * Read altitude in meters from the latest snapshot.
      */
-    float readAltitude() { return _bme.readAltitude(SEALEVELPRESSURE_HPA); }
+    float readAltitude() { return _snapshot.altitude / 100.0f; }
 };
 
 #endif  // _MY_SENSOR_H_
@@ -0,0 +1,208 @@
+/**
+ * MySensorFilter.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Per-channel streaming filter chain for sensor snapshots:
+ * spike rejection -> sliding median -> exponential moving average ->
+ * hysteresis. Fixed point, constant work per sample and no allocations.
+ * Every output (display, SSE, MQTT) owns its own MySensorFilter, so each can
+ * use a different configuration.
+ */
+
+#ifndef _MY_SENSOR_FILTER_H_
+#define _MY_SENSOR_FILTER_H_
+
+#include <Arduino.h>
+
+#include "MySensor.h"
+
+#define FILTER_MEDIAN_MAX 5   // largest median window
+#define FILTER_SPIKE_REJECTS 3  // rejected samples in a row before following
+
+/**
+ * Filter stages of one channel. Values are in the channel's raw units
+ * (0.01 °C, 0.01 %RH, Pa). A zero disables a stage.
+ */
+struct ChannelFilterConfig {
+    int32_t spikeLimit;  // max. jump from the last accepted sample
+    uint8_t median;      // median window size: 0, 3 or 5
+    uint8_t emaShift;    // EMA with alpha = 1 / 2^emaShift
+    int32_t hysteresis;  // min. change before the output moves
+};
+
+struct SensorFilterConfig {
+    const char* name;
+    ChannelFilterConfig temperature;
+    ChannelFilterConfig humidity;
+    ChannelFilterConfig pressure;
+};
+
+// Values exactly as read
+const SensorFilterConfig sensorFilterRaw = {
+    "raw", {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}};
+
+// Glitches removed, otherwise unchanged
+const SensorFilterConfig sensorFilterClean = {
+    "clean", {200, 3, 0, 0}, {500, 3, 0, 0}, {200, 3, 0, 0}};
+
+// Steady readout for humans: no flicker in the last digit
+const SensorFilterConfig sensorFilterSmooth = {
+    "smooth", {200, 5, 3, 5}, {500, 5, 3, 10}, {200, 5, 3, 10}};
+
+class MyChannelFilter {
+   private:
+    const ChannelFilterConfig* _config;
+    bool _started = false;
+
+    int32_t _accepted = 0;
+    uint8_t _rejects = 0;
+
+    int32_t _window[FILTER_MEDIAN_MAX];
+    uint8_t _windowHead = 0;
+    uint8_t _windowCount = 0;
+
+    int32_t _ema = 0;  // Q24.8
+
+    int32_t _output = 0;
+
+    int32_t median(int32_t value) {
+        uint8_t size = _config->median;
+        _window[_windowHead] = value;
+        _windowHead = (_windowHead + 1) % size;
+        if (_windowCount < size) _windowCount++;
+
+        // Insertion sort of at most FILTER_MEDIAN_MAX values
+        int32_t sorted[FILTER_MEDIAN_MAX];
+        for (uint8_t i = 0; i < _windowCount; i++) {
+            int32_t v = _window[i];
+            int8_t j = i - 1;
+            for (; j >= 0 && sorted[j] > v; j--) sorted[j + 1] = sorted[j];
+            sorted[j + 1] = v;
+        }
+        return sorted[_windowCount / 2];
+    }
+
+   public:
+    void begin(const ChannelFilterConfig& config) {
+        _config = &config;
+        _started = false;
+        _rejects = 0;
+        _windowHead = 0;
+        _windowCount = 0;
+    }
+
+    int32_t update(int32_t value) {
+        const ChannelFilterConfig& c = *_config;
+
+        if (!_started) {
+            _accepted = value;
+            _ema = value * 256;
+            _output = value;
+            _started = true;
+        }
+
+        if (c.spikeLimit) {
+            if (abs(value - _accepted) > c.spikeLimit &&
+                _rejects < FILTER_SPIKE_REJECTS) {
+                _rejects++;
+                value = _accepted;
+            } else {
+                // Accept, also after a lasting step change
+                _rejects = 0;
+                _accepted = value;
+            }
+        }
+
+        if (c.median > 1) value = median(value);
+
+        if (c.emaShift) {
+            _ema += (value * 256 - _ema) >> c.emaShift;
+            value = (_ema + 128) >> 8;
+        }
+
+        if (abs(value - _output) >= c.hysteresis) _output = value;
+        return _output;
+    }
+};
+
+class MySensorFilter {
+   private:
+    const SensorFilterConfig* _config;
+    MyChannelFilter _temperature;
+    MyChannelFilter _humidity;
+    MyChannelFilter _pressure;
+    SensorSnapshot _snapshot;
+
+   public:
+    MySensorFilter(const SensorFilterConfig& config = sensorFilterRaw) {
+        setConfig(config);
+    }
+
+    /**
+     * Change the configuration. Filter state starts over.
+     */
+    void setConfig(const SensorFilterConfig& config) {
+        _config = &config;
+        _temperature.begin(config.temperature);
+        _humidity.begin(config.humidity);
+        _pressure.begin(config.pressure);
+    }
+
+    const SensorFilterConfig& getConfig() const { return *_config; }
+
+    /**
+     * Filter a snapshot. Only a new sequence number runs the filter chain,
+     * so this can be called on every loop. Fahrenheit and altitude follow
+     * the filtered temperature and pressure, derived metrics are passed
+     * through unfiltered. An invalid snapshot (sensor offline) resets the
+     * filter state.
+     */
+    const SensorSnapshot& update(const SensorSnapshot& snapshot) {
+        if (!snapshot.valid) {
+            // Sensor offline: start over once it is back, the last accepted
+            // values say nothing about the first new samples
+            if (_snapshot.valid) setConfig(*_config);
+            _snapshot.valid = false;
+            return _snapshot;
+        }
+        if (snapshot.sequence == _snapshot.sequence) return _snapshot;
+        _snapshot = snapshot;
+
+        _snapshot.temperatureC = _temperature.update(snapshot.temperatureC);
+        _snapshot.temperatureF = MySensor::toFahrenheit(_snapshot.temperatureC);
+        _snapshot.humidity = _humidity.update(snapshot.humidity);
+        _snapshot.pressure = _pressure.update(snapshot.pressure);
+        _snapshot.altitude = MyBmeCompensation::altitude(_snapshot.pressure);
+        return _snapshot;
+    }
+
+    /**
+     * Get the latest filtered snapshot.
+     */
+    const SensorSnapshot& get() const { return _snapshot; }
+
+    /**
+     * Print the cost per sample of this filter chain on synthetic noisy
+     * data. Uses a scratch copy, so the live filter state is untouched.
+     */
+    void printBenchmark(uint16_t iterations = 1000) {
+        MySensorFilter filter(*_config);
+        SensorSnapshot s;
+        s.valid = true;
+
+        uint32_t start = ESP.getCycleCount();
+        for (uint16_t i = 0; i < iterations; i++) {
+            s.sequence = i + 1;
+            s.temperatureC = 2150 + (i * 7 % 13) - 6;
+            s.humidity = 4500 + (i * 11 % 17) - 8;
+            s.pressure = 101325 + (i % 50 == 0 ? 900 : (i * 5 % 9) - 4);
+            filter.update(s);
+        }
+        uint32_t cycles = (ESP.getCycleCount() - start) / iterations;
+
+        Serial.printf("Filter '%s': %u cycles/sample (%u µs)\n",
+                      _config->name, cycles, cycles / ESP.getCpuFreqMHz());
+    }
+};
+
+#endif  // _MY_SENSOR_FILTER_H_
@@ -0,0 +1,526 @@
+/**
+ * MySensorHistory.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * In-RAM sensor history with tiered downsampling:
+ * 1 s samples for 10 minutes, 1 minute min/avg/max for 24 hours and
+ * 1 hour min/avg/max for a week. Everything is allocated once in begin()
+ * and stays within a fixed heap budget. Time is counted in seconds since
+ * the first sample, so the millis() wrap after 49.7 days is seamless.
+ * Any tier can be exported as JSON in chunks (see exportJson()).
+ */
+
+#ifndef _MY_SENSOR_HISTORY_H_
+#define _MY_SENSOR_HISTORY_H_
+
+#include <Arduino.h>
+
+#include "MySensor.h"
+
+// Bytes of heap for all tiers. The full spans take 16.1 KB: 3.5 KB of 1 s
+// samples and 12.6 KB of 8 byte minute and hour buckets.
+#define SENSOR_HISTORY_BUDGET (17 * 1024)
+
+#define HISTORY_SECONDS 600  // 10 minutes of 1 s samples
+#define HISTORY_MINUTES 1440  // 24 hours of 1 minute buckets
+#define HISTORY_HOURS 168     // 7 days of 1 hour buckets
+
+#define HISTORY_EMPTY INT16_MIN  // marks a gap (sensor offline)
+#define HISTORY_SPREAD_UNIT 10   // bucket resolution in raw units
+#define HISTORY_ROW_SIZE 80      // longest row of a JSON export
+
+/**
+ * One channel value, encoded into 16 bits:
+ * temperature in 0.01 °C, humidity in 0.01 %RH, pressure in Pa - 100000.
+ */
+struct HistorySample {
+    int16_t temperature;
+    int16_t humidity;
+    int16_t pressure;
+};
+
+/**
+ * Average of a bucket, rounded to HISTORY_SPREAD_UNIT (0.1 °C, 0.1 %RH,
+ * 10 Pa), plus its distance to the minimum and maximum in that unit,
+ * rounded outwards.
+ */
+struct HistoryChannel {
+    int16_t avg;
+    uint8_t below;
+    uint8_t above;
+
+    int16_t low() const { return avg - below * HISTORY_SPREAD_UNIT; }
+    int16_t high() const { return avg + above * HISTORY_SPREAD_UNIT; }
+};
+
+/**
+ * A minute or hour bucket packed into 64 bits. Per channel the average in
+ * HISTORY_SPREAD_UNIT steps above the channel minimum (all ones for a gap)
+ * and the distances to the minimum and maximum as 5 bit spread codes:
+ *
+ *   temperature  11 + 5 + 5 bits  -100.0 .. 104.6 °C
+ *   humidity     10 + 5 + 5 bits     0.0 .. 102.2 %RH
+ *   pressure     13 + 5 + 5 bits  every encoded pressure
+ *
+ * Spreads take 1 unit steps up to 15 units and 4 unit steps up to 79 units
+ * (7.9 °C, 7.9 %RH, 790 Pa), rounded up.
+ */
+struct HistoryBucket {
+    uint64_t bits;
+
+    static uint8_t spreadCode(uint8_t units) {
+        if (units <= 15) return units;
+        return min(31, 15 + (units - 15 + 3) / 4);
+    }
+
+    static uint8_t spreadUnits(uint8_t code) {
+        return code <= 15 ? code : 15 + (code - 15) * 4;
+    }
+
+    /**
+     * @param c channel whose average is a multiple of HISTORY_SPREAD_UNIT
+     */
+    static uint32_t packChannel(const HistoryChannel& c, uint8_t width,
+                                int16_t minimum) {
+        uint32_t gap = (1UL << width) - 1;
+        uint32_t avg = gap;
+        if (c.avg != HISTORY_EMPTY) {
+            avg = constrain((int32_t)(c.avg / HISTORY_SPREAD_UNIT - minimum),
+                            (int32_t)0, (int32_t)gap - 1);
+        }
+        return avg | (uint32_t)spreadCode(c.below) << width |
+               (uint32_t)spreadCode(c.above) << (width + 5);
+    }
+
+    static HistoryChannel unpackChannel(uint64_t bits, uint8_t width,
+                                        int16_t minimum) {
+        uint32_t gap = (1UL << width) - 1;
+        uint32_t avg = bits & gap;
+        if (avg == gap) return {HISTORY_EMPTY, 0, 0};
+        return {(int16_t)(((int32_t)avg + minimum) * HISTORY_SPREAD_UNIT),
+                spreadUnits(bits >> width & 31),
+                spreadUnits(bits >> (width + 5) & 31)};
+    }
+
+    static HistoryBucket pack(const HistoryChannel& temperature,
+                              const HistoryChannel& humidity,
+                              const HistoryChannel& pressure) {
+        return {packChannel(temperature, 11, -1000) |
+                (uint64_t)packChannel(humidity, 10, 0) << 21 |
+                (uint64_t)packChannel(pressure, 13, -4095) << 41};
+    }
+
+    HistoryChannel temperature() const { return unpackChannel(bits, 11, -1000); }
+    HistoryChannel humidity() const { return unpackChannel(bits >> 21, 10, 0); }
+    HistoryChannel pressure() const { return unpackChannel(bits >> 41, 13, -4095); }
+};
+
+enum HistoryTier : uint8_t {
+    HISTORY_TIER_SECONDS,
+    HISTORY_TIER_MINUTES,
+    HISTORY_TIER_HOURS,
+};
+
+/**
+ * Where a JSON export of a tier stands between two chunks.
+ */
+struct HistoryExport {
+    HistoryTier tier;
+    uint32_t next;  // number of the next row, see MyRing::pushed()
+    uint32_t end;   // one past the newest row at the start of the export
+    uint32_t rows;  // written so far
+    uint8_t part;   // 0: header, 1: rows, 2: footer, 3: done
+};
+
+/**
+ * Fixed capacity ring buffer on a single heap block, freed with the ring.
+ * The newest entry overwrites the oldest once full.
+ */
+template <typename T>
+class MyRing {
+   private:
+    T* _data = nullptr;
+    uint16_t _capacity = 0;
+    uint16_t _head = 0;  // next write position
+    uint16_t _count = 0;
+    uint32_t _pushed = 0;
+
+   public:
+    MyRing() {}
+    MyRing(const MyRing&) = delete;  // owns its block
+    MyRing& operator=(const MyRing&) = delete;
+
+    ~MyRing() { free(_data); }
+
+    bool begin(uint16_t capacity) {
+        free(_data);
+        _data = (T*)malloc(sizeof(T) * capacity);
+        _capacity = _data ? capacity : 0;
+        _head = _count = 0;
+        _pushed = 0;
+        return _data != nullptr;
+    }
+
+    void push(const T& value) {
+        if (!_capacity) return;
+        _data[_head] = value;
+        _head = (_head + 1) % _capacity;
+        if (_count < _capacity) _count++;
+        _pushed++;
+    }
+
+    /**
+     * Get an entry by age, 0 being the oldest.
+     */
+    const T& at(uint16_t i) const {
+        return _data[(_head + _capacity - _count + i) % _capacity];
+    }
+
+    /**
+     * Entries pushed since begin(). The oldest entry still held is number
+     * pushed() - size(), so entries can be told apart while others move on.
+     */
+    uint32_t pushed() const { return _pushed; }
+
+    uint16_t size() const { return _count; }
+    uint16_t capacity() const { return _capacity; }
+    size_t bytes() const { return sizeof(T) * _capacity; }
+};
+
+class MySensorHistory {
+   private:
+    /**
+     * Running min/sum/max of one channel for the bucket being filled.
+     */
+    struct Accumulator {
+        int32_t sum;
+        int16_t lo;
+        int16_t hi;
+
+        void add(int16_t avg, int16_t low, int16_t high, uint16_t count) {
+            if (count == 0) {
+                sum = 0;
+                lo = low;
+                hi = high;
+            }
+            sum += avg;
+            if (low < lo) lo = low;
+            if (high > hi) hi = high;
+        }
+
+        HistoryChannel get(uint16_t count) const {
+            HistoryChannel c;
+            int32_t avg = sum / (int32_t)count;
+            avg = (avg + (avg < 0 ? -HISTORY_SPREAD_UNIT : HISTORY_SPREAD_UNIT) / 2) /
+                  HISTORY_SPREAD_UNIT * HISTORY_SPREAD_UNIT;
+            c.avg = constrain(avg, (int32_t)-32760, (int32_t)32760);
+            int32_t below = (c.avg - lo + HISTORY_SPREAD_UNIT - 1) / HISTORY_SPREAD_UNIT;
+            int32_t above = (hi - c.avg + HISTORY_SPREAD_UNIT - 1) / HISTORY_SPREAD_UNIT;
+            c.below = below > 255 ? 255 : below;
+            c.above = above > 255 ? 255 : above;
+            return c;
+        }
+    };
+
+    /**
+     * The bucket currently being filled for the minute or hour tier.
+     */
+    struct Tier {
+        Accumulator temperature, humidity, pressure;
+        uint16_t count = 0;
+        uint32_t time = 0;  // minute or hour number of this bucket
+
+        void add(const HistoryChannel& t, const HistoryChannel& h,
+                 const HistoryChannel& p) {
+            temperature.add(t.avg, t.low(), t.high(), count);
+            humidity.add(h.avg, h.low(), h.high(), count);
+            pressure.add(p.avg, p.low(), p.high(), count);
+            count++;
+        }
+
+        HistoryBucket get() const {
+            return HistoryBucket::pack(temperature.get(count), humidity.get(count),
+                                       pressure.get(count));
+        }
+    };
+
+    size_t _budget;
+    MyRing<HistorySample> _seconds;
+    MyRing<HistoryBucket> _minutes;
+    MyRing<HistoryBucket> _hours;
+    uint32_t _second = 0;           // second number of the newest raw sample
+    unsigned long _secondMillis = 0;  // millis() at which _second began
+    Tier _minute;
+    Tier _hour;
+    bool _started = false;
+
+    static int16_t clamp16(int32_t v) {
+        return constrain(v, (int32_t)INT16_MIN + 1, (int32_t)INT16_MAX);
+    }
+
+    /**
+     * Close the bucket of a tier when `time` has moved past it. Buckets
+     * without data, including any skipped ones, are stored as gaps.
+     * @param closed receives the closed bucket
+     * @return true if a bucket with data was closed
+     */
+    static bool close(Tier& tier, MyRing<HistoryBucket>& ring, uint32_t time,
+                      HistoryBucket& closed) {
+        if (time == tier.time) return false;
+
+        const HistoryChannel gap = {HISTORY_EMPTY, 0, 0};
+        const HistoryBucket empty = HistoryBucket::pack(gap, gap, gap);
+        bool hasData = tier.count > 0;
+        closed = hasData ? tier.get() : empty;
+        ring.push(closed);
+
+        // Gaps longer than the ring only need to clear it once
+        uint32_t skipped = time - tier.time - 1;
+        if (skipped > ring.capacity()) skipped = ring.capacity();
+        for (uint32_t i = 0; i < skipped; i++) ring.push(empty);
+
+        tier.count = 0;
+        tier.time = time;
+        return hasData;
+    }
+
+    /**
+     * Format row `n` of the exported tier, preceded by a comma unless it is
+     * the first one written.
+     * @return its length, as snprintf()
+     */
+    int formatRow(const HistoryExport& e, uint32_t n, char* row,
+                  size_t size) const {
+        const char* comma = e.rows ? "," : "";
+        if (e.tier == HISTORY_TIER_SECONDS) {
+            const HistorySample& s = _seconds.at(n - (_seconds.pushed() - _seconds.size()));
+            if (s.temperature == HISTORY_EMPTY) return snprintf(row, size, "%snull", comma);
+            return snprintf(row, size, "%s[%d,%d,%ld]", comma, s.temperature,
+                            s.humidity, s.pressure + 100000L);
+        }
+
+        const MyRing<HistoryBucket>& ring = e.tier == HISTORY_TIER_MINUTES ? _minutes : _hours;
+        const HistoryBucket& b = ring.at(n - (ring.pushed() - ring.size()));
+        HistoryChannel t = b.temperature();
+        HistoryChannel h = b.humidity();
+        HistoryChannel p = b.pressure();
+        if (t.avg == HISTORY_EMPTY) return snprintf(row, size, "%snull", comma);
+        return snprintf(row, size, "%s[%d,%d,%d,%d,%d,%d,%ld,%ld,%ld]", comma,
+                        t.avg, t.low(), t.high(), h.avg, h.low(), h.high(),
+                        p.avg + 100000L, p.low() + 100000L, p.high() + 100000L);
+    }
+
+   public:
+    MySensorHistory(size_t budget = SENSOR_HISTORY_BUDGET) : _budget(budget) {}
+
+    /**
+     * Allocate all tiers. The 1 s tier is always complete, the sparkline
+     * shows most of it. If the minute and hour tiers do not fit into the
+     * rest of the budget, both are shortened by the same factor.
+     */
+    bool begin() {
+        size_t seconds = HISTORY_SECONDS * sizeof(HistorySample);
+        size_t buckets = (HISTORY_MINUTES + HISTORY_HOURS) * sizeof(HistoryBucket);
+        size_t left = _budget > seconds ? _budget - seconds : 0;
+        uint32_t scale = (uint64_t)left * 1024 / buckets;  // 1/1024 steps
+        if (scale > 1024) scale = 1024;
+
+        auto capacity = [scale](uint32_t full) -> uint16_t {
+            return max<uint32_t>(1, full * scale / 1024);
+        };
+        bool ok = _seconds.begin(HISTORY_SECONDS) &&
+                  _minutes.begin(capacity(HISTORY_MINUTES)) &&
+                  _hours.begin(capacity(HISTORY_HOURS));
+        if (!ok) {
+            Serial.println("[History] ERROR: Failed to allocate history");
+        }
+        return ok;
+    }
+
+    /**
+     * Encode a snapshot into the compact 16 bit sample format.
+     */
+    static HistorySample encode(const SensorSnapshot& snapshot) {
+        return {clamp16(snapshot.temperatureC), clamp16(snapshot.humidity),
+                clamp16(snapshot.pressure - 100000)};
+    }
+
+    /**
+     * Record a snapshot. At most one sample per second is kept; faster
+     * profiles are thinned out, slower ones leave gaps in the 1 s tier.
+     */
+    void add(const SensorSnapshot& snapshot) {
+        if (!snapshot.valid) return;
+
+        // Whole seconds since the last kept sample, across the millis() wrap
+        uint32_t elapsed = (uint32_t)(snapshot.millis - _secondMillis) / 1000;
+        if (_started && elapsed == 0) return;
+        uint32_t second = _started ? _second + elapsed : snapshot.millis / 1000;
+        _secondMillis = _started ? _secondMillis + elapsed * 1000
+                                 : second * 1000;
+
+        HistorySample s = encode(snapshot);
+
+        if (_started) {
+            uint32_t skipped = second - _second - 1;
+            if (skipped > _seconds.capacity()) skipped = _seconds.capacity();
+            for (uint32_t i = 0; i < skipped; i++) {
+                _seconds.push({HISTORY_EMPTY, HISTORY_EMPTY, HISTORY_EMPTY});
+            }
+
+            uint32_t minute = _minute.time;
+            HistoryBucket b;
+            if (close(_minute, _minutes, second / 60, b)) {
+                HistoryBucket unused;
+                close(_hour, _hours, minute / 60, unused);
+                _hour.add(b.temperature(), b.humidity(), b.pressure());
+            }
+        } else {
+            _minute.time = second / 60;
+            _hour.time = second / 3600;
+            _started = true;
+        }
+
+        _second = second;
+        _seconds.push(s);
+        HistoryChannel t = {s.temperature, 0, 0};
+        HistoryChannel h = {s.humidity, 0, 0};
+        HistoryChannel p = {s.pressure, 0, 0};
+        _minute.add(t, h, p);
+    }
+
+    const MyRing<HistorySample>& getSeconds() const { return _seconds; }
+
+    /**
+     * Second number of the newest entry in getSeconds(). Starts at
+     * millis() / 1000 of the first sample and keeps counting across the
+     * millis() wrap.
+     */
+    uint32_t getLastSecond() const { return _second; }
+
+    const MyRing<HistoryBucket>& getMinutes() const { return _minutes; }
+    const MyRing<HistoryBucket>& getHours() const { return _hours; }
+
+    /**
+     * Entries held by a tier.
+     */
+    uint16_t getTier(HistoryTier tier) const {
+        switch (tier) {
+            case HISTORY_TIER_SECONDS:
+                return _seconds.size();
+            case HISTORY_TIER_MINUTES:
+                return _minutes.size();
+            default:
+                return _hours.size();
+        }
+    }
+
+    static const char* getTierName(HistoryTier tier) {
+        static const char* const names[] = {"seconds", "minutes", "hours"};
+        return names[tier];
+    }
+
+    /**
+     * Look up a tier by its name ("seconds", "minutes" or "hours").
+     * @return false if there is none
+     */
+    static bool parseTier(const char* name, HistoryTier& tier) {
+        for (uint8_t i = HISTORY_TIER_SECONDS; i <= HISTORY_TIER_HOURS; i++) {
+            if (strcmp(name, getTierName((HistoryTier)i)) == 0) {
+                tier = (HistoryTier)i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Start an export of the entries a tier holds now, see exportJson().
+     */
+    HistoryExport beginExport(HistoryTier tier) const {
+        uint32_t end = tier == HISTORY_TIER_SECONDS ? _seconds.pushed()
+                       : tier == HISTORY_TIER_MINUTES ? _minutes.pushed()
+                                                      : _hours.pushed();
+        return {tier, end - getTier(tier), end, 0, 0};
+    }
+
+    /**
+     * Write the next chunk of an export into `buffer`, in whole rows:
+     *
+     *   {"tier":"minutes","step":60,"rows":[[2030,2000,2060,4500,...],null]}
+     *
+     * Rows run from the oldest entry to the newest, `step` seconds apart,
+     * null for a gap. A 1 s row is temperature (0.01 °C), humidity
+     * (0.01 %RH) and pressure (Pa); a bucket row is the average, minimum
+     * and maximum of each. Entries added meanwhile are left out, entries
+     * overwritten meanwhile are skipped, so the tiers keep running while a
+     * web server sends the export piece by piece.
+     * @param size at least HISTORY_ROW_SIZE
+     * @return bytes written, 0 once the export is complete
+     */
+    size_t exportJson(HistoryExport& e, char* buffer, size_t size) const {
+        static const uint16_t steps[] = {1, 60, 3600};
+        char row[HISTORY_ROW_SIZE];
+        size_t length = 0;
+        while (e.part < 3) {
+            int n;
+            if (e.part == 0) {
+                n = snprintf(row, sizeof(row), "{\"tier\":\"%s\",\"step\":%u,\"rows\":[",
+                             getTierName(e.tier), (unsigned)steps[e.tier]);
+            } else if (e.part == 1) {
+                HistoryExport now = beginExport(e.tier);
+                if (e.next < now.next) e.next = now.next;
+                if (e.next >= e.end) {
+                    e.part = 2;
+                    continue;
+                }
+                n = formatRow(e, e.next, row, sizeof(row));
+            } else {
+                n = snprintf(row, sizeof(row), "]}");
+            }
+            if (length + n > size) break;
+            memcpy(buffer + length, row, n);
+            length += n;
+            if (e.part == 1) {
+                e.next++;
+                e.rows++;
+            } else {
+                e.part++;
+            }
+        }
+        return length;
+    }
+
+    /**
+     * Heap used by all tiers in bytes.
+     */
+    size_t getFootprint() const {
+        return _seconds.bytes() + _minutes.bytes() + _hours.bytes();
+    }
+
+    /**
+     * Print the memory footprint and fill level of every tier to the Serial
+     * Monitor.
+     */
+    void printFootprint() {
+        // Spans in tenths
+        unsigned hours = _minutes.capacity() * 10 / 60;
+        unsigned days = _hours.capacity() * 10 / 24;
+        Serial.println("Sensor History:");
+        Serial.printf("1 s tier:   %4u/%4u samples, %5u B (%u min)\n",
+                      _seconds.size(), _seconds.capacity(), (unsigned)_seconds.bytes(),
+                      _seconds.capacity() / 60);
+        Serial.printf("1 min tier: %4u/%4u buckets, %5u B (%u.%u h)\n",
+                      _minutes.size(), _minutes.capacity(), (unsigned)_minutes.bytes(),
+                      hours / 10, hours % 10);
+        Serial.printf("1 h tier:   %4u/%4u buckets, %5u B (%u.%u d)\n",
+                      _hours.size(), _hours.capacity(), (unsigned)_hours.bytes(),
+                      days / 10, days % 10);
+        Serial.printf("Total: %u of %u B budget, free heap %u B\n",
+                      (unsigned)getFootprint(), (unsigned)_budget,
+                      (unsigned)ESP.getFreeHeap());
+        Serial.println();
+    }
+};
+
+#endif  // _MY_SENSOR_HISTORY_H_
@@ -0,0 +1,456 @@
+/**
+ * MySensorLog.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Persistent, append-only sensor log on LittleFS.
+ *
+ * The log is split into segment files (/log/00000001.bin, ...). A segment is
+ * a sequence of self-contained blocks, one per flush:
+ *
+ *   marker 'L' | length u16 | count u16 | first u32 | last u32 | sample
+ *   followed by `length` bytes of records
+ *
+ * The first sample is stored verbatim in the block header. Every following
+ * record holds the delta-of-delta of its timestamp (zigzag varint) and each
+ * channel XORed with the previous value (varint). A block that was cut short
+ * by a reset fails its length check and ends the segment.
+ *
+ * A LogCursor remembers a read position that survives a reboot, so a reader
+ * that consumes the log piecewise does not start over at the oldest block
+ * for every piece.
+ */
+
+#ifndef _MY_SENSOR_LOG_H_
+#define _MY_SENSOR_LOG_H_
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <functional>
+
+#include "MyFormat.h"
+#include "MySensorHistory.h"
+
+#define SENSOR_LOG_DIR "/log"
+#define SENSOR_LOG_INTERVAL 10          // s between logged samples
+#define SENSOR_LOG_FLUSH_INTERVAL 600   // s, max. age of buffered samples
+#define SENSOR_LOG_BLOCK_SIZE 512       // bytes of records per block
+#define SENSOR_LOG_SEGMENT_SIZE 32768   // bytes per segment file
+#define SENSOR_LOG_SEGMENTS 16          // segments kept before rotating
+
+#define SENSOR_LOG_MARKER 'L'
+#define SENSOR_LOG_HEADER_SIZE 19
+#define SENSOR_LOG_RECORD_MAX 14  // 5 byte timestamp + 3 x 3 byte values
+#define SENSOR_LOG_MIN_EPOCH 1600000000  // ignore samples before NTP sync
+
+/**
+ * Read position in the log: the block to decode next and the epoch of the
+ * last sample read. Blocks are delta coded, so a block that was only partly
+ * read is decoded again and its samples up to `epoch` are skipped. Segment 0
+ * means the oldest segment.
+ */
+struct LogCursor {
+    uint32_t segment;
+    uint32_t offset;  // B into the segment
+    uint32_t epoch;
+};
+
+class MySensorLog {
+   private:
+    typedef std::function<void(uint32_t epoch, const HistorySample& sample)>
+        ScanCallback;
+    // Returns false to skip the sample
+    typedef std::function<bool(uint32_t epoch, const HistorySample& sample)>
+        ReadCallback;
+
+    // Segment numbers of the oldest and newest file, 0 if there are none
+    uint32_t _firstSegment = 0;
+    uint32_t _lastSegment = 0;
+
+    // Block being assembled in RAM
+    uint8_t _buffer[SENSOR_LOG_BLOCK_SIZE];
+    uint16_t _length = 0;
+    uint16_t _count = 0;
+    uint32_t _first = 0;
+    HistorySample _firstSample;
+    uint32_t _last = 0;
+    int32_t _lastDelta = 0;
+    HistorySample _lastSample;
+
+    // Statistics since boot
+    uint32_t _samples = 0;
+    uint32_t _bytesWritten = 0;
+    uint32_t _flushes = 0;
+    uint32_t _flushTime = 0;  // µs, last flush
+
+    static String segmentPath(uint32_t segment) {
+        char path[24];
+        snprintf(path, sizeof(path), SENSOR_LOG_DIR "/%08u.bin", segment);
+        return String(path);
+    }
+
+    static uint8_t putVarint(uint8_t* buf, uint32_t value) {
+        uint8_t n = 0;
+        while (value >= 0x80) {
+            buf[n++] = value | 0x80;
+            value >>= 7;
+        }
+        buf[n++] = value;
+        return n;
+    }
+
+    static bool getVarint(const uint8_t* buf, uint16_t length, uint16_t& pos,
+                          uint32_t& value) {
+        value = 0;
+        for (uint8_t shift = 0; pos < length && shift < 35; shift += 7) {
+            uint8_t b = buf[pos++];
+            value |= (uint32_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    static void put16(uint8_t* buf, uint16_t v) {
+        buf[0] = v;
+        buf[1] = v >> 8;
+    }
+
+    static void put32(uint8_t* buf, uint32_t v) {
+        put16(buf, v);
+        put16(buf + 2, v >> 16);
+    }
+
+    static uint16_t get16(const uint8_t* buf) { return buf[0] | buf[1] << 8; }
+
+    static uint32_t get32(const uint8_t* buf) {
+        return get16(buf) | (uint32_t)get16(buf + 2) << 16;
+    }
+
+    /**
+     * Find the existing segments after a reboot.
+     */
+    void findSegments() {
+        _firstSegment = 0;
+        _lastSegment = 0;
+
+        Dir dir = LittleFS.openDir(SENSOR_LOG_DIR);
+        while (dir.next()) {
+            uint32_t segment = strtoul(dir.fileName().c_str(), nullptr, 10);
+            if (!segment) continue;
+            if (!_firstSegment || segment < _firstSegment) _firstSegment = segment;
+            if (segment > _lastSegment) _lastSegment = segment;
+        }
+    }
+
+    /**
+     * Start a new segment if the current one is full and drop the oldest
+     * segments beyond SENSOR_LOG_SEGMENTS.
+     */
+    void rotate(size_t blockSize) {
+        if (_lastSegment) {
+            File file = LittleFS.open(segmentPath(_lastSegment), "r");
+            size_t size = file ? file.size() : 0;
+            file.close();
+            if (size + blockSize <= SENSOR_LOG_SEGMENT_SIZE) return;
+        }
+
+        _lastSegment++;
+        if (!_firstSegment) _firstSegment = _lastSegment;
+
+        while (_lastSegment - _firstSegment >= SENSOR_LOG_SEGMENTS) {
+            LittleFS.remove(segmentPath(_firstSegment));
+            _firstSegment++;
+        }
+    }
+
+    /**
+     * Decode one block and pass every sample inside [from, to] on, until
+     * `left` samples were taken.
+     */
+    static void decodeBlock(const uint8_t* header, const uint8_t* records,
+                            uint16_t length, uint32_t from, uint32_t to,
+                            ReadCallback callback, uint32_t& left) {
+        uint16_t count = get16(header + 3);
+        uint32_t time = get32(header + 5);
+        HistorySample s = {(int16_t)get16(header + 13),
+                           (int16_t)get16(header + 15),
+                           (int16_t)get16(header + 17)};
+        int32_t delta = 0;
+        uint16_t pos = 0;
+
+        for (uint16_t i = 0; i < count; i++) {
+            if (i > 0) {
+                uint32_t dod, t, h, p;
+                if (!getVarint(records, length, pos, dod) ||
+                    !getVarint(records, length, pos, t) ||
+                    !getVarint(records, length, pos, h) ||
+                    !getVarint(records, length, pos, p)) {
+                    return;
+                }
+                delta += (int32_t)(dod >> 1) ^ -(int32_t)(dod & 1);
+                time += delta;
+                s.temperature ^= t;
+                s.humidity ^= h;
+                s.pressure ^= p;
+            }
+            if (time > to || !left) return;
+            if (time >= from && callback(time, s)) left--;
+        }
+    }
+
+    /**
+     * Header fields of the block in RAM, for decodeBlock().
+     */
+    void bufferHeader(uint8_t* header) const {
+        put16(header + 3, _count);
+        put32(header + 5, _first);
+        put16(header + 13, _firstSample.temperature);
+        put16(header + 15, _firstSample.humidity);
+        put16(header + 17, _firstSample.pressure);
+    }
+
+   public:
+    /**
+     * Prepare the log directory and pick up existing segments.
+     */
+    void begin() {
+        if (!LittleFS.exists(SENSOR_LOG_DIR)) LittleFS.mkdir(SENSOR_LOG_DIR);
+        findSegments();
+        Serial.printf("[Log] %u segment(s) on LittleFS\n",
+                      _lastSegment ? _lastSegment - _firstSegment + 1 : 0);
+    }
+
+    /**
+     * Append a snapshot to the RAM block. Only one sample every
+     * SENSOR_LOG_INTERVAL seconds is kept, and only once the clock is synced.
+     * The block goes to flash when it is full or SENSOR_LOG_FLUSH_INTERVAL
+     * has passed.
+     */
+    void add(const SensorSnapshot& snapshot) {
+        uint32_t epoch = snapshot.epoch;
+        if (!snapshot.valid || epoch < SENSOR_LOG_MIN_EPOCH) return;
+        if (_last && epoch - _last < SENSOR_LOG_INTERVAL) return;
+
+        HistorySample s = MySensorHistory::encode(snapshot);
+        _samples++;
+
+        if (_count == 0) {
+            _first = epoch;
+            _firstSample = s;
+            _lastDelta = 0;
+        } else {
+            int32_t delta = epoch - _last;
+            int32_t dod = delta - _lastDelta;
+            _length += putVarint(_buffer + _length, (uint32_t)dod << 1 ^ (uint32_t)(dod >> 31));
+            _length += putVarint(_buffer + _length, (uint16_t)(s.temperature ^ _lastSample.temperature));
+            _length += putVarint(_buffer + _length, (uint16_t)(s.humidity ^ _lastSample.humidity));
+            _length += putVarint(_buffer + _length, (uint16_t)(s.pressure ^ _lastSample.pressure));
+            _lastDelta = delta;
+        }
+        _count++;
+        _last = epoch;
+        _lastSample = s;
+
+        if (_length + SENSOR_LOG_RECORD_MAX > SENSOR_LOG_BLOCK_SIZE ||
+            _last - _first >= SENSOR_LOG_FLUSH_INTERVAL) {
+            flush();
+        }
+    }
+
+    /**
+     * Write the buffered block to the newest segment in a single append.
+     */
+    void flush() {
+        if (_count == 0) return;
+        uint32_t start = micros();
+
+        uint8_t header[SENSOR_LOG_HEADER_SIZE];
+        header[0] = SENSOR_LOG_MARKER;
+        put16(header + 1, _length);
+        put16(header + 3, _count);
+        put32(header + 5, _first);
+        put32(header + 9, _last);
+        put16(header + 13, _firstSample.temperature);
+        put16(header + 15, _firstSample.humidity);
+        put16(header + 17, _firstSample.pressure);
+
+        rotate(sizeof(header) + _length);
+        File file = LittleFS.open(segmentPath(_lastSegment), "a");
+        if (!file) {
+            Serial.println("[Log] ERROR: Failed to open segment for writing");
+        } else {
+            file.write(header, sizeof(header));
+            file.write(_buffer, _length);
+            file.close();
+            _bytesWritten += sizeof(header) + _length;
+            _flushes++;
+        }
+
+        _count = 0;
+        _length = 0;
+        _flushTime = micros() - start;
+    }
+
+    /**
+     * Stream all samples with an epoch in [from, to] to `callback`, oldest
+     * first, or only the first `limit` of them. Blocks outside the range are
+     * skipped without being read, and at most one block is held in RAM.
+     * Samples still buffered in RAM are included.
+     * @return number of samples passed on
+     */
+    uint32_t scan(uint32_t from, uint32_t to, ScanCallback callback,
+                  uint32_t limit = UINT32_MAX) {
+        uint8_t header[SENSOR_LOG_HEADER_SIZE];
+        uint8_t* records = (uint8_t*)malloc(SENSOR_LOG_BLOCK_SIZE);
+        if (!records) return 0;
+        uint32_t left = limit;
+        ReadCallback take = [&](uint32_t epoch, const HistorySample& s) {
+            callback(epoch, s);
+            return true;
+        };
+
+        for (uint32_t segment = _firstSegment;
+             _firstSegment && segment <= _lastSegment && left; segment++) {
+            File file = LittleFS.open(segmentPath(segment), "r");
+            if (!file) continue;
+
+            while (left && file.read(header, sizeof(header)) == sizeof(header) &&
+                   header[0] == SENSOR_LOG_MARKER) {
+                uint16_t length = get16(header + 1);
+                if (length > SENSOR_LOG_BLOCK_SIZE) break;
+
+                if (get32(header + 9) < from || get32(header + 5) > to) {
+                    if (!file.seek(file.position() + length)) break;
+                    continue;
+                }
+                if (file.read(records, length) != length) break;
+                decodeBlock(header, records, length, from, to, take, left);
+            }
+            file.close();
+        }
+        free(records);
+
+        if (left && _count && _last >= from && _first <= to) {
+            bufferHeader(header);
+            decodeBlock(header, _buffer, _length, from, to, take, left);
+        }
+        return limit - left;
+    }
+
+    /**
+     * Cursor for the samples after `epoch` when that is about now: it starts
+     * at the newest segment, which holds them or will, instead of the oldest.
+     */
+    LogCursor recent(uint32_t epoch) const { return {_lastSegment, 0, epoch}; }
+
+    /**
+     * Continue reading at `cursor`: pass the samples after cursor.epoch up
+     * to `to` to `callback`, oldest first, until it took `limit` of them,
+     * and move the cursor behind them. A sample the callback skips does not
+     * count, the cursor moves past it all the same. Starts at the block the
+     * cursor points to, so a call only reads the blocks its samples are in.
+     * A cursor whose segment was rotated away continues at the oldest one.
+     * Samples still buffered in RAM are included.
+     * @return number of samples taken
+     */
+    uint32_t read(LogCursor& cursor, uint32_t to, ReadCallback callback,
+                  uint32_t limit) {
+        uint8_t header[SENSOR_LOG_HEADER_SIZE];
+        uint8_t* records = (uint8_t*)malloc(SENSOR_LOG_BLOCK_SIZE);
+        if (!records) return 0;
+        uint32_t left = limit;
+        bool more = true;  // nothing after `to` seen yet
+        ReadCallback take = [&](uint32_t epoch, const HistorySample& s) {
+            cursor.epoch = epoch;
+            return callback(epoch, s);
+        };
+
+        if (cursor.segment < _firstSegment) {
+            cursor.segment = _firstSegment;
+            cursor.offset = 0;
+        }
+        while (_firstSegment && cursor.segment <= _lastSegment && left && more) {
+            File file = LittleFS.open(segmentPath(cursor.segment), "r");
+            if (file && file.seek(cursor.offset)) {
+                while (left && file.read(header, sizeof(header)) == sizeof(header) &&
+                       header[0] == SENSOR_LOG_MARKER) {
+                    uint16_t length = get16(header + 1);
+                    if (length > SENSOR_LOG_BLOCK_SIZE) break;
+                    if (get32(header + 5) > to) {
+                        more = false;
+                        break;
+                    }
+                    if (get32(header + 9) > cursor.epoch) {
+                        if (file.read(records, length) != length) break;
+                        decodeBlock(header, records, length, cursor.epoch + 1,
+                                    to, take, left);
+                        // Partly read: decode it again next time
+                        if (get32(header + 9) > cursor.epoch) {
+                            more = false;
+                            break;
+                        }
+                    }
+                    cursor.offset += sizeof(header) + length;
+                    if (!file.seek(cursor.offset)) break;
+                }
+            }
+            file.close();
+            if (!more || !left || cursor.segment == _lastSegment) break;
+            cursor.segment++;
+            cursor.offset = 0;
+        }
+        free(records);
+
+        if (left && more && _count && _last > cursor.epoch && _first <= to) {
+            bufferHeader(header);
+            decodeBlock(header, _buffer, _length, cursor.epoch + 1, to, take, left);
+        }
+        return limit - left;
+    }
+
+    /**
+     * Print the samples with an epoch in [from, to] as CSV to the Serial
+     * Monitor, in °C, %RH and hPa.
+     */
+    void printRange(uint32_t from, uint32_t to) {
+        Serial.println("epoch,temperature,humidity,pressure");
+        uint32_t count = 0;
+        scan(from, to, [&count](uint32_t epoch, const HistorySample& s) {
+            char temperature[16];
+            char humidity[16];
+            char pressure[16];
+            Serial.printf("%u,%s,%s,%s\n", epoch,
+                          MyFormat::centi(s.temperature, temperature, sizeof(temperature)),
+                          MyFormat::centi(s.humidity, humidity, sizeof(humidity)),
+                          MyFormat::centi(s.pressure + 100000, pressure, sizeof(pressure)));
+            count++;
+        });
+        Serial.printf("[Log] %u sample(s) from %u to %u\n", count, from, to);
+    }
+
+    /**
+     * Print compression and flash write statistics to the Serial Monitor.
+     * Raw size is 10 bytes per sample (u32 epoch + 3 x i16). Flash wear is
+     * driven by the number of appends, as LittleFS copies the partial last
+     * block of a file on every append.
+     */
+    void printStats() {
+        Serial.println("Sensor Log:");
+        Serial.printf("Segments: %u-%u, %u samples logged since boot\n",
+                      _firstSegment, _lastSegment, _samples);
+        Serial.printf("Buffered: %u samples, %u B\n", _count, _length);
+        uint32_t flushed = _samples - _count;
+        if (flushed) {
+            Serial.printf("Bytes/sample: %u.%02u (raw 10)\n",
+                          _bytesWritten / flushed,
+                          _bytesWritten * 100 / flushed % 100);
+        }
+        if (_flushes) {
+            Serial.printf("Appends: %u, %u B each, %u samples each, last took %u µs\n",
+                          _flushes, _bytesWritten / _flushes, flushed / _flushes,
+                          _flushTime);
+        }
+        Serial.println();
+    }
+};
+
+#endif  // _MY_SENSOR_LOG_H_
@@ -6,20 +6,160 @@
 #ifndef _MY_SENSOR_WEBSERVER_H_
 #define _MY_SENSOR_WEBSERVER_H_
 
+#include <ArduinoJson.h>
 #include <ESPAsyncTCP.h>
 #include <ESPAsyncWebServer.h>
 #include <LittleFS.h>
 #include <Updater.h>
 
+#include "MySensor.h"
+#include "MySensorHistory.h"
+#include "MyTelemetryCodec.h"
+
+#define EVENTS_CLIENTS_MAX 4         // SSE clients, more are turned away
+#define EVENTS_QUEUE_MAX SSE_MAX_QUEUED_MESSAGES  // per client, platformio.ini
+#define EVENTS_STALL_TIMEOUT 30000   // ms a client may stay backed up
+
+/**
+ * An event stream client. While its queue is full AsyncEventSource drops
+ * new samples for it; each sample replaces the last, so it continues with
+ * the latest one.
+ */
+struct EventClient {
+    AsyncEventSourceClient* client = nullptr;
+    unsigned long backedUpSince = 0;  // millis(), 0 while it keeps up
+    uint32_t sent = 0;
+    uint32_t skipped = 0;
+};
+
 class MySensorWebserver {
    private:
+    MySensor& _sensor;
+    const MySensorHistory& _history;
     AsyncWebServer* _server;
     AsyncEventSource* _events;
     unsigned long lastEventSend = 0;
+    TelemetryEncoding _encoding = TELEMETRY_JSON;
+
+    // One sample, formatted once for all clients
+    char _event[TELEMETRY_JSON_SIZE];
+    EventClient _clients[EVENTS_CLIENTS_MAX];
+
+    // Event statistics
+    uint32_t _idle = 0;       // samples not formatted, nobody listening
+    uint32_t _broadcasts = 0;
+    uint32_t _skipped = 0;    // per client, queue full
+    uint32_t _rejected = 0;   // clients over EVENTS_CLIENTS_MAX
+    uint32_t _closed = 0;     // clients stalled for EVENTS_STALL_TIMEOUT
+    uint32_t _formatTime = 0; // µs, last sample
+
+    EventClient* findClient(AsyncEventSourceClient* client) {
+        for (EventClient& c : _clients) {
+            if (c.client == client) return &c;
+        }
+        return nullptr;
+    }
+
+    void addClient(AsyncEventSourceClient* client) {
+        EventClient* c = findClient(nullptr);
+        if (!c) {
+            Serial.println("[Webserver] Too many SSE clients, closing");
+            _rejected++;
+            client->close();
+            return;
+        }
+        *c = EventClient();
+        c->client = client;
+        Serial.printf("[Webserver] SSE client connected from %s\n", client->client()->remoteIP().toString().c_str());
+    }
+
+    void removeClient(AsyncEventSourceClient* client) {
+        EventClient* c = findClient(client);
+        if (c) c->client = nullptr;
+    }
+
+    /**
+     * Format the sample into `_event`.
+     * @return the event name, nullptr if it does not fit
+     */
+    const char* format(const SensorSnapshot& snapshot) {
+        if (_encoding == TELEMETRY_CBOR) {
+            uint8_t cbor[TELEMETRY_CBOR_SIZE];
+            size_t length = MyTelemetryCodec::encodeCbor(snapshot, cbor, sizeof(cbor));
+            return MyTelemetryCodec::base64(cbor, length, _event, sizeof(_event)) ? "sample" : nullptr;
+        }
+        return MyTelemetryCodec::formatEventJson(snapshot, _event, sizeof(_event)) ? "readings" : nullptr;
+    }
+
+    /**
+     * Handle sampling profile request: GET returns the current and available
+     * profiles, POST with a `name` parameter switches the profile. `profile`
+     * is the requested profile, `active` the one sampling right now; they
+     * differ while `pending` is true.
+     */
+    void handleProfile(AsyncWebServerRequest* request) {
+        if (request->hasParam("name", true)) {
+            const String& name = request->getParam("name", true)->value();
+            if (!_sensor.selectProfile(name.c_str())) {
+                request->send(400, "application/json",
+                              "{\"success\":false,\"message\":\"Unknown profile\"}");
+                return;
+            }
+            Serial.printf("[Webserver] Sensor profile set to %s\n", name.c_str());
+        }
+
+        // selectProfile() only takes effect on the next update()
+        const SensorProfile& requested = _sensor.getRequestedProfile();
+        bool pending = _sensor.isProfilePending();
+        JsonDocument document = JsonDocument();
+        document["profile"] = requested.name;
+        document["active"] = _sensor.getProfile().name;
+        document["pending"] = pending;
+        document["conversionTime"] = MySensor::getConversionTime(requested);
+        document["samplePeriod"] = pending ? requested.samplePeriod : _sensor.getSamplePeriod();
+        JsonArray profiles = document["profiles"].to<JsonArray>();
+        for (uint8_t i = 0; i < SENSOR_PROFILE_COUNT; i++) {
+            JsonObject profile = profiles.add<JsonObject>();
+            profile["name"] = sensorProfiles[i].name;
+            profile["conversionTime"] = MySensor::getConversionTime(sensorProfiles[i]);
+            profile["samplePeriod"] = sensorProfiles[i].samplePeriod;
+        }
+
+        String response;
+        serializeJson(document, response);
+        request->send(200, "application/json", response);
+    }
+
+    /**
+     * Handle history request: GET with a `tier` parameter ("seconds",
+     * "minutes" or "hours", default "seconds") returns that tier as JSON,
+     * see MySensorHistory::exportJson(). The response is chunked, so a day
+     * of minute buckets never sits in the heap as a whole.
+     */
+    void handleHistory(AsyncWebServerRequest* request) {
+        HistoryTier tier = HISTORY_TIER_SECONDS;
+        if (request->hasParam("tier") &&
+            !MySensorHistory::parseTier(request->getParam("tier")->value().c_str(), tier)) {
+            request->send(400, "application/json",
+                          "{\"success\":false,\"message\":\"Unknown tier\"}");
+            return;
+        }
+
+        HistoryExport e = _history.beginExport(tier);
+        request->send(request->beginChunkedResponse(
+            "application/json",
+            [this, e](uint8_t* buffer, size_t maxLen, size_t index) mutable -> size_t {
+                if (maxLen < HISTORY_ROW_SIZE) return RESPONSE_TRY_AGAIN;
+                return _history.exportJson(e, (char*)buffer, maxLen);
+            }));
+    }
 
    public:
     bool isBegun = false;
 
+    MySensorWebserver(MySensor& sensor, const MySensorHistory& history)
+        : _sensor(sensor), _history(history) {}
+
     void begin() {
         Serial.println("[Webserver] Starting sensor webserver...");
 
@@ -28,11 +168,16 @@ class MySensorWebserver {
 
         _server->serveStatic("/", LittleFS, "/sensor-gauges/").setDefaultFile("index.html");
     
-        _events->onConnect([](AsyncEventSourceClient* client) {
-            Serial.printf("[Webserver] SSE client connected from %s\n", client->client()->remoteIP().toString().c_str());
-        });
+        _events->onConnect([this](AsyncEventSourceClient* client) { addClient(client); });
+        _events->onDisconnect([this](AsyncEventSourceClient* client) { removeClient(client); });
         _server->addHandler(_events);
 
+        // API: Sensor sampling profile
+        _server->on("/profile", HTTP_ANY, [this](AsyncWebServerRequest* request) { handleProfile(request); });
+
+        // API: Sensor history
+        _server->on("/history", HTTP_GET, [this](AsyncWebServerRequest* request) { handleHistory(request); });
+
         _server->onNotFound([](AsyncWebServerRequest* request) {
             Serial.printf("[Webserver] 404: %s\n", request->url().c_str());
             request->send(404, "text/plain", "Not Found");
@@ -72,7 +217,7 @@ class MySensorWebserver {
                 }
                 if (final) {
                     if (Update.end(false)) {
-                        Serial.printf("[OTA Update] Update Success: %uB\n", index + len);
+                        Serial.printf("[OTA Update] Update Success: %uB\n", (unsigned)(index + len));
                     } else {
                         Update.printError(Serial);
                     }
@@ -84,23 +229,84 @@ class MySensorWebserver {
         isBegun = true;
     }
 
-    void sendEvents(float temperatureC, float temperatureF, float humidity,
-                    float pressure, float altitude) {
+    /**
+     * Choose how samples go out: JSON as "readings" events, or CBOR in
+     * base64 as "sample" events (see MyTelemetryCodec).
+     */
+    void setEncoding(TelemetryEncoding encoding) { _encoding = encoding; }
+
+    TelemetryEncoding getEncoding() const { return _encoding; }
+
+    /**
+     * Send a sample to the event stream clients, at most once per second.
+     * Nothing is formatted while no client is connected. The sample is
+     * formatted once and broadcast: AsyncEventSource builds one shared
+     * message that every client queues by reference, and drops it for
+     * clients that already have EVENTS_QUEUE_MAX events queued. Clients
+     * that stay backed up for EVENTS_STALL_TIMEOUT are closed (browsers
+     * reconnect by themselves), so slow clients cannot fill the heap with
+     * queued events.
+     */
+    void sendEvents(const SensorSnapshot& snapshot) {
         // Throttle to once per second
-        if (millis() - lastEventSend < 1000) return;
+        if (millis() - lastEventSend < 1000 || !snapshot.valid) return;
         lastEventSend = millis();
 
-        JsonDocument document = JsonDocument();
-        document["temperatureC"] = temperatureC;
-        document["temperatureF"] = temperatureF;
-        document["humidity"] = humidity;
-        document["pressure"] = pressure;
-        document["altitude"] = altitude;
+        if (!_events->count()) {
+            _idle++;
+            return;
+        }
+
+        uint32_t start = micros();
+        const char* name = format(snapshot);
+        _formatTime = micros() - start;
+        if (!name) return;
+        _broadcasts++;
 
-        String documentStr = "";
-        serializeJson(document, documentStr);
+        // Book-keeping only, the broadcast below applies the queue limit
+        for (EventClient& c : _clients) {
+            if (!c.client) continue;
+            if (!c.client->connected()) {
+                c.client = nullptr;
+                continue;
+            }
+            if (c.client->packetsWaiting() >= EVENTS_QUEUE_MAX) {
+                if (!c.backedUpSince) c.backedUpSince = millis();
+                c.skipped++;
+                _skipped++;
+                if (millis() - c.backedUpSince >= EVENTS_STALL_TIMEOUT) {
+                    Serial.println("[Webserver] SSE client stalled, closing");
+                    _closed++;
+                    c.client->close();
+                    c.client = nullptr;
+                }
+                continue;
+            }
+            c.backedUpSince = 0;
+            c.sent++;
+        }
+        _events->send(_event, name, snapshot.sequence);
+    }
 
-        _events->send(documentStr.c_str(), "readings", millis());
+    /**
+     * Print event stream clients and statistics to the Serial Monitor.
+     */
+    void printStats() {
+        Serial.printf("Events (%s): %u client(s), %u samples sent, %u "
+                      "skipped without clients\n",
+                      MyTelemetryCodec::getEncodingName(_encoding),
+                      _events ? (unsigned)_events->count() : 0, _broadcasts, _idle);
+        Serial.printf("Format time: %u µs, backpressure: %u skipped, %u "
+                      "closed, %u rejected\n",
+                      _formatTime, _skipped, _closed, _rejected);
+        for (const EventClient& c : _clients) {
+            if (!c.client) continue;
+            Serial.printf("  %s: %u sent, %u skipped, %u queued%s\n",
+                          c.client->client()->remoteIP().toString().c_str(),
+                          c.sent, c.skipped, (unsigned)c.client->packetsWaiting(),
+                          c.backedUpSince ? ", backed up" : "");
+        }
+        Serial.println();
     }
 };
 #endif  // _MY_SENSOR_WEBSERVER_H_
@@ -0,0 +1,278 @@
+/**
+ * MySparkline.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Sparkline page: temperature, humidity and pressure of the last few minutes,
+ * one 16 px band per channel with the latest value next to it. Data comes
+ * from the 1 s tier of MySensorHistory, averaged over SPARKLINE_STEP seconds
+ * per column.
+ *
+ * A new column scrolls the bands left by whole bytes in the frame buffer and
+ * draws only the new column. A band is redrawn in full only when its scale
+ * changes, and scales snap to a per-channel step so that small changes
+ * do not rescale.
+ */
+
+#ifndef _MY_SPARKLINE_H_
+#define _MY_SPARKLINE_H_
+
+#include <Arduino.h>
+#include <utility>
+
+#include "MyDisplay.h"
+#include "MyFormat.h"
+#include "MySensorHistory.h"
+
+#define SPARKLINE_COLUMNS 88  // chart width, the labels use the rest
+#define SPARKLINE_STEP 5      // s per column: 88 columns = 7 min 20 s
+#define SPARKLINE_CHANNELS 3
+#define SPARKLINE_BAND_PAGES 2  // 16 px per channel
+#define SPARKLINE_HEIGHT (SPARKLINE_BAND_PAGES * 8 - 1)
+#define SPARKLINE_LABEL_X 92
+
+// Scale step per channel in raw units: 0.5 °C, 2 %RH, 1 hPa
+const int16_t sparklineQuantum[SPARKLINE_CHANNELS] = {50, 200, 100};
+
+class MySparkline {
+   private:
+    const MySensorHistory& _history;
+
+    // Column averages, oldest first, HISTORY_EMPTY for gaps
+    int16_t _columns[SPARKLINE_CHANNELS][SPARKLINE_COLUMNS];
+    int16_t _lo[SPARKLINE_CHANNELS];
+    int16_t _hi[SPARKLINE_CHANNELS];
+    uint32_t _column = 0;  // number of the newest column shown
+    bool _valid = false;
+
+    // Statistics
+    uint32_t _updates = 0;
+    uint32_t _redraws = 0;  // full redraws of a band
+    uint32_t _updateTime = 0;  // µs, last incremental update
+    uint32_t _maxUpdateTime = 0;
+    uint32_t _renderTime = 0;  // µs, last full render
+
+    static int16_t value(const HistorySample& s, uint8_t channel) {
+        return channel == 0 ? s.temperature
+               : channel == 1 ? s.humidity
+                              : s.pressure;
+    }
+
+    /**
+     * Average of one channel over the SPARKLINE_STEP seconds of `column`,
+     * read from the 1 s tier.
+     */
+    int16_t average(uint32_t column, uint8_t channel) const {
+        const MyRing<HistorySample>& seconds = _history.getSeconds();
+        uint32_t newest = _history.getLastSecond();
+        int32_t sum = 0;
+        uint8_t count = 0;
+
+        for (uint32_t t = column * SPARKLINE_STEP;
+             t < (column + 1) * SPARKLINE_STEP; t++) {
+            uint32_t age = newest - t;
+            if (t > newest || age >= seconds.size()) continue;
+            int16_t v = value(seconds.at(seconds.size() - 1 - age), channel);
+            if (v == HISTORY_EMPTY) continue;
+            sum += v;
+            count++;
+        }
+        return count ? sum / count : HISTORY_EMPTY;
+    }
+
+    /**
+     * Fit the scale of a channel to its columns, snapped to the channel's
+     * quantum.
+     * @return true if the scale changed
+     */
+    bool rescale(uint8_t channel) {
+        int16_t lo = INT16_MAX;
+        int16_t hi = INT16_MIN;
+        for (uint8_t x = 0; x < SPARKLINE_COLUMNS; x++) {
+            int16_t v = _columns[channel][x];
+            if (v == HISTORY_EMPTY) continue;
+            if (v < lo) lo = v;
+            if (v > hi) hi = v;
+        }
+        if (lo > hi) lo = hi = 0;
+
+        int16_t q = sparklineQuantum[channel];
+        lo = (lo - (lo % q + q) % q);
+        hi = lo + ((hi - lo) / q + 1) * q;
+
+        bool changed = lo != _lo[channel] || hi != _hi[channel];
+        _lo[channel] = lo;
+        _hi[channel] = hi;
+        return changed;
+    }
+
+    uint8_t toY(uint8_t channel, int16_t v) const {
+        return SPARKLINE_HEIGHT - (int32_t)(v - _lo[channel]) *
+                                      SPARKLINE_HEIGHT /
+                                      (_hi[channel] - _lo[channel]);
+    }
+
+    /**
+     * Draw column `x` of a band straight into the page layout: a vertical
+     * run from the previous column's value to this one, so the line stays
+     * connected.
+     */
+    void drawColumn(uint8_t* buffer, uint8_t channel, uint8_t x) {
+        int16_t v = _columns[channel][x];
+        if (v == HISTORY_EMPTY) return;
+
+        uint8_t y1 = toY(channel, v);
+        uint8_t y2 = y1;
+        int16_t prev = x ? _columns[channel][x - 1] : HISTORY_EMPTY;
+        if (prev != HISTORY_EMPTY) y2 = toY(channel, prev);
+        if (y1 > y2) std::swap(y1, y2);
+
+        uint8_t* column = buffer + channel * SPARKLINE_BAND_PAGES * SCREEN_WIDTH + x;
+        for (uint8_t y = y1; y <= y2; y++) {
+            column[(y / 8) * SCREEN_WIDTH] |= 1 << (y & 7);
+        }
+    }
+
+    void drawBand(uint8_t* buffer, uint8_t channel) {
+        for (uint8_t page = 0; page < SPARKLINE_BAND_PAGES; page++) {
+            memset(buffer + (channel * SPARKLINE_BAND_PAGES + page) * SCREEN_WIDTH,
+                   0, SPARKLINE_COLUMNS);
+        }
+        for (uint8_t x = 0; x < SPARKLINE_COLUMNS; x++) {
+            drawColumn(buffer, channel, x);
+        }
+        _redraws++;
+    }
+
+    /**
+     * Move a band `n` columns to the left with one memmove per page row.
+     */
+    static void scrollBand(uint8_t* buffer, uint8_t channel, uint8_t n) {
+        for (uint8_t page = 0; page < SPARKLINE_BAND_PAGES; page++) {
+            uint8_t* row =
+                buffer + (channel * SPARKLINE_BAND_PAGES + page) * SCREEN_WIDTH;
+            memmove(row, row + n, SPARKLINE_COLUMNS - n);
+            memset(row + SPARKLINE_COLUMNS - n, 0, n);
+        }
+    }
+
+    /**
+     * Latest value of a channel right of its band.
+     */
+    void drawLabel(MyDisplay& display, uint8_t channel) {
+        Adafruit_GFX& gfx = display.getCanvas();
+        int16_t y = channel * SPARKLINE_BAND_PAGES * 8;
+        gfx.fillRect(SPARKLINE_LABEL_X, y, SCREEN_WIDTH - SPARKLINE_LABEL_X,
+                     SPARKLINE_BAND_PAGES * 8, SH110X_BLACK);
+        gfx.setCursor(SPARKLINE_LABEL_X, y + 4);
+
+        int16_t v = _columns[channel][SPARKLINE_COLUMNS - 1];
+        if (v == HISTORY_EMPTY) {
+            gfx.print("--");
+            return;
+        }
+        char buf[16];
+        switch (channel) {
+            case 0:
+                gfx.printf("%s%c", MyFormat::centi(v, buf, sizeof(buf)), (char)247);
+                break;
+            case 1:
+                gfx.printf("%s%%", MyFormat::centi(v, buf, sizeof(buf)));
+                break;
+            default:
+                gfx.printf("%ld", (v + 100000L + 50) / 100);  // hPa
+                break;
+        }
+    }
+
+   public:
+    MySparkline(const MySensorHistory& history) : _history(history) {}
+
+    /**
+     * Number of the newest complete column. Changes every SPARKLINE_STEP
+     * seconds; use it as the page model.
+     */
+    uint32_t getColumn() const {
+        uint32_t column = _history.getLastSecond() / SPARKLINE_STEP;
+        return column ? column - 1 : 0;
+    }
+
+    /**
+     * Draw the whole page into a cleared frame.
+     */
+    void render(MyDisplay& display) {
+        uint32_t start = micros();
+        uint8_t* buffer = display.getBuffer();
+        _column = getColumn();
+
+        for (uint8_t c = 0; c < SPARKLINE_CHANNELS; c++) {
+            for (uint8_t x = 0; x < SPARKLINE_COLUMNS; x++) {
+                uint32_t age = SPARKLINE_COLUMNS - 1 - x;
+                _columns[c][x] =
+                    age <= _column ? average(_column - age, c) : HISTORY_EMPTY;
+            }
+            rescale(c);
+            drawBand(buffer, c);
+            drawLabel(display, c);
+        }
+
+        Adafruit_GFX& gfx = display.getCanvas();
+        gfx.setCursor(0, SCREEN_HEIGHT - 8);
+        gfx.printf("T/H/P, %u min", SPARKLINE_COLUMNS * SPARKLINE_STEP / 60);
+        _valid = true;
+        _renderTime = micros() - start;
+    }
+
+    /**
+     * Bring the page's previous frame up to date: scroll by the number of
+     * new columns and draw only those, unless a scale changed.
+     */
+    void update(MyDisplay& display) {
+        uint32_t column = getColumn();
+        uint32_t n = column - _column;
+        if (!_valid || n >= SPARKLINE_COLUMNS) {
+            display.clear();
+            render(display);
+            return;
+        }
+        if (n == 0) return;
+
+        uint32_t start = micros();
+        uint8_t* buffer = display.getBuffer();
+        _column = column;
+
+        for (uint8_t c = 0; c < SPARKLINE_CHANNELS; c++) {
+            memmove(_columns[c], _columns[c] + n,
+                    (SPARKLINE_COLUMNS - n) * sizeof(int16_t));
+            for (uint8_t x = SPARKLINE_COLUMNS - n; x < SPARKLINE_COLUMNS; x++) {
+                _columns[c][x] = average(column - (SPARKLINE_COLUMNS - 1 - x), c);
+            }
+
+            if (rescale(c)) {
+                drawBand(buffer, c);
+            } else {
+                scrollBand(buffer, c, n);
+                for (uint8_t x = SPARKLINE_COLUMNS - n; x < SPARKLINE_COLUMNS; x++) {
+                    drawColumn(buffer, c, x);
+                }
+            }
+            drawLabel(display, c);
+        }
+
+        _updates++;
+        _updateTime = micros() - start;
+        if (_updateTime > _maxUpdateTime) _maxUpdateTime = _updateTime;
+    }
+
+    /**
+     * Print update cost statistics to the Serial Monitor.
+     */
+    void printStats() {
+        Serial.println("Sparkline:");
+        Serial.printf("Updates: %u, band redraws: %u\n", _updates, _redraws);
+        Serial.printf("Last update %u µs (max. %u µs), last full render %u µs\n",
+                      _updateTime, _maxUpdateTime, _renderTime);
+        Serial.println();
+    }
+};
+
+#endif  // _MY_SPARKLINE_H_
@@ -0,0 +1,268 @@
+/**
+ * MyTelemetryCodec.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Encodings of a full sample for MQTT and the event stream.
+ *
+ * JSON: {"v":1,"t":1760000000,"seq":42,"temp":21.50,"hum":45.20,...}, short
+ * keys, fixed point values with two decimals.
+ *
+ * CBOR: one array of integers in the raw units of SensorSnapshot, no keys
+ * and no text conversion:
+ *   [v, seq, t, temp °C, temp °F, hum, pres, alt, dew, ahum, hi, tend, fc]
+ * tend and fc (Zambretti letter as its character code) are left out while
+ * the tendency is unknown. About 40 bytes instead of about 150.
+ *
+ * The event stream is text only, so it carries CBOR as base64. Decoders for
+ * subscribers: decodeCbor() here, data/sensor-gauges/telemetry.js for the
+ * web page and tools/telemetry_codec.py.
+ */
+
+#ifndef _MY_TELEMETRY_CODEC_H_
+#define _MY_TELEMETRY_CODEC_H_
+
+#include <Arduino.h>
+
+#include "MyCbor.h"
+#include "MyFormat.h"
+#include "MySensor.h"
+
+#define TELEMETRY_SCHEMA_VERSION 1  // "v" of both encodings
+#define TELEMETRY_CBOR_ITEMS 13     // with tendency and forecast
+#define TELEMETRY_CBOR_SIZE 64      // enough for the largest values
+#define TELEMETRY_JSON_SIZE 256
+
+enum TelemetryEncoding {
+    TELEMETRY_JSON,
+    TELEMETRY_CBOR,
+};
+
+class MyTelemetryCodec {
+   private:
+    static constexpr const char* base64Chars =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+   public:
+    /**
+     * Format a sample as telemetry JSON.
+     * @return length, 0 if `size` is too small
+     */
+    static size_t formatJson(const SensorSnapshot& snapshot, char* buf,
+                             size_t size) {
+        char temperature[16], humidity[16], pressure[16], altitude[16];
+        char dewPoint[16], absoluteHumidity[16], heatIndex[16];
+        int length = snprintf(
+            buf, size,
+            "{\"v\":%u,\"t\":%u,\"seq\":%u,\"temp\":%s,\"hum\":%s,\"pres\":%s,"
+            "\"alt\":%s,\"dew\":%s,\"ahum\":%s,\"hi\":%s",
+            TELEMETRY_SCHEMA_VERSION, (uint32_t)snapshot.epoch, snapshot.sequence,
+            MyFormat::centi(snapshot.temperatureC, temperature, sizeof(temperature)),
+            MyFormat::centi(snapshot.humidity, humidity, sizeof(humidity)),
+            MyFormat::centi(snapshot.pressure, pressure, sizeof(pressure)),
+            MyFormat::centi(snapshot.altitude, altitude, sizeof(altitude)),
+            MyFormat::centi(snapshot.derived.dewPoint, dewPoint, sizeof(dewPoint)),
+            MyFormat::centi(snapshot.derived.absoluteHumidity, absoluteHumidity, sizeof(absoluteHumidity)),
+            MyFormat::centi(snapshot.derived.heatIndex, heatIndex, sizeof(heatIndex)));
+        if (length < 0 || (size_t)length >= size) return 0;
+        if (snapshot.derived.tendencyValid) {
+            char pressureTendency[16];
+            length += snprintf(
+                buf + length, size - length, ",\"tend\":%s,\"fc\":\"%s\"",
+                MyFormat::centi(snapshot.derived.pressureTendency, pressureTendency, sizeof(pressureTendency)),
+                MyDerivedMetrics::getForecastText(snapshot.derived.forecast));
+            if ((size_t)length >= size) return 0;
+        }
+        length += snprintf(buf + length, size - length, "}");
+        return (size_t)length < size ? length : 0;
+    }
+
+    /**
+     * Format a sample as the event stream's JSON document, with the long
+     * keys the web pages use. Same snprintf path as formatJson(), no
+     * JsonDocument on the heap per sample.
+     * @return length, 0 if `size` is too small
+     */
+    static size_t formatEventJson(const SensorSnapshot& snapshot, char* buf,
+                                  size_t size) {
+        char temperatureC[16], temperatureF[16], humidity[16], pressure[16], altitude[16];
+        char dewPoint[16], absoluteHumidity[16], heatIndex[16];
+        int length = snprintf(
+            buf, size,
+            "{\"sequence\":%u,\"temperatureC\":%s,\"temperatureF\":%s,"
+            "\"humidity\":%s,\"pressure\":%s,\"altitude\":%s,\"dewPoint\":%s,"
+            "\"absoluteHumidity\":%s,\"heatIndex\":%s",
+            snapshot.sequence,
+            MyFormat::centi(snapshot.temperatureC, temperatureC, sizeof(temperatureC)),
+            MyFormat::centi(snapshot.temperatureF, temperatureF, sizeof(temperatureF)),
+            MyFormat::centi(snapshot.humidity, humidity, sizeof(humidity)),
+            MyFormat::centi(snapshot.pressure, pressure, sizeof(pressure)),
+            MyFormat::centi(snapshot.altitude, altitude, sizeof(altitude)),
+            MyFormat::centi(snapshot.derived.dewPoint, dewPoint, sizeof(dewPoint)),
+            MyFormat::centi(snapshot.derived.absoluteHumidity, absoluteHumidity, sizeof(absoluteHumidity)),
+            MyFormat::centi(snapshot.derived.heatIndex, heatIndex, sizeof(heatIndex)));
+        if (length < 0 || (size_t)length >= size) return 0;
+        if (snapshot.derived.tendencyValid) {
+            char pressureTendency[16];
+            length += snprintf(
+                buf + length, size - length,
+                ",\"pressureTendency\":%s,\"forecast\":\"%s\"",
+                MyFormat::centi(snapshot.derived.pressureTendency, pressureTendency, sizeof(pressureTendency)),
+                MyDerivedMetrics::getForecastText(snapshot.derived.forecast));
+            if ((size_t)length >= size) return 0;
+        }
+        length += snprintf(buf + length, size - length, "}");
+        return (size_t)length < size ? length : 0;
+    }
+
+    /**
+     * Encode a sample as CBOR array.
+     * @return length, 0 if `size` is too small
+     */
+    static size_t encodeCbor(const SensorSnapshot& snapshot, uint8_t* buf,
+                             size_t size) {
+        bool tendency = snapshot.derived.tendencyValid;
+        MyCborWriter cbor(buf, size);
+        cbor.array(tendency ? TELEMETRY_CBOR_ITEMS : TELEMETRY_CBOR_ITEMS - 2);
+        cbor.number(TELEMETRY_SCHEMA_VERSION);
+        cbor.number(snapshot.sequence);
+        cbor.number(snapshot.epoch);
+        cbor.integer(snapshot.temperatureC);
+        cbor.integer(snapshot.temperatureF);
+        cbor.integer(snapshot.humidity);
+        cbor.integer(snapshot.pressure);
+        cbor.integer(snapshot.altitude);
+        cbor.integer(snapshot.derived.dewPoint);
+        cbor.integer(snapshot.derived.absoluteHumidity);
+        cbor.integer(snapshot.derived.heatIndex);
+        if (tendency) {
+            cbor.integer(snapshot.derived.pressureTendency);
+            cbor.number(snapshot.derived.forecast);
+        }
+        return cbor.length();
+    }
+
+    /**
+     * Decode a CBOR sample into `snapshot`. Fields the encoding does not
+     * carry (millis) are left alone.
+     * @return false if the data is not a sample of this schema version
+     */
+    static bool decodeCbor(const uint8_t* buf, size_t length,
+                           SensorSnapshot& snapshot) {
+        MyCborReader cbor(buf, length);
+        uint8_t items = cbor.array();
+        if (items != TELEMETRY_CBOR_ITEMS && items != TELEMETRY_CBOR_ITEMS - 2) {
+            return false;
+        }
+        if (cbor.number() != TELEMETRY_SCHEMA_VERSION) return false;
+        snapshot.sequence = cbor.number();
+        snapshot.epoch = cbor.number();
+        snapshot.temperatureC = cbor.integer();
+        snapshot.temperatureF = cbor.integer();
+        snapshot.humidity = cbor.integer();
+        snapshot.pressure = cbor.integer();
+        snapshot.altitude = cbor.integer();
+        snapshot.derived.dewPoint = cbor.integer();
+        snapshot.derived.absoluteHumidity = cbor.integer();
+        snapshot.derived.heatIndex = cbor.integer();
+        snapshot.derived.tendencyValid = items == TELEMETRY_CBOR_ITEMS;
+        if (snapshot.derived.tendencyValid) {
+            snapshot.derived.pressureTendency = cbor.integer();
+            snapshot.derived.forecast = cbor.number();
+        } else {
+            snapshot.derived.forecast = '?';
+        }
+        snapshot.valid = cbor.ok() && cbor.atEnd();
+        return snapshot.valid;
+    }
+
+    /**
+     * Base64 encode `length` bytes into `out`, with padding.
+     * @return length, 0 if `size` is too small
+     */
+    static size_t base64(const uint8_t* in, size_t length, char* out,
+                         size_t size) {
+        size_t needed = (length + 2) / 3 * 4;
+        if (needed >= size) return 0;
+        char* p = out;
+        for (size_t i = 0; i < length; i += 3) {
+            uint32_t n = (uint32_t)in[i] << 16;
+            if (i + 1 < length) n |= in[i + 1] << 8;
+            if (i + 2 < length) n |= in[i + 2];
+            *p++ = base64Chars[n >> 18 & 0x3F];
+            *p++ = base64Chars[n >> 12 & 0x3F];
+            *p++ = i + 1 < length ? base64Chars[n >> 6 & 0x3F] : '=';
+            *p++ = i + 2 < length ? base64Chars[n & 0x3F] : '=';
+        }
+        *p = '\0';
+        return needed;
+    }
+
+    static const char* getEncodingName(TelemetryEncoding encoding) {
+        return encoding == TELEMETRY_CBOR ? "cbor" : "json";
+    }
+
+    /**
+     * Encode `snapshot` `iterations` times with every path and print size
+     * and time per message. Checks that the CBOR sample decodes to the
+     * same values.
+     */
+    static void printBenchmark(const SensorSnapshot& snapshot,
+                               uint16_t iterations = 200) {
+        if (!snapshot.valid || !iterations) {
+            Serial.println("[Codec] Benchmark needs a valid sample");
+            return;
+        }
+        char json[TELEMETRY_JSON_SIZE];
+        uint8_t cbor[TELEMETRY_CBOR_SIZE];
+        char text[TELEMETRY_CBOR_SIZE * 4 / 3 + 4];
+        size_t length[5] = {};
+        uint32_t time[5] = {};
+        const char* names[5] = {"fields (text)", "json", "events json",
+                                "cbor", "cbor base64"};
+
+        for (uint8_t path = 0; path < 5; path++) {
+            uint32_t start = micros();
+            for (uint16_t i = 0; i < iterations; i++) {
+                switch (path) {
+                    case 0:  // plain text per field topic, as in fields mode
+                        length[path] = 0;
+                        for (int32_t value : {snapshot.temperatureC, snapshot.humidity, snapshot.pressure,
+                                              snapshot.altitude, snapshot.derived.dewPoint,
+                                              snapshot.derived.absoluteHumidity, snapshot.derived.heatIndex}) {
+                            length[path] += strlen(MyFormat::centi(value, json, sizeof(json)));
+                        }
+                        break;
+                    case 1:
+                        length[path] = formatJson(snapshot, json, sizeof(json));
+                        break;
+                    case 2:
+                        length[path] = formatEventJson(snapshot, json, sizeof(json));
+                        break;
+                    case 3:
+                        length[path] = encodeCbor(snapshot, cbor, sizeof(cbor));
+                        break;
+                    default:
+                        length[path] = base64(cbor, encodeCbor(snapshot, cbor, sizeof(cbor)),
+                                              text, sizeof(text));
+                }
+            }
+            time[path] = (micros() - start) / iterations;
+        }
+
+        Serial.println("Encoding        bytes   µs/message");
+        for (uint8_t path = 0; path < 5; path++) {
+            Serial.printf("%-14s %6u %12u\n", names[path], (unsigned)length[path], time[path]);
+        }
+
+        SensorSnapshot decoded;
+        bool same = decodeCbor(cbor, encodeCbor(snapshot, cbor, sizeof(cbor)), decoded) &&
+                    decoded.sequence == snapshot.sequence &&
+                    decoded.temperatureC == snapshot.temperatureC &&
+                    decoded.pressure == snapshot.pressure &&
+                    decoded.derived.heatIndex == snapshot.derived.heatIndex &&
+                    decoded.derived.forecast == (snapshot.derived.tendencyValid ? snapshot.derived.forecast : '?');
+        Serial.printf("CBOR round trip: %s\n\n", same ? "OK" : "MISMATCH");
+    }
+};
+
+#endif  // _MY_TELEMETRY_CODEC_H_
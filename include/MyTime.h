@@ -59,21 +59,25 @@ class MyTime {
     }
 
     /**
-     * Get the current local time as a formatted string.
+     * Format the current local time into `buf`, without touching the heap.
+     * @return buf
      */
-    String getLocalTimeString() {
-        String timeStr;
-
+    const char* formatLocalTime(char* buf, size_t size) {
         struct tm timeinfo = getTimeStruct();
 
-        char buf[64];
-        if (strftime(buf, sizeof(buf), "%A, %B %d %Y %H:%M:%S (zone %Z %z)",
-                     &timeinfo)) {
-            timeStr = String(buf);
-        } else {
-            return "Failed to format time";
+        if (!strftime(buf, size, "%A, %B %d %Y %H:%M:%S (zone %Z %z)",
+                      &timeinfo)) {
+            strlcpy(buf, "Failed to format time", size);
         }
-        return timeStr;
+        return buf;
+    }
+
+    /**
+     * Get the current local time as a formatted string.
+     */
+    String getLocalTimeString() {
+        char buf[64];
+        return String(formatLocalTime(buf, sizeof(buf)));
     }
 };
 
@@ -5,37 +5,169 @@
 
 #include <Arduino.h>
 
+#include "AdafruitOledTestSuite.h"
+#include "MyClockFace.h"
 #include "MyDisplay.h"
+#include "MyI2CBus.h"
+#include "MyLogosPacked.h"
 #include "MyMqtt.h"
+#include "MyPages.h"
 #include "MySensor.h"
+#include "MySensorFilter.h"
+#include "MySensorHistory.h"
+#include "MySensorLog.h"
 #include "MySmarterWifi.h"
+#include "MySparkline.h"
 #include "MyTime.h"
 #include "MySensorWebserver.h"
 
 #define TZ "CET-1CEST,M3.5.0,M10.5.0/3"  // Europe/Vienna
+#define SPINNER_FRAME_TIME 125                // ms per spinner frame
 
-MySensor sensor = MySensor();
-MyDisplay display = MyDisplay();
+MyI2CBus bus = MyI2CBus();
+MySensor sensor = MySensor(bus);
+MySensorFilter displayFilter = MySensorFilter(sensorFilterSmooth);
+MySensorFilter eventsFilter = MySensorFilter(sensorFilterClean);
+MySensorFilter mqttFilter = MySensorFilter(sensorFilterRaw);
+MySensorHistory history = MySensorHistory();
+MySparkline sparkline = MySparkline(history);
+MySensorLog sensorLog = MySensorLog();  // variable name "log" is already taken.
+MyDisplay display = MyDisplay(bus);
+MyPages pages = MyPages(display);
+MyClockFace clockFace = MyClockFace();
 MySmarterWifi wifi = MySmarterWifi();
 MyTime theTime = MyTime(TZ);  // variable name "time" is already taken.
-MyMqtt mqtt = MyMqtt("ESP8266", "Bedroom", "My_SmartHome/Benjamin/");
-MySensorWebserver server = MySensorWebserver();
+MyMqtt mqtt = MyMqtt(sensorLog, "ESP8266", "Bedroom", "My_SmartHome/Benjamin/");
+MySensorWebserver server = MySensorWebserver(sensor, history);
 
-int state = 0;
 unsigned long lastAction1s = 0;
-unsigned long lastAction3s = 0;
 String serialInput = "";
 
+/**
+ * Run each output's filter chain once per new snapshot. Pages, events and
+ * MQTT only read the results with get().
+ */
+void updateFilters(const SensorSnapshot& snapshot) {
+    displayFilter.update(snapshot);
+    eventsFilter.update(snapshot);
+    mqttFilter.update(snapshot);
+}
+
+// Pages
+
+bool wifiConnected() { return wifi.getConnectedState(); }
+
+uint8_t spinnerFrame() { return millis() / SPINNER_FRAME_TIME % SPINNER_FRAMES; }
+
+void sensorModel(MyRenderScheduler& model) {
+    const SensorSnapshot& s = displayFilter.get();
+    model.add(s.valid);
+    if (!s.valid) model.add(spinnerFrame());
+    model.add(s.temperatureC);
+    model.add(s.pressure);
+    model.add(s.humidity);
+    model.add(s.derived.dewPoint);
+    model.add(s.derived.tendencyValid ? s.derived.forecast : 0);
+    model.add(s.derived.pressureTendency);
+}
+
+void sensorRender(MyDisplay& d) {
+    d.drawSensorValues(displayFilter.get());
+    if (!displayFilter.get().valid) {
+        MyPackedBitmap::draw(d.getBuffer(), SCREEN_WIDTH - SPINNER_WIDTH, 2,
+                             spinnerPacked, spinnerFrame());
+    }
+}
+
+void wifiModel(MyRenderScheduler& model) {
+    model.add(wifi.getConnectedState());
+    model.add(WiFi.localIP());
+}
+
+void wifiRender(MyDisplay& d) {
+    if (wifi.getConnectedState()) {
+        d.drawWiFiInfo(true, wifi.getWifiSSID(), wifi.getWifiIP());
+    } else {
+        d.drawAPInfo(wifi.getApSSID(), wifi.getApPassword(), wifi.getApIp());
+    }
+}
+
+void timeModel(MyRenderScheduler& model) { model.add(time(nullptr)); }
+
+void timeRender(MyDisplay& d) { clockFace.render(d, theTime.getTimeStruct()); }
+
+void timeUpdate(MyDisplay& d) { clockFace.update(d, theTime.getTimeStruct()); }
+
+void graphModel(MyRenderScheduler& model) { model.add(sparkline.getColumn()); }
+
+void graphRender(MyDisplay& d) { sparkline.render(d); }
+
+void graphUpdate(MyDisplay& d) { sparkline.update(d); }
+
+const Page sensorPage = {"sensor", PAGE_DURATION, nullptr, sensorModel, sensorRender, nullptr};
+const Page graphPage = {"graph", PAGE_DURATION, nullptr, graphModel, graphRender, graphUpdate};
+const Page wifiPage = {"wifi", PAGE_DURATION, nullptr, wifiModel, wifiRender, nullptr};
+const Page timePage = {"time", PAGE_DURATION, wifiConnected, timeModel, timeRender, timeUpdate};
+
+/**
+ * MQTT commands for the sensor and the display, see MyMqtt::handleCommand().
+ */
+bool mqttCommand(MyMqttCommand& command) {
+    const MqttToken& name = command.getName();
+    MqttToken word;
+    long duration;
+
+    if (name.equals("profile")) {
+        command.next(word);
+        for (uint8_t i = 0; i < SENSOR_PROFILE_COUNT; i++) {
+            if (!word.equals(sensorProfiles[i].name)) continue;
+            sensor.selectProfile(sensorProfiles[i].name);
+            command.ok();
+            command.reply(" %s", sensorProfiles[i].name);
+            return true;
+        }
+        command.fail("unknown profile");
+    } else if (name.equals("page")) {
+        command.next(word);
+        for (uint8_t i = 0; i < pages.getCount(); i++) {
+            if (!word.equals(pages.getName(i))) continue;
+            if (!command.number(duration, 500, 60000)) break;
+            pages.setDuration(pages.getName(i), duration);
+            command.ok();
+            command.reply(" %s %ld ms", pages.getName(i), duration);
+            return true;
+        }
+        command.fail("usage: page <name> <500-60000 ms>");
+    } else if (name.equals("dump")) {
+        command.reply(" sensor.samples=%u sensor.period=%lu pages.frames=%u "
+                      "pages.overruns=%u pages.maxus=%u",
+                      sensor.getSnapshot().sequence, sensor.getSamplePeriod(),
+                      pages.getFrames(), pages.getOverruns(),
+                      pages.getMaxFrameTime());
+    } else {
+        return false;
+    }
+    return true;
+}
+
 void setup() {
     Serial.begin(115200);
     Serial.println();
 
+    bus.begin();
     sensor.begin();
+    history.begin();
+    sensorLog.begin();
     display.begin();
-    display.scanI2C();
+    bus.scan();
     display.showWiFiInfo();
+    pages.add(sensorPage);
+    pages.add(graphPage);
+    pages.add(wifiPage);
+    pages.add(timePage);
     wifi.connect();
     theTime.begin();
+    mqtt.setCommandHandler(mqttCommand);
     mqtt.begin();
 }
 
@@ -48,6 +180,26 @@ void loop() {
                 Serial.println("help - Show this help message");
                 Serial.println("status - Show current status");
                 Serial.println("reset - Reset WiFi settings");
+                Serial.println("bench - Benchmark sensor compensation, filters and pages");
+                Serial.println("bench oled - Benchmark display primitives, flush and packed logos");
+                Serial.println("profile <name> - Set sensor sampling profile");
+                Serial.println("filter <display|events|mqtt> <raw|clean|smooth> - Set output filter");
+                Serial.println("history - Show sensor history memory usage");
+                Serial.println("log - Show sensor log statistics");
+                Serial.println("log <from> <to> - Print the logged samples between two epochs as CSV");
+                Serial.println("display - Show display refresh statistics");
+                Serial.println("i2c - Show I2C bus statistics");
+                Serial.println("mqtt - Show MQTT connection and publish statistics");
+                Serial.println("mqtt mode <fields|batch|cbor> - Publish per-field topics or one JSON or CBOR telemetry document");
+                Serial.println("events - Show event stream clients and backpressure statistics");
+                Serial.println("events <json|cbor> - Set the encoding of the web page's event stream");
+                Serial.println("mqtt deadband <field> <deadband> <jump> - Set a field's report thresholds, raw units");
+                Serial.println("mqtt queue <drop-oldest|downsample> [<span s>] - Set how a long offline backlog is cut down");
+                Serial.println("mqtt command <command> - Run a command as if received on the MQTT command topic");
+                Serial.println("bench mqtt - Compare bytes and publish time of the MQTT modes");
+                Serial.println("bench codec - Compare size and encode time of the JSON, text and CBOR encodings");
+                Serial.println("bench heap - Check the MQTT publish path for heap use over a simulated day");
+                Serial.println("screenshot - Print the display content as PBM image");
             } else if (serialInput == "status") {
                 Serial.println("Status command received.");
                 Serial.printf("WiFi Connected: %s, SSID: %s, IP: %s, MAC: %s\n",
@@ -59,8 +211,92 @@ void loop() {
                 Serial.printf("The current time is %s.\n",
                               theTime.getLocalTimeString().c_str());
 
+            } else if (serialInput == "bench oled") {
+                runOledBenchmark(display);
+                runLogoBenchmark(display);
+                pages.redraw();
+            } else if (serialInput == "bench") {
+                sensor.printBenchmark();
+                displayFilter.printBenchmark();
+                eventsFilter.printBenchmark();
+                mqttFilter.printBenchmark();
+                clockFace.printBenchmark(display);
+                pages.printBenchmark();
+            } else if (serialInput.startsWith("filter ")) {
+                int space = serialInput.indexOf(' ', 7);
+                String output = serialInput.substring(7, space);
+                String name = space < 0 ? "" : serialInput.substring(space + 1);
+                MySensorFilter* filter = output == "display" ? &displayFilter
+                                         : output == "events" ? &eventsFilter
+                                         : output == "mqtt"   ? &mqttFilter
+                                                              : nullptr;
+                const SensorFilterConfig* config = name == "raw" ? &sensorFilterRaw
+                                                   : name == "clean" ? &sensorFilterClean
+                                                   : name == "smooth" ? &sensorFilterSmooth
+                                                                      : nullptr;
+                if (filter && config) {
+                    filter->setConfig(*config);
+                    Serial.printf("Filter for %s set to %s\n", output.c_str(), config->name);
+                } else {
+                    Serial.println("Usage: filter <display|events|mqtt> <raw|clean|smooth>");
+                }
+            } else if (serialInput == "display") {
+                pages.printStats();
+                sparkline.printStats();
+                display.printStats();
+            } else if (serialInput == "screenshot") {
+                pages.printScreenshot();
+            } else if (serialInput == "mqtt") {
+                mqtt.printStats();
+            } else if (serialInput.startsWith("mqtt mode ") ||
+                       serialInput.startsWith("mqtt deadband ") ||
+                       serialInput.startsWith("mqtt queue ")) {
+                // Same parser and range checks as on the command topic
+                mqtt.handleCommand(serialInput.c_str() + 5, serialInput.length() - 5);
+            } else if (serialInput.startsWith("mqtt command ")) {
+                mqtt.handleCommand(serialInput.c_str() + 13, serialInput.length() - 13);
+            } else if (serialInput == "bench mqtt") {
+                char timeStamp[64];
+                mqtt.printBenchmark(mqttFilter.get(), theTime.formatLocalTime(timeStamp, sizeof(timeStamp)));
+            } else if (serialInput == "events") {
+                server.printStats();
+            } else if (serialInput.startsWith("events ")) {
+                String encoding = serialInput.substring(7);
+                if (encoding == "json" || encoding == "cbor") {
+                    server.setEncoding(encoding == "cbor" ? TELEMETRY_CBOR : TELEMETRY_JSON);
+                    Serial.printf("Event encoding set to %s\n", encoding.c_str());
+                } else {
+                    Serial.println("Usage: events <json|cbor>");
+                }
+            } else if (serialInput == "bench codec") {
+                MyTelemetryCodec::printBenchmark(mqttFilter.get());
+            } else if (serialInput == "bench heap") {
+                mqtt.printHeapTest(mqttFilter.get());
+            } else if (serialInput == "i2c") {
+                bus.printStats();
+            } else if (serialInput == "log") {
+                sensorLog.printStats();
+            } else if (serialInput.startsWith("log ")) {
+                unsigned long from, to;
+                if (sscanf(serialInput.c_str() + 4, "%lu %lu", &from, &to) == 2 && from <= to) {
+                    sensorLog.printRange(from, to);
+                } else {
+                    Serial.println("Usage: log <from> <to>, Unix epochs");
+                }
+            } else if (serialInput == "history") {
+                history.printFootprint();
+            } else if (serialInput.startsWith("profile")) {
+                String name = serialInput.substring(8);
+                if (!sensor.selectProfile(name.c_str())) {
+                    Serial.print("Unknown profile. Available:");
+                    for (uint8_t i = 0; i < SENSOR_PROFILE_COUNT; i++) {
+                        Serial.printf(" %s", sensorProfiles[i].name);
+                    }
+                    Serial.println();
+                }
             } else if (serialInput == "reset") {
                 Serial.println("Resetting WiFi settings...");
+                sensorLog.flush();
                 wifi.resetCredentials();
                 ESP.restart();
             } else {
@@ -74,44 +310,26 @@ void loop() {
     }
 
     wifi.loop();
-
-    switch (state) {
-        case 0:
-            display.showSensorValues(
-                sensor.readTemperatureC(), sensor.readHumidity(),
-                sensor.readPressure(), sensor.readAltitude());
-            break;
-        case 1:
-            if (wifi.getConnectedState()) {
-                display.showWiFiInfo(true, wifi.getWifiSSID(), wifi.getWifiIP());
-
-            } else {
-                display.showAPInfo(wifi.getApSSID(), wifi.getApPassword(),
-                                   wifi.getApIp());
-            }
-            break;
-        case 2:
-            if (!wifi.getConnectedState()) {
-                state = (state + 1) % 3;
-            }
-            display.showTime(theTime.getLocalTimeString());
-            break;
+    const SensorSnapshot& snapshot = sensor.getSnapshot();
+    if (sensor.update()) {
+        history.add(snapshot);
+        sensorLog.add(snapshot);
+        updateFilters(snapshot);
+        mqtt.track(snapshot);  // the samples the log got
+    } else if (!snapshot.valid && displayFilter.get().valid) {
+        updateFilters(snapshot);  // sensor lost, the outputs show it offline
     }
 
-    if (millis() - lastAction3s > 3000) {
-        state = (state + 1) % 3;
-        lastAction3s = millis();
-    }
+    pages.loop();
 
     if (!wifi.getConnectedState()) return;
     if (!server.isBegun) server.begin();
     mqtt.loop();
-    server.sendEvents(sensor.readTemperatureC(), sensor.readTemperatureF(), sensor.readHumidity(), sensor.readPressure(), sensor.readAltitude());
+    server.sendEvents(eventsFilter.get());
 
-    if (millis() - lastAction1s > 1000 && wifi.getConnectedState()) {
-        mqtt.publishSensorData(sensor.readTemperatureC(), sensor.readHumidity(),
-                               sensor.readPressure(), sensor.readAltitude());
-        mqtt.publishTimeStamp(theTime.getLocalTimeString());
+    if (millis() - lastAction1s > mqtt.getInterval() && wifi.getConnectedState()) {
+        char timeStamp[64];
+        mqtt.publishSample(mqttFilter.get(), theTime.formatLocalTime(timeStamp, sizeof(timeStamp)));
         lastAction1s = millis();
     }
 }
\ No newline at end of file
@@ -0,0 +1,51 @@
+/**
+ * Adafruit_BME280.h (native)
+ * Benjamin Hartmann | 10/2026
+ *
+ * The register value enums MySensor's profiles are made of. MySensor talks
+ * to the chip itself, see FakeBme280.h for the emulated one.
+ */
+
+#ifndef _NATIVE_ADAFRUIT_BME280_H_
+#define _NATIVE_ADAFRUIT_BME280_H_
+
+#include <Wire.h>
+
+class Adafruit_BME280 {
+   public:
+    enum sensor_sampling {
+        SAMPLING_NONE = 0b000,
+        SAMPLING_X1 = 0b001,
+        SAMPLING_X2 = 0b010,
+        SAMPLING_X4 = 0b011,
+        SAMPLING_X8 = 0b100,
+        SAMPLING_X16 = 0b101
+    };
+
+    enum sensor_mode {
+        MODE_SLEEP = 0b00,
+        MODE_FORCED = 0b01,
+        MODE_NORMAL = 0b11
+    };
+
+    enum sensor_filter {
+        FILTER_OFF = 0b000,
+        FILTER_X2 = 0b001,
+        FILTER_X4 = 0b010,
+        FILTER_X8 = 0b011,
+        FILTER_X16 = 0b100
+    };
+
+    enum standby_duration {
+        STANDBY_MS_0_5 = 0b000,
+        STANDBY_MS_10 = 0b110,
+        STANDBY_MS_20 = 0b111,
+        STANDBY_MS_62_5 = 0b001,
+        STANDBY_MS_125 = 0b010,
+        STANDBY_MS_250 = 0b011,
+        STANDBY_MS_500 = 0b100,
+        STANDBY_MS_1000 = 0b101
+    };
+};
+
+#endif  // _NATIVE_ADAFRUIT_BME280_H_
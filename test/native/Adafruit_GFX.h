@@ -0,0 +1,399 @@
+/**
+ * Adafruit_GFX.h (native)
+ * Benjamin Hartmann | 10/2026
+ *
+ * Rasterizer for the [env:native] host build with the drawing API of
+ * Adafruit_GFX: the same line, circle, rounded rectangle and triangle
+ * algorithms and the classic 6x8 text cell, including its cp437() quirk.
+ * The glyphs come from NativeFont.h, a stand-in for glcdfont.c, so golden
+ * images made with it match the panel in layout but not in every glyph.
+ */
+
+#ifndef _NATIVE_ADAFRUIT_GFX_H_
+#define _NATIVE_ADAFRUIT_GFX_H_
+
+#include <Arduino.h>
+
+#include "NativeFont.h"
+
+class Adafruit_GFX : public Print {
+   private:
+    static void swap(int16_t& a, int16_t& b) {
+        int16_t t = a;
+        a = b;
+        b = t;
+    }
+
+   protected:
+    int16_t _width;
+    int16_t _height;
+    int16_t cursor_x = 0;
+    int16_t cursor_y = 0;
+    uint16_t textcolor = 0xFFFF;
+    uint16_t textbgcolor = 0xFFFF;
+    uint8_t textsize_x = 1;
+    uint8_t textsize_y = 1;
+    bool wrap = true;
+    bool _cp437 = false;
+
+   public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+        drawLine(x, y, x, y + h - 1, color);
+    }
+
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+        drawLine(x, y, x + w - 1, y, color);
+    }
+
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                          uint16_t color) {
+        for (int16_t i = x; i < x + w; i++) drawFastVLine(i, y, h, color);
+    }
+
+    void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                  uint16_t color) {
+        bool steep = abs(y1 - y0) > abs(x1 - x0);
+        if (steep) {
+            swap(x0, y0);
+            swap(x1, y1);
+        }
+        if (x0 > x1) {
+            swap(x0, x1);
+            swap(y0, y1);
+        }
+        int16_t dx = x1 - x0;
+        int16_t dy = abs(y1 - y0);
+        int16_t err = dx / 2;
+        int16_t ystep = y0 < y1 ? 1 : -1;
+
+        for (; x0 <= x1; x0++) {
+            if (steep) {
+                drawPixel(y0, x0, color);
+            } else {
+                drawPixel(x0, y0, color);
+            }
+            err -= dy;
+            if (err < 0) {
+                y0 += ystep;
+                err += dx;
+            }
+        }
+    }
+
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        drawFastHLine(x, y, w, color);
+        drawFastHLine(x, y + h - 1, w, color);
+        drawFastVLine(x, y, h, color);
+        drawFastVLine(x + w - 1, y, h, color);
+    }
+
+    void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+        int16_t f = 1 - r;
+        int16_t ddF_x = 1;
+        int16_t ddF_y = -2 * r;
+        int16_t x = 0;
+        int16_t y = r;
+
+        drawPixel(x0, y0 + r, color);
+        drawPixel(x0, y0 - r, color);
+        drawPixel(x0 + r, y0, color);
+        drawPixel(x0 - r, y0, color);
+
+        while (x < y) {
+            if (f >= 0) {
+                y--;
+                ddF_y += 2;
+                f += ddF_y;
+            }
+            x++;
+            ddF_x += 2;
+            f += ddF_x;
+
+            drawPixel(x0 + x, y0 + y, color);
+            drawPixel(x0 - x, y0 + y, color);
+            drawPixel(x0 + x, y0 - y, color);
+            drawPixel(x0 - x, y0 - y, color);
+            drawPixel(x0 + y, y0 + x, color);
+            drawPixel(x0 - y, y0 + x, color);
+            drawPixel(x0 + y, y0 - x, color);
+            drawPixel(x0 - y, y0 - x, color);
+        }
+    }
+
+    void drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners,
+                          uint16_t color) {
+        int16_t f = 1 - r;
+        int16_t ddF_x = 1;
+        int16_t ddF_y = -2 * r;
+        int16_t x = 0;
+        int16_t y = r;
+
+        while (x < y) {
+            if (f >= 0) {
+                y--;
+                ddF_y += 2;
+                f += ddF_y;
+            }
+            x++;
+            ddF_x += 2;
+            f += ddF_x;
+            if (corners & 0x4) {
+                drawPixel(x0 + x, y0 + y, color);
+                drawPixel(x0 + y, y0 + x, color);
+            }
+            if (corners & 0x2) {
+                drawPixel(x0 + x, y0 - y, color);
+                drawPixel(x0 + y, y0 - x, color);
+            }
+            if (corners & 0x8) {
+                drawPixel(x0 - y, y0 + x, color);
+                drawPixel(x0 - x, y0 + y, color);
+            }
+            if (corners & 0x1) {
+                drawPixel(x0 - y, y0 - x, color);
+                drawPixel(x0 - x, y0 - y, color);
+            }
+        }
+    }
+
+    void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+        drawFastVLine(x0, y0 - r, 2 * r + 1, color);
+        fillCircleHelper(x0, y0, r, 3, 0, color);
+    }
+
+    void fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners,
+                          int16_t delta, uint16_t color) {
+        int16_t f = 1 - r;
+        int16_t ddF_x = 1;
+        int16_t ddF_y = -2 * r;
+        int16_t x = 0;
+        int16_t y = r;
+        int16_t px = x;
+        int16_t py = y;
+
+        delta++;  // avoid some +1's in the loop
+
+        while (x < y) {
+            if (f >= 0) {
+                y--;
+                ddF_y += 2;
+                f += ddF_y;
+            }
+            x++;
+            ddF_x += 2;
+            f += ddF_x;
+            // These checks avoid double-drawing certain lines, which
+            // matters for INVERSE
+            if (x < (y + 1)) {
+                if (corners & 1) drawFastVLine(x0 + x, y0 - y, 2 * y + delta, color);
+                if (corners & 2) drawFastVLine(x0 - x, y0 - y, 2 * y + delta, color);
+            }
+            if (y != py) {
+                if (corners & 1) drawFastVLine(x0 + py, y0 - px, 2 * px + delta, color);
+                if (corners & 2) drawFastVLine(x0 - py, y0 - px, 2 * px + delta, color);
+                py = y;
+            }
+            px = x;
+        }
+    }
+
+    void drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
+                       uint16_t color) {
+        int16_t max_radius = (w < h ? w : h) / 2;
+        if (r > max_radius) r = max_radius;
+        drawFastHLine(x + r, y, w - 2 * r, color);
+        drawFastHLine(x + r, y + h - 1, w - 2 * r, color);
+        drawFastVLine(x, y + r, h - 2 * r, color);
+        drawFastVLine(x + w - 1, y + r, h - 2 * r, color);
+        drawCircleHelper(x + r, y + r, r, 1, color);
+        drawCircleHelper(x + w - r - 1, y + r, r, 2, color);
+        drawCircleHelper(x + w - r - 1, y + h - r - 1, r, 4, color);
+        drawCircleHelper(x + r, y + h - r - 1, r, 8, color);
+    }
+
+    void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
+                       uint16_t color) {
+        int16_t max_radius = (w < h ? w : h) / 2;
+        if (r > max_radius) r = max_radius;
+        fillRect(x + r, y, w - 2 * r, h, color);
+        fillCircleHelper(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
+        fillCircleHelper(x + r, y + r, r, 2, h - 2 * r - 1, color);
+    }
+
+    void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                      int16_t x2, int16_t y2, uint16_t color) {
+        drawLine(x0, y0, x1, y1, color);
+        drawLine(x1, y1, x2, y2, color);
+        drawLine(x2, y2, x0, y0, color);
+    }
+
+    void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                      int16_t x2, int16_t y2, uint16_t color) {
+        int16_t a, b, y, last;
+
+        // Sort coordinates by y (y2 >= y1 >= y0)
+        if (y0 > y1) {
+            swap(y0, y1);
+            swap(x0, x1);
+        }
+        if (y1 > y2) {
+            swap(y2, y1);
+            swap(x2, x1);
+        }
+        if (y0 > y1) {
+            swap(y0, y1);
+            swap(x0, x1);
+        }
+
+        if (y0 == y2) {  // all on the same line
+            a = b = x0;
+            if (x1 < a) a = x1;
+            else if (x1 > b) b = x1;
+            if (x2 < a) a = x2;
+            else if (x2 > b) b = x2;
+            drawFastHLine(a, y0, b - a + 1, color);
+            return;
+        }
+
+        int16_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0,
+                dy02 = y2 - y0, dx12 = x2 - x1, dy12 = y2 - y1;
+        int32_t sa = 0, sb = 0;
+
+        // Upper part, including scanline y1 unless it is flat
+        last = y1 == y2 ? y1 : y1 - 1;
+        for (y = y0; y <= last; y++) {
+            a = x0 + sa / dy01;
+            b = x0 + sb / dy02;
+            sa += dx01;
+            sb += dx02;
+            if (a > b) swap(a, b);
+            drawFastHLine(a, y, b - a + 1, color);
+        }
+
+        // Lower part
+        sa = (int32_t)dx12 * (y - y1);
+        sb = (int32_t)dx02 * (y - y0);
+        for (; y <= y2; y++) {
+            a = x1 + sa / dy12;
+            b = x0 + sb / dy02;
+            sa += dx12;
+            sb += dx02;
+            if (a > b) swap(a, b);
+            drawFastHLine(a, y, b - a + 1, color);
+        }
+    }
+
+    /**
+     * Rows of `w` bits, MSB first, each padded to a whole byte.
+     */
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w,
+                    int16_t h, uint16_t color) {
+        int16_t byteWidth = (w + 7) / 8;
+        for (int16_t j = 0; j < h; j++) {
+            for (int16_t i = 0; i < w; i++) {
+                if (pgm_read_byte(&bitmap[j * byteWidth + i / 8]) & (128 >> (i & 7))) {
+                    drawPixel(x + i, y + j, color);
+                }
+            }
+        }
+    }
+
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w,
+                    int16_t h, uint16_t color, uint16_t bg) {
+        int16_t byteWidth = (w + 7) / 8;
+        for (int16_t j = 0; j < h; j++) {
+            for (int16_t i = 0; i < w; i++) {
+                bool set = pgm_read_byte(&bitmap[j * byteWidth + i / 8]) & (128 >> (i & 7));
+                drawPixel(x + i, y + j, set ? color : bg);
+            }
+        }
+    }
+
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                  uint16_t bg, uint8_t size_x, uint8_t size_y) {
+        if (x >= _width || y >= _height || x + 6 * size_x - 1 < 0 ||
+            y + 8 * size_y - 1 < 0) {
+            return;
+        }
+        // glcdfont.c skips one glyph at 176 unless cp437(true)
+        if (!_cp437 && c >= 176) c++;
+
+        const uint8_t* glyph = nativeFontGlyph(c);
+        for (int8_t i = 0; i < 5; i++) {
+            uint8_t line = glyph[i];
+            for (int8_t j = 0; j < 8; j++, line >>= 1) {
+                if (line & 1) {
+                    if (size_x == 1 && size_y == 1) {
+                        drawPixel(x + i, y + j, color);
+                    } else {
+                        fillRect(x + i * size_x, y + j * size_y, size_x,
+                                 size_y, color);
+                    }
+                } else if (bg != color) {
+                    if (size_x == 1 && size_y == 1) {
+                        drawPixel(x + i, y + j, bg);
+                    } else {
+                        fillRect(x + i * size_x, y + j * size_y, size_x,
+                                 size_y, bg);
+                    }
+                }
+            }
+        }
+        if (bg != color) {  // spacing column
+            if (size_x == 1 && size_y == 1) {
+                drawFastVLine(x + 5, y, 8, bg);
+            } else {
+                fillRect(x + 5 * size_x, y, size_x, 8 * size_y, bg);
+            }
+        }
+    }
+
+    size_t write(uint8_t c) override {
+        if (c == '\n') {
+            cursor_x = 0;
+            cursor_y += textsize_y * 8;
+        } else if (c != '\r') {
+            if (wrap && cursor_x + textsize_x * 6 > _width) {
+                cursor_x = 0;
+                cursor_y += textsize_y * 8;
+            }
+            drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x,
+                     textsize_y);
+            cursor_x += textsize_x * 6;
+        }
+        return 1;
+    }
+
+    using Print::write;
+
+    void setCursor(int16_t x, int16_t y) {
+        cursor_x = x;
+        cursor_y = y;
+    }
+    int16_t getCursorX() const { return cursor_x; }
+    int16_t getCursorY() const { return cursor_y; }
+
+    void setTextSize(uint8_t s) { textsize_x = textsize_y = s > 0 ? s : 1; }
+
+    /**
+     * Transparent background.
+     */
+    void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+    void setTextColor(uint16_t c, uint16_t bg) {
+        textcolor = c;
+        textbgcolor = bg;
+    }
+    void setTextWrap(bool w) { wrap = w; }
+    void cp437(bool x = true) { _cp437 = x; }
+};
+
+#endif  // _NATIVE_ADAFRUIT_GFX_H_
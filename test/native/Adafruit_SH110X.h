@@ -0,0 +1,131 @@
+/**
+ * Adafruit_SH110X.h (native)
+ * Benjamin Hartmann | 10/2026
+ *
+ * Adafruit_SH1106G for the [env:native] host build: a 1 KB frame buffer in
+ * the panel's page layout that display() sends over the (emulated) Wire
+ * bus, page by page, like the driver does. Attach a FakeSh1106 to the bus
+ * to see what reaches the panel.
+ */
+
+#ifndef _NATIVE_ADAFRUIT_SH110X_H_
+#define _NATIVE_ADAFRUIT_SH110X_H_
+
+#include <Adafruit_GFX.h>
+#include <Wire.h>
+
+#define SH110X_BLACK 0
+#define SH110X_WHITE 1
+#define SH110X_INVERSE 2
+
+#define SH110X_I2C_CHUNK 31  // data bytes per transaction, as the driver
+
+class Adafruit_GrayOLED : public Adafruit_GFX {
+   protected:
+    uint8_t buffer[128 * 64 / 8];
+    TwoWire* _theWire;
+    uint8_t _address = 0x3C;
+
+    bool command(const uint8_t* bytes, uint8_t length) {
+        _theWire->beginTransmission(_address);
+        _theWire->write((uint8_t)0x00);
+        _theWire->write(bytes, length);
+        return _theWire->endTransmission() == 0;
+    }
+
+   public:
+    Adafruit_GrayOLED(int16_t w, int16_t h, TwoWire* wire)
+        : Adafruit_GFX(w, h), _theWire(wire) {
+        memset(buffer, 0, sizeof(buffer));
+    }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+        if (x < 0 || x >= _width || y < 0 || y >= _height) return;
+        uint8_t& b = buffer[x + (y / 8) * _width];
+        uint8_t bit = 1 << (y & 7);
+        switch (color) {
+            case SH110X_WHITE:
+                b |= bit;
+                break;
+            case SH110X_BLACK:
+                b &= ~bit;
+                break;
+            case SH110X_INVERSE:
+                b ^= bit;
+                break;
+        }
+    }
+
+    bool getPixel(int16_t x, int16_t y) {
+        if (x < 0 || x >= _width || y < 0 || y >= _height) return false;
+        return buffer[x + (y / 8) * _width] & 1 << (y & 7);
+    }
+
+    void clearDisplay() { memset(buffer, 0, sizeof(buffer)); }
+
+    uint8_t* getBuffer() { return buffer; }
+
+    void setContrast(uint8_t level) {
+        const uint8_t bytes[] = {0x81, level};
+        command(bytes, sizeof(bytes));
+    }
+
+    void invertDisplay(bool i) {
+        uint8_t c = i ? 0xA7 : 0xA6;
+        command(&c, 1);
+    }
+};
+
+class Adafruit_SH110X : public Adafruit_GrayOLED {
+   protected:
+    uint8_t _page_start_offset = 0;
+
+   public:
+    Adafruit_SH110X(int16_t w, int16_t h, TwoWire* wire, int8_t rst_pin = -1,
+                    uint32_t preclk = 400000, uint32_t postclk = 100000)
+        : Adafruit_GrayOLED(w, h, wire) {}
+
+    /**
+     * Clear the buffer and switch the panel on. The driver also draws its
+     * splash screen here, which the emulation leaves out.
+     */
+    bool begin(uint8_t address = 0x3C, bool reset = true) {
+        _address = address;
+        clearDisplay();
+        const uint8_t init[] = {0xAE, 0xA6, 0xAF};  // off, normal, on
+        return command(init, sizeof(init));
+    }
+
+    /**
+     * Send the whole buffer.
+     */
+    void display() {
+        for (uint8_t page = 0; page < _height / 8; page++) {
+            const uint8_t address[] = {(uint8_t)(0xB0 | page),
+                                       (uint8_t)(0x10 | _page_start_offset >> 4),
+                                       (uint8_t)(_page_start_offset & 0x0F)};
+            command(address, sizeof(address));
+
+            const uint8_t* row = buffer + page * _width;
+            for (int16_t x = 0; x < _width; x += SH110X_I2C_CHUNK) {
+                uint8_t n = min<int16_t>(SH110X_I2C_CHUNK, _width - x);
+                _theWire->beginTransmission(_address);
+                _theWire->write((uint8_t)0x40);
+                _theWire->write(row + x, n);
+                _theWire->endTransmission();
+            }
+        }
+    }
+};
+
+class Adafruit_SH1106G : public Adafruit_SH110X {
+   public:
+    Adafruit_SH1106G(int16_t w, int16_t h, TwoWire* wire = &Wire,
+                     int8_t rst_pin = -1, uint32_t preclk = 400000,
+                     uint32_t postclk = 100000)
+        : Adafruit_SH110X(w, h, wire, rst_pin, preclk, postclk) {
+        _page_start_offset = 2;  // 132 column RAM, panel starts at 2
+    }
+};
+
+#endif  // _NATIVE_ADAFRUIT_SH110X_H_
@@ -0,0 +1,11 @@
+/**
+ * Adafruit_Sensor.h (native)
+ * Benjamin Hartmann | 10/2026
+ *
+ * Included by MySensor.h, the unified sensor API is not used.
+ */
+
+#ifndef _NATIVE_ADAFRUIT_SENSOR_H_
+#define _NATIVE_ADAFRUIT_SENSOR_H_
+
+#endif  // _NATIVE_ADAFRUIT_SENSOR_H_
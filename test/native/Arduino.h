@@ -0,0 +1,331 @@
+/**
+ * Arduino.h (native)
+ * Benjamin Hartmann | 10/2026
+ *
+ * The part of the ESP8266 Arduino core the headers in include/ use, for the
+ * [env:native] host build. Time is a fake clock that only moves when a test
+ * (or delay(), or a bus transfer) advances it, so state machines run
+ * deterministically. Serial prints to stdout. SDA and SCL are emulated
+ * well enough for MyI2CBus::recover(): a test can hold SDA low for a number
+ * of SCL pulses.
+ */
+
+#ifndef _NATIVE_ARDUINO_H_
+#define _NATIVE_ARDUINO_H_
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include "binary.h"
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#define DEC 10
+#define HEX 16
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define OUTPUT_OPEN_DRAIN 3
+#define SDA 4
+#define SCL 5
+
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+
+typedef bool boolean;
+typedef uint8_t byte;
+using std::max;
+using std::min;
+
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t length = strlen(src);
+    if (size) {
+        size_t n = length < size - 1 ? length : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return length;
+}
+
+// Clock
+
+/**
+ * Emulated time in µs since boot.
+ */
+inline uint64_t fakeMicros = 0;
+
+/**
+ * What the SDK runs outside of loop(), in delay() and in yield(): the TCP
+ * callbacks of the native AsyncClient, which sets it.
+ */
+inline void (*fakeSystemTask)() = nullptr;
+
+inline unsigned long millis() { return fakeMicros / 1000; }
+inline unsigned long micros() { return fakeMicros; }
+inline void yield() {
+    if (fakeSystemTask) fakeSystemTask();
+}
+inline void delay(unsigned long ms) {
+    fakeMicros += ms * 1000ULL;
+    yield();
+}
+inline void delayMicroseconds(unsigned int us) { fakeMicros += us; }
+
+/**
+ * Move the clock forward, e.g. by one pass of loop(), and run the system
+ * task.
+ */
+inline void fakeAdvance(unsigned long ms) { delay(ms); }
+
+/**
+ * Set millis() to `ms`, e.g. just before the 49.7 day wrap.
+ */
+inline void fakeSetMillis(uint32_t ms) { fakeMicros = ms * 1000ULL; }
+
+inline uint32_t fakeRandom = 1;
+
+inline void randomSeed(unsigned long seed) { fakeRandom = seed ? seed : 1; }
+
+inline long random(long low, long high) {
+    fakeRandom = fakeRandom * 1103515245UL + 12345UL;  // reproducible
+    return high > low ? low + (long)(fakeRandom >> 8) % (high - low) : low;
+}
+
+inline long random(long high) { return random(0, high); }
+
+// Pins
+
+/**
+ * Open drain SDA and SCL lines. `sdaStuck` is the number of SCL pulses a
+ * slave still needs before it releases SDA; while it is non-zero the bus
+ * is hung.
+ */
+struct FakeI2CPins {
+    uint8_t scl = HIGH;
+    uint8_t sdaStuck = 0;
+    uint32_t sclPulses = 0;
+};
+
+inline FakeI2CPins fakePins;
+
+inline void pinMode(uint8_t pin, uint8_t mode) {}
+
+inline void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin != SCL) return;
+    if (fakePins.scl == LOW && value == HIGH) {
+        fakePins.sclPulses++;
+        if (fakePins.sdaStuck) fakePins.sdaStuck--;
+    }
+    fakePins.scl = value;
+}
+
+inline int digitalRead(uint8_t pin) {
+    if (pin == SDA) return fakePins.sdaStuck ? LOW : HIGH;
+    return pin == SCL ? fakePins.scl : LOW;
+}
+
+// Strings and printing
+
+class String {
+   private:
+    std::string _s;
+
+   public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(int v) : _s(std::to_string(v)) {}
+    String(unsigned v) : _s(std::to_string(v)) {}
+    String(long v) : _s(std::to_string(v)) {}
+    String(unsigned long v) : _s(std::to_string(v)) {}
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned length() const { return _s.size(); }
+    bool reserve(unsigned size) {
+        _s.reserve(size);
+        return true;
+    }
+
+    String& operator+=(const String& s) {
+        _s += s._s;
+        return *this;
+    }
+    String& operator+=(const char* s) {
+        _s += s;
+        return *this;
+    }
+    String& operator+=(char c) {
+        _s += c;
+        return *this;
+    }
+    friend String operator+(const String& a, const String& b) {
+        return String(a._s + b._s);
+    }
+
+    bool operator==(const String& s) const { return _s == s._s; }
+    bool operator==(const char* s) const { return _s == s; }
+    bool operator!=(const char* s) const { return _s != s; }
+    char operator[](unsigned i) const { return _s[i]; }
+
+    bool startsWith(const String& prefix) const {
+        return _s.compare(0, prefix._s.size(), prefix._s) == 0;
+    }
+    int indexOf(char c, unsigned from = 0) const {
+        size_t i = _s.find(c, from);
+        return i == std::string::npos ? -1 : (int)i;
+    }
+    String substring(unsigned from) const {
+        return from < _s.size() ? String(_s.substr(from)) : String();
+    }
+    String substring(unsigned from, unsigned to) const {
+        return from < _s.size() && to > from ? String(_s.substr(from, to - from))
+                                             : String();
+    }
+    long toInt() const { return atol(_s.c_str()); }
+};
+
+class Print {
+   private:
+    size_t printNumber(unsigned long n, uint8_t base) {
+        char buf[8 * sizeof(long) + 1];
+        char* s = buf + sizeof(buf) - 1;
+        *s = '\0';
+        if (base < 2) base = 10;
+        do {
+            uint8_t digit = n % base;
+            *--s = digit < 10 ? '0' + digit : 'A' + digit - 10;
+            n /= base;
+        } while (n);
+        return write(s);
+    }
+
+   public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t write(const char* s, size_t size) {
+        return write((const uint8_t*)s, size);
+    }
+
+    size_t printf(const char* format, ...)
+        __attribute__((format(printf, 2, 3))) {
+        char buf[256];
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (n < 0) return 0;
+        return write((const uint8_t*)buf, min((size_t)n, sizeof(buf) - 1));
+    }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char n, int base = DEC) {
+        return print((unsigned long)n, base);
+    }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned n, int base = DEC) {
+        return print((unsigned long)n, base);
+    }
+    size_t print(long n, int base = DEC) {
+        if (base == DEC && n < 0) return print('-') + printNumber(-n, DEC);
+        return printNumber(base == DEC ? n : (unsigned long)n, base);
+    }
+    size_t print(unsigned long n, int base = DEC) { return printNumber(n, base); }
+    size_t print(double n, int digits = 2) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.*f", digits, n);
+        return write(buf);
+    }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) {
+        return print(value) + println();
+    }
+    template <typename T>
+    size_t println(const T& value, int format) {
+        return print(value, format) + println();
+    }
+};
+
+class Stream : public Print {
+   public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+};
+
+/**
+ * Serial Monitor on stdout, without the "\r" of println().
+ */
+class HardwareSerial : public Stream {
+   public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override {
+        if (c != '\r') putchar(c);
+        return 1;
+    }
+    using Print::write;
+};
+
+inline HardwareSerial Serial;
+
+// ESP8266 specifics
+
+/**
+ * Host time in ns, for timing on the native build.
+ */
+inline uint64_t hostNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * Cycle counts are host nanoseconds, reported at a nominal 1000 MHz, so
+ * cycles / getCpuFreqMHz() is still µs.
+ */
+class EspClass {
+   public:
+    uint32_t freeHeap = 40000;
+    uint32_t maxFreeBlock = 30000;
+
+    uint32_t getCycleCount() { return hostNanos(); }
+    uint32_t getCpuFreqMHz() { return 1000; }
+    uint32_t getFreeHeap() { return freeHeap; }
+    uint16_t getMaxFreeBlockSize() { return min(maxFreeBlock, 0xFFFFU); }
+    uint8_t getHeapFragmentation() { return 0; }
+    uint32_t getChipId() { return 0x00C0FFEE; }
+    void restart() {}
+};
+
+inline EspClass ESP;
+
+#endif  // _NATIVE_ARDUINO_H_
@@ -0,0 +1,126 @@
+/**
+ * ESP8266WiFi.h (native)
+ * Benjamin Hartmann | 10/2026
+ *
+ * The station interface as far as MyMqtt uses it: SSID, IP address and a
+ * WiFiClient whose TCP connection ends at the emulated `fakeBroker`.
+ */
+
+#ifndef _NATIVE_ESP8266_WIFI_H_
+#define _NATIVE_ESP8266_WIFI_H_
+
+#include <Arduino.h>
+
+#include "FakeBroker.h"
+
+class IPAddress {
+   private:
+    uint8_t _bytes[4];
+
+   public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0)
+        : _bytes{a, b, c, d} {}
+
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _bytes[0], _bytes[1],
+                 _bytes[2], _bytes[3]);
+        return String(buf);
+    }
+};
+
+/**
+ * Arduino Client interface as in the ESP8266 core 3.x.
+ */
+class Client : public Stream {
+   public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override = 0;
+    virtual int read(uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        int c;
+        while (n < size && (c = read()) >= 0) buffer[n++] = c;
+        return n;
+    }
+    using Stream::read;
+    virtual bool flush(unsigned int maxWaitMs = 0) { return true; }
+    virtual bool stop(unsigned int maxWaitMs = 0) = 0;
+    virtual uint8_t connected() = 0;
+    virtual operator bool() { return connected(); }
+};
+
+/**
+ * TCP to `fakeBroker`. Connecting costs the emulated time a real one
+ * would: a refused connection a few ms, an unreachable host the connect
+ * timeout. Also remembers its timeouts.
+ */
+class WiFiClient : public Client {
+   private:
+    uint32_t _session = 0;
+
+   public:
+    unsigned long timeout = 1000;  // ms, Stream default
+    uint32_t timeoutChanges = 0;
+
+    void setTimeout(unsigned long ms) {
+        timeout = ms;
+        timeoutChanges++;
+    }
+
+    int connect(IPAddress ip, uint16_t port) override { return connect("", port); }
+
+    int connect(const char* host, uint16_t port) override {
+        _session = fakeBroker.open();
+        switch (fakeBroker.state) {
+            case BROKER_UP:
+            case BROKER_SILENT:
+            case BROKER_REJECTING:
+                delay(FAKE_BROKER_CONNECT_TIME);
+                return 1;
+            case BROKER_REFUSING:
+                delay(FAKE_BROKER_REFUSE_TIME);
+                break;
+            case BROKER_UNREACHABLE:
+                delay(timeout);
+                break;
+        }
+        return 0;
+    }
+
+    using Client::write;
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (!connected()) return 0;
+        fakeBroker.receive(_session, buffer, size, timeout);
+        return size;
+    }
+
+    int available() override { return fakeBroker.pending(_session); }
+    int read() override { return fakeBroker.read(_session); }
+    using Client::read;
+    int peek() override {
+        return available() ? (uint8_t)fakeBroker.out[0] : -1;
+    }
+
+    bool stop(unsigned int maxWaitMs = 0) override {
+        fakeBroker.close(_session);
+        _session = 0;
+        return true;
+    }
+
+    uint8_t connected() override { return fakeBroker.isOpen(_session); }
+};
+
+class WiFiClass {
+   public:
+    String ssid = "HomeNet";
+    IPAddress ip = IPAddress(192, 168, 1, 42);
+
+    String SSID() const { return ssid; }
+    IPAddress localIP() const { return ip; }
+};
+
+inline WiFiClass WiFi;
+
+#endif  // _NATIVE_ESP8266_WIFI_H_
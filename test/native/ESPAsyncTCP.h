@@ -0,0 +1,151 @@
+/**
+ * ESPAsyncTCP.h (native)
+ * Benjamin Hartmann | 10/2026
+ *
+ * AsyncClient as far as MyMqttSocket uses it, its TCP connection ending at
+ * the emulated `fakeBroker`. As on the ESP8266 the callbacks only run from
+ * the system task, in delay(), yield() and fakeAdvance(), never inside a
+ * call. Connecting takes the emulated time a real connect would: a refused
+ * one a few ms, an unreachable host forever.
+ */
+
+#ifndef _NATIVE_ESP_ASYNC_TCP_H_
+#define _NATIVE_ESP_ASYNC_TCP_H_
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "FakeBroker.h"
+
+#define FAKE_TCP_SND_BUF 2920  // 2 x MSS, lwIP2 default on the ESP8266
+#define FAKE_TCP_MSS 1460
+#define FAKE_ERR_RST -14       // lwIP: connection reset (refused)
+
+class AsyncClient;
+
+typedef std::function<void(void*, AsyncClient*)> AcConnectHandler;
+typedef std::function<void(void*, AsyncClient*, int8_t error)> AcErrorHandler;
+typedef std::function<void(void*, AsyncClient*, void* data, size_t len)> AcDataHandler;
+
+class AsyncClient {
+   private:
+    enum State { CLOSED, CONNECTING, CONNECTED };
+
+    State _state = CLOSED;
+    uint32_t _session = 0;
+    unsigned long _due = 0;  // millis() of the connect result
+    bool _refused = false;
+    bool _unreachable = false;
+
+    AcConnectHandler _onConnect;
+    AcConnectHandler _onDisconnect;
+    AcErrorHandler _onError;
+    AcDataHandler _onData;
+
+    static std::vector<AsyncClient*>& clients() {
+        static std::vector<AsyncClient*> all;
+        return all;
+    }
+
+    /**
+     * Deliver what happened since the last run.
+     */
+    void poll() {
+        if (_state == CONNECTING && !_unreachable &&
+            (long)(millis() - _due) >= 0) {
+            if (!_refused && fakeBroker.isOpen(_session)) {
+                _state = CONNECTED;
+                if (_onConnect) _onConnect(nullptr, this);
+            } else {
+                _state = CLOSED;
+                if (_onError) _onError(nullptr, this, FAKE_ERR_RST);
+                if (_onDisconnect) _onDisconnect(nullptr, this);
+            }
+        }
+        if (_state != CONNECTED) return;
+        if (!fakeBroker.isOpen(_session)) {
+            _state = CLOSED;
+            if (_onDisconnect) _onDisconnect(nullptr, this);
+            return;
+        }
+        uint8_t segment[FAKE_TCP_MSS];
+        size_t length = 0;
+        int c;
+        while (length < sizeof(segment) && (c = fakeBroker.read(_session)) >= 0) {
+            segment[length++] = c;
+        }
+        if (length && _onData) _onData(nullptr, this, segment, length);
+    }
+
+    static void pollAll() {
+        static bool running = false;  // a callback may call delay()
+        if (running) return;
+        running = true;
+        for (size_t i = 0; i < clients().size(); i++) clients()[i]->poll();
+        running = false;
+    }
+
+   public:
+    AsyncClient() {
+        clients().push_back(this);
+        fakeSystemTask = pollAll;
+    }
+
+    ~AsyncClient() {
+        std::vector<AsyncClient*>& all = clients();
+        all.erase(std::find(all.begin(), all.end(), this));
+    }
+
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    void onConnect(AcConnectHandler cb, void* arg = nullptr) { _onConnect = cb; }
+    void onDisconnect(AcConnectHandler cb, void* arg = nullptr) { _onDisconnect = cb; }
+    void onError(AcErrorHandler cb, void* arg = nullptr) { _onError = cb; }
+    void onData(AcDataHandler cb, void* arg = nullptr) { _onData = cb; }
+
+    /**
+     * Start DNS and the TCP connect, the result comes as a callback.
+     */
+    bool connect(const char* host, uint16_t port) {
+        if (_state != CLOSED) return false;
+        _session = fakeBroker.open();
+        _refused = fakeBroker.state == BROKER_REFUSING;
+        _unreachable = fakeBroker.state == BROKER_UNREACHABLE;
+        _due = millis() + (_refused ? FAKE_BROKER_REFUSE_TIME : FAKE_BROKER_CONNECT_TIME);
+        _state = CONNECTING;
+        return true;
+    }
+
+    /**
+     * Closing calls the disconnect callback right away, as the library does.
+     */
+    void close(bool now = false) {
+        if (_state == CLOSED) return;
+        fakeBroker.close(_session);
+        _session = 0;
+        _state = CLOSED;
+        if (_onDisconnect) _onDisconnect(nullptr, this);
+    }
+
+    bool connected() const { return _state == CONNECTED; }
+
+    /**
+     * The broker takes every byte at once, so the send buffer is always
+     * empty.
+     */
+    size_t space() const { return _state == CONNECTED ? FAKE_TCP_SND_BUF : 0; }
+
+    size_t add(const char* data, size_t size, uint8_t apiflags = 0) {
+        if (size > space()) return 0;
+        fakeBroker.receive(_session, (const uint8_t*)data, size, 0);
+        return size;
+    }
+
+    bool send() { return _state == CONNECTED; }
+};
+
+#endif  // _NATIVE_ESP_ASYNC_TCP_H_
@@ -0,0 +1,142 @@
+/**
+ * FakeBme280.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Emulated BME280 on the native Wire bus: chip id, soft reset with its NVM
+ * copy time, the trimming parameters, ctrl/config registers and a data
+ * block holding raw ADC values the test sets. Counts the transactions
+ * MySensor makes, in particular burst reads of the data block.
+ */
+
+#ifndef _FAKE_BME280_H_
+#define _FAKE_BME280_H_
+
+#include <Wire.h>
+
+#define FAKE_BME280_NVM_COPY 1500  // µs status.im_update stays set after reset
+
+/**
+ * The factory trimming parameters (datasheet 4.2.2).
+ */
+struct Bme280Calibration {
+    uint16_t T1;
+    int16_t T2, T3;
+    uint16_t P1;
+    int16_t P2, P3, P4, P5, P6, P7, P8, P9;
+    uint8_t H1;
+    int16_t H2;
+    uint8_t H3;
+    int16_t H4, H5;
+    int8_t H6;
+};
+
+// Datasheet example (8.2) for T and P, humidity trimming of a typical part
+const Bme280Calibration bme280Datasheet = {
+    27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7,
+    15500, -14600, 6000, 75, 362, 0, 313, 50, 30};
+
+/**
+ * Lay the trimming parameters out like registers 0x88..0xA1 (`a`, 26 bytes)
+ * and 0xE1..0xE7 (`b`, 7 bytes).
+ */
+inline void bme280CalibrationBytes(const Bme280Calibration& c, uint8_t* a,
+                                   uint8_t* b) {
+    const uint16_t words[12] = {c.T1, (uint16_t)c.T2, (uint16_t)c.T3,
+                                c.P1, (uint16_t)c.P2, (uint16_t)c.P3,
+                                (uint16_t)c.P4, (uint16_t)c.P5, (uint16_t)c.P6,
+                                (uint16_t)c.P7, (uint16_t)c.P8, (uint16_t)c.P9};
+    memset(a, 0, 26);
+    for (uint8_t i = 0; i < 12; i++) {
+        a[2 * i] = words[i] & 0xFF;
+        a[2 * i + 1] = words[i] >> 8;
+    }
+    a[25] = c.H1;
+    b[0] = c.H2 & 0xFF;
+    b[1] = (uint16_t)c.H2 >> 8;
+    b[2] = c.H3;
+    b[3] = (uint16_t)c.H4 >> 4 & 0xFF;
+    b[4] = (c.H4 & 0x0F) | (c.H5 & 0x0F) << 4;
+    b[5] = (uint16_t)c.H5 >> 4 & 0xFF;
+    b[6] = (uint8_t)c.H6;
+}
+
+class FakeBme280 : public TwoWireSlave {
+   private:
+    uint8_t _registers[256];
+    uint8_t _pointer = 0;
+    uint64_t _resetAt = 0;  // fakeMicros of the last soft reset
+
+    void reset() {
+        memset(_registers, 0, sizeof(_registers));
+        _registers[0xD0] = 0x60;  // chip id
+        bme280CalibrationBytes(calibration, _registers + 0x88, _registers + 0xE1);
+        setRaw(adcT, adcP, adcH);
+        _resetAt = fakeMicros;
+        resets++;
+    }
+
+   public:
+    Bme280Calibration calibration = bme280Datasheet;
+    int32_t adcT = 519888;  // datasheet example: 25.08 °C
+    int32_t adcP = 415148;  // 100653 Pa
+    int32_t adcH = 30000;
+
+    uint32_t resets = 0;
+    uint32_t dataReads = 0;    // read transactions starting at 0xF7
+    uint32_t ctrlMeasWrites = 0;
+
+    FakeBme280() {
+        reset();
+        resets = 0;  // power-on
+    }
+
+    /**
+     * Set the raw values the next read of the data block returns.
+     */
+    void setRaw(int32_t t, int32_t p, int32_t h) {
+        adcT = t;
+        adcP = p;
+        adcH = h;
+        uint8_t* d = _registers + 0xF7;
+        d[0] = p >> 12;
+        d[1] = p >> 4;
+        d[2] = p << 4;
+        d[3] = t >> 12;
+        d[4] = t >> 4;
+        d[5] = t << 4;
+        d[6] = h >> 8;
+        d[7] = h;
+    }
+
+    uint8_t getRegister(uint8_t reg) const { return _registers[reg]; }
+
+    /**
+     * A register pointer, optionally followed by register/value pairs
+     * (the BME280 does not auto-increment on writes).
+     */
+    void receive(const uint8_t* bytes, size_t length) override {
+        if (!length) return;
+        _pointer = bytes[0];
+        if (length == 1 && _pointer == 0xF7) dataReads++;
+        for (size_t i = 1; i < length; i += 2) {
+            uint8_t reg = bytes[i - 1];
+            uint8_t value = bytes[i];
+            if (reg == 0xE0) {
+                if (value == 0xB6) reset();
+            } else if (reg == 0xF2 || reg == 0xF4 || reg == 0xF5) {
+                _registers[reg] = value;
+                if (reg == 0xF4) ctrlMeasWrites++;
+            }
+        }
+    }
+
+    uint8_t transmit() override {
+        uint8_t reg = _pointer++;
+        if (reg == 0xF3) {
+            return fakeMicros - _resetAt < FAKE_BME280_NVM_COPY ? 0x01 : 0x00;
+        }
+        return _registers[reg];
+    }
+};
+
+#endif  // _FAKE_BME280_H_
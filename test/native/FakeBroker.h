@@ -0,0 +1,230 @@
+/**
+ * FakeBroker.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * An MQTT broker at the byte level, `fakeBroker`, behind the native
+ * WiFiClient and AsyncClient. It parses the packets a client writes (CONNECT, PUBLISH,
+ * SUBSCRIBE, PINGREQ, DISCONNECT) and queues the answers the client reads.
+ * A test takes it up and down and looks at what reached it. It serves one
+ * connection at a time, a new one replaces the old.
+ */
+
+#ifndef _NATIVE_FAKE_BROKER_H_
+#define _NATIVE_FAKE_BROKER_H_
+
+#include <Arduino.h>
+
+#include <string>
+#include <vector>
+
+#define FAKE_BROKER_CONNECT_TIME 2  // ms for DNS and TCP to a broker that is up
+#define FAKE_BROKER_REFUSE_TIME 5   // ms until a closed port answers
+#define FAKE_BROKER_PACKET_SIZE 1024
+
+enum FakeBrokerState {
+    BROKER_UP,
+    BROKER_REFUSING,    // host up, nothing listens on the port
+    BROKER_UNREACHABLE, // no answer at all
+    BROKER_SILENT,      // accepts TCP, never sends CONNACK
+    BROKER_REJECTING,   // accepts TCP, refuses CONNECT (bad credentials)
+};
+
+struct FakeMqttMessage {
+    std::string topic;
+    std::string payload;
+    bool retain;
+};
+
+/**
+ * The broker every client talks to.
+ */
+struct FakeBroker {
+    FakeBrokerState state = BROKER_UP;
+    std::vector<FakeMqttMessage> messages;  // received publishes
+    std::vector<FakeMqttMessage> inbox;     // to deliver to the client
+    std::vector<std::string> subscriptions;
+    uint32_t attempts = 0;   // TCP connects
+    uint32_t connects = 0;   // CONNECTs accepted
+    uint32_t rejected = 0;   // CONNECTs refused
+    uint32_t published = 0;
+    uint32_t bytes = 0;      // received from the client
+    bool keep = true;  // store publishes in `messages`, which allocates
+    unsigned long publishTimeout = 0;  // client timeout at the last publish
+
+    // The current connection
+    uint32_t session = 0;  // 0: none
+    bool accepted = false;  // CONNACK sent
+    uint8_t in[FAKE_BROKER_PACKET_SIZE];
+    size_t inLength = 0;
+    std::string out;  // to the client, not yet read
+
+    void reset() { *this = FakeBroker(); }
+
+    /**
+     * Accept a TCP connection.
+     * @return session id, 0 if the broker is not there
+     */
+    uint32_t open() {
+        attempts++;
+        if (state == BROKER_REFUSING || state == BROKER_UNREACHABLE) return 0;
+        session = attempts;
+        accepted = false;
+        inLength = 0;
+        out.clear();
+        return session;
+    }
+
+    /**
+     * Whether the connection `id` is still open: the broker has not gone
+     * away or been replaced since.
+     */
+    bool isOpen(uint32_t id) {
+        if (id != session) return false;
+        if (state == BROKER_UP || (state != BROKER_REFUSING &&
+                                   state != BROKER_UNREACHABLE && !accepted)) {
+            return true;
+        }
+        session = 0;
+        return false;
+    }
+
+    void close(uint32_t id) {
+        if (id == session) session = 0;
+    }
+
+    /**
+     * Bytes from the client on connection `id`, whose socket timeout is
+     * `timeout`.
+     */
+    void receive(uint32_t id, const uint8_t* data, size_t length,
+                 unsigned long timeout) {
+        if (!isOpen(id)) return;
+        bytes += length;
+        while (length) {
+            size_t n = std::min(length, sizeof(in) - inLength);
+            memcpy(in + inLength, data, n);
+            inLength += n;
+            data += n;
+            length -= n;
+            size_t used;
+            while ((used = packet(timeout))) {
+                memmove(in, in + used, inLength - used);
+                inLength -= used;
+            }
+            if (inLength == sizeof(in)) inLength = 0;  // too long, drop
+        }
+    }
+
+    /**
+     * Bytes for the client on connection `id`, including the inbox once
+     * it is connected.
+     */
+    size_t pending(uint32_t id) {
+        if (!isOpen(id)) return 0;
+        if (accepted) {
+            for (const FakeMqttMessage& m : inbox) {
+                std::string body;
+                body += (char)(m.topic.size() >> 8);
+                body += (char)(m.topic.size() & 0xFF);
+                body += m.topic;
+                body += m.payload;
+                send(0x30, body);
+            }
+            inbox.clear();
+        }
+        return out.size();
+    }
+
+    int read(uint32_t id) {
+        if (!pending(id)) return -1;
+        uint8_t c = out[0];
+        out.erase(0, 1);
+        return c;
+    }
+
+    /**
+     * Messages received on topics ending with `name`.
+     */
+    std::vector<FakeMqttMessage> on(const std::string& name) const {
+        std::vector<FakeMqttMessage> found;
+        for (const FakeMqttMessage& m : messages) {
+            if (m.topic.size() >= name.size() &&
+                m.topic.compare(m.topic.size() - name.size(), name.size(), name) == 0) {
+                found.push_back(m);
+            }
+        }
+        return found;
+    }
+
+   private:
+    void send(uint8_t header, const std::string& body) {
+        out += (char)header;
+        size_t length = body.size();
+        do {
+            uint8_t digit = length % 128;
+            length /= 128;
+            out += (char)(length ? digit | 0x80 : digit);
+        } while (length);
+        out += body;
+    }
+
+    /**
+     * Handle the packet at the start of `in`.
+     * @return its size, 0 if it is not complete yet
+     */
+    size_t packet(unsigned long timeout) {
+        size_t pos = 1;
+        size_t length = 0;
+        uint32_t multiplier = 1;
+        do {
+            if (pos >= inLength) return 0;
+            length += (in[pos] & 0x7F) * multiplier;
+            multiplier *= 128;
+        } while (in[pos++] & 0x80);
+        if (pos + length > inLength) return 0;
+
+        const uint8_t* body = in + pos;
+        switch (in[0] >> 4) {
+            case 1:  // CONNECT
+                if (state == BROKER_UP) {
+                    accepted = true;
+                    connects++;
+                    send(0x20, std::string("\0\0", 2));
+                } else if (state == BROKER_REJECTING) {
+                    rejected++;
+                    send(0x20, std::string("\0\5", 2));  // not authorized
+                }
+                break;
+            case 3: {  // PUBLISH
+                size_t topicLength = body[0] << 8 | body[1];
+                size_t offset = 2 + topicLength + ((in[0] >> 1 & 3) ? 2 : 0);
+                published++;
+                publishTimeout = timeout;
+                if (keep) {
+                    messages.push_back(
+                        {std::string((const char*)body + 2, topicLength),
+                         std::string((const char*)body + offset, length - offset),
+                         (bool)(in[0] & 1)});
+                }
+                break;
+            }
+            case 8: {  // SUBSCRIBE
+                size_t topicLength = body[2] << 8 | body[3];
+                subscriptions.push_back(std::string((const char*)body + 4, topicLength));
+                send(0x90, std::string((const char*)body, 2) + (char)body[4 + topicLength]);
+                break;
+            }
+            case 12:  // PINGREQ
+                send(0xD0, "");
+                break;
+            case 14:  // DISCONNECT
+                session = 0;
+                break;
+        }
+        return pos + length;
+    }
+};
+
+inline FakeBroker fakeBroker;
+
+#endif  // _NATIVE_FAKE_BROKER_H_
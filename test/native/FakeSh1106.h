@@ -0,0 +1,232 @@
+/**
+ * FakeSh1106.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Emulated SH1106 controller on the native Wire bus: decodes the command
+ * and data streams (page address, column address, contrast, display on/off)
+ * into its 132x64 display RAM, and counts what it received. frame() is the
+ * visible 128x64 window in the GFX buffer layout, so it can be compared with
+ * golden images and dumped as PBM or PNG.
+ */
+
+#ifndef _FAKE_SH1106_H_
+#define _FAKE_SH1106_H_
+
+#include <Wire.h>
+
+#include <string>
+
+#define SH1106_RAM_COLUMNS 132
+#define SH1106_PAGES 8
+#define SH1106_COLUMN_OFFSET 2
+#define SH1106_FRAME_WIDTH 128
+#define SH1106_FRAME_HEIGHT 64
+#define SH1106_FRAME_SIZE (SH1106_FRAME_WIDTH * SH1106_PAGES)
+
+class FakeSh1106 : public TwoWireSlave {
+   private:
+    uint8_t _page = 0;
+    uint8_t _column = 0;
+    uint8_t _pending = 0;  // command waiting for its parameter byte
+
+    void command(uint8_t c) {
+        if (_pending) {
+            if (_pending == 0x81) contrast = c;
+            _pending = 0;
+        } else if (c >= 0xB0 && c <= 0xB7) {
+            _page = c & 0x07;
+        } else if (c <= 0x0F) {
+            _column = (_column & 0xF0) | c;
+        } else if (c >= 0x10 && c <= 0x1F) {
+            _column = (_column & 0x0F) | (c & 0x0F) << 4;
+        } else if (c == 0xAE || c == 0xAF) {
+            on = c == 0xAF;
+        } else if (c == 0x81 || c == 0xA8 || c == 0xAD || c == 0xD3 ||
+                   c == 0xD5 || c == 0xD9 || c == 0xDA || c == 0xDB) {
+            _pending = c;  // double byte command
+        }
+    }
+
+    void data(uint8_t d) {
+        if (_column < SH1106_RAM_COLUMNS) ram[_page][_column] = d;
+        _column++;  // stops advancing the RAM past its last column
+        dataBytes++;
+    }
+
+   public:
+    uint8_t ram[SH1106_PAGES][SH1106_RAM_COLUMNS] = {};
+    uint8_t contrast = 0x80;
+    bool on = false;
+    uint32_t dataBytes = 0;  // display RAM bytes written
+
+    /**
+     * A transaction is a control byte followed by a command stream
+     * (0x00), a data stream (0x40), or a single command (Co = 1, 0x80)
+     * after which another control byte follows.
+     */
+    void receive(const uint8_t* bytes, size_t length) override {
+        size_t i = 0;
+        while (i < length) {
+            uint8_t control = bytes[i++];
+            bool single = control & 0x80;
+            bool isData = control & 0x40;
+            for (; i < length; i++) {
+                if (isData) {
+                    data(bytes[i]);
+                } else {
+                    command(bytes[i]);
+                }
+                if (single) {
+                    i++;
+                    break;
+                }
+            }
+        }
+    }
+
+    uint8_t transmit() override { return 0; }  // status reads are not used
+
+    /**
+     * Copy the visible 128x64 window, one byte per column and page, LSB at
+     * the top.
+     */
+    void frame(uint8_t* out) const {
+        for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+            memcpy(out + page * SH1106_FRAME_WIDTH,
+                   ram[page] + SH1106_COLUMN_OFFSET, SH1106_FRAME_WIDTH);
+        }
+    }
+
+    static bool pixel(const uint8_t* frame, uint8_t x, uint8_t y) {
+        return frame[(y / 8) * SH1106_FRAME_WIDTH + x] & 1 << (y & 7);
+    }
+
+    /**
+     * Plain PBM (P1), lit pixels as 1, one image row per line. Same format
+     * as MyDisplay::printPbm() without the comment.
+     */
+    static std::string toPbm(const uint8_t* frame) {
+        std::string pbm = "P1\n128 64\n";
+        for (uint8_t y = 0; y < SH1106_FRAME_HEIGHT; y++) {
+            for (uint8_t x = 0; x < SH1106_FRAME_WIDTH; x++) {
+                pbm += pixel(frame, x, y) ? '1' : '0';
+            }
+            pbm += '\n';
+        }
+        return pbm;
+    }
+
+    /**
+     * Read a plain PBM of 128x64 pixels, comments and any whitespace
+     * allowed.
+     * @return false if the file is missing or not such an image
+     */
+    static bool readPbm(const char* path, uint8_t* frame) {
+        FILE* f = fopen(path, "r");
+        if (!f) return false;
+        std::string tokens;
+        char line[512];
+        while (fgets(line, sizeof(line), f)) {
+            if (line[0] != '#') tokens += line;
+        }
+        fclose(f);
+
+        unsigned width, height;
+        int offset;
+        if (sscanf(tokens.c_str(), " P1 %u %u%n", &width, &height, &offset) != 2 ||
+            width != SH1106_FRAME_WIDTH || height != SH1106_FRAME_HEIGHT) {
+            return false;
+        }
+        memset(frame, 0, SH1106_FRAME_SIZE);
+        uint16_t n = 0;
+        for (size_t i = offset; i < tokens.size() && n < width * height; i++) {
+            char c = tokens[i];
+            if (c != '0' && c != '1') continue;
+            if (c == '1') {
+                frame[(n / width / 8) * width + n % width] |= 1 << (n / width & 7);
+            }
+            n++;
+        }
+        return n == width * height;
+    }
+
+    static bool writePbm(const char* path, const uint8_t* frame) {
+        FILE* f = fopen(path, "w");
+        if (!f) return false;
+        std::string pbm = toPbm(frame);
+        bool ok = fwrite(pbm.data(), 1, pbm.size(), f) == pbm.size();
+        return fclose(f) == 0 && ok;
+    }
+
+    /**
+     * Write the frame as 8 bit grayscale PNG, each pixel `scale` x `scale`,
+     * lit pixels white. Stored (uncompressed) deflate blocks, so no zlib is
+     * needed.
+     */
+    static bool writePng(const char* path, const uint8_t* frame,
+                         uint8_t scale = 4) {
+        uint32_t width = SH1106_FRAME_WIDTH * scale;
+        uint32_t height = SH1106_FRAME_HEIGHT * scale;
+        std::string raw;
+        for (uint32_t y = 0; y < height; y++) {
+            raw += '\0';  // filter: none
+            for (uint32_t x = 0; x < width; x++) {
+                raw += pixel(frame, x / scale, y / scale) ? '\xFF' : '\0';
+            }
+        }
+
+        std::string zlib = "\x78\x01";
+        for (size_t i = 0; i < raw.size(); i += 0xFFFF) {
+            uint16_t n = min<size_t>(0xFFFF, raw.size() - i);
+            zlib += (char)(i + n == raw.size());
+            zlib += (char)(n & 0xFF);
+            zlib += (char)(n >> 8);
+            zlib += (char)(~n & 0xFF);
+            zlib += (char)(~n >> 8 & 0xFF);
+            zlib.append(raw, i, n);
+        }
+        uint32_t a = 1, b = 0;
+        for (unsigned char c : raw) {
+            a = (a + c) % 65521;
+            b = (b + a) % 65521;
+        }
+        appendBigEndian(zlib, b << 16 | a);
+
+        std::string ihdr;
+        appendBigEndian(ihdr, width);
+        appendBigEndian(ihdr, height);
+        ihdr += std::string("\x08\x00\x00\x00\x00", 5);  // 8 bit gray
+
+        std::string png = "\x89PNG\r\n\x1A\n";
+        appendChunk(png, "IHDR", ihdr);
+        appendChunk(png, "IDAT", zlib);
+        appendChunk(png, "IEND", "");
+
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        bool ok = fwrite(png.data(), 1, png.size(), f) == png.size();
+        return fclose(f) == 0 && ok;
+    }
+
+   private:
+    static void appendBigEndian(std::string& s, uint32_t v) {
+        for (int8_t shift = 24; shift >= 0; shift -= 8) s += (char)(v >> shift);
+    }
+
+    static void appendChunk(std::string& png, const char* type,
+                            const std::string& data) {
+        appendBigEndian(png, data.size());
+        std::string body = std::string(type, 4) + data;
+        uint32_t crc = 0xFFFFFFFF;
+        for (unsigned char c : body) {
+            crc ^= c;
+            for (uint8_t k = 0; k < 8; k++) {
+                crc = crc & 1 ? 0xEDB88320 ^ (crc >> 1) : crc >> 1;
+            }
+        }
+        png += body;
+        appendBigEndian(png, ~crc);
+    }
+};
+
+#endif  // _FAKE_SH1106_H_
@@ -0,0 +1,59 @@
+/**
+ * GoldenFrame.h
+ * Benjamin Hartmann | 10/2026
+ *
+ * Compares a 128x64 frame with the golden image golden/<name>.pbm next to
+ * the test. UPDATE_GOLDEN=1 rewrites the golden instead, FRAME_DUMP_DIR=<dir>
+ * also writes the frame there as PBM and PNG.
+ */
+
+#ifndef _GOLDEN_FRAME_H_
+#define _GOLDEN_FRAME_H_
+
+#include <unity.h>
+
+#include <string>
+
+#include "FakeSh1106.h"
+
+/**
+ * Fail unless `frame` matches golden/<name>.pbm.
+ * @param testFile __FILE__ of the test, the goldens live next to it
+ */
+inline void expectGoldenFrame(const char* testFile, const char* name,
+                              const uint8_t* frame) {
+    const char* dump = getenv("FRAME_DUMP_DIR");
+    if (dump) {
+        std::string path = std::string(dump) + "/" + name;
+        FakeSh1106::writePbm((path + ".pbm").c_str(), frame);
+        FakeSh1106::writePng((path + ".png").c_str(), frame);
+    }
+
+    std::string golden = testFile;
+    golden = golden.substr(0, golden.find_last_of('/') + 1) + "golden/" +
+             name + ".pbm";
+    if (getenv("UPDATE_GOLDEN")) {
+        TEST_ASSERT_TRUE_MESSAGE(FakeSh1106::writePbm(golden.c_str(), frame),
+                                 golden.c_str());
+        return;
+    }
+    uint8_t expected[SH1106_FRAME_SIZE];
+    if (!FakeSh1106::readPbm(golden.c_str(), expected)) {
+        std::string message = "missing " + golden + ", run with UPDATE_GOLDEN=1";
+        TEST_FAIL_MESSAGE(message.c_str());
+    }
+    uint16_t differ = 0;
+    for (uint8_t y = 0; y < SH1106_FRAME_HEIGHT; y++) {
+        for (uint8_t x = 0; x < SH1106_FRAME_WIDTH; x++) {
+            differ += FakeSh1106::pixel(frame, x, y) != FakeSh1106::pixel(expected, x, y);
+        }
+    }
+    char message[160];
+    snprintf(message, sizeof(message),
+             "%s: %u pixels differ from the golden image, set FRAME_DUMP_DIR "
+             "to see the frame",
+             name, differ);
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(0, differ, message);
+}
+
+#endif  // _GOLDEN_FRAME_H_
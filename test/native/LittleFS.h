@@ -0,0 +1,169 @@
+/**
+ * LittleFS.h (native)
+ * Benjamin Hartmann | 10/2026
+ *
+ * LittleFS for the [env:native] host build, backed by a directory on the
+ * host (a fresh one under /tmp per run), so files survive a "reboot" of the
+ * object under test. Besides the bytes the code writes, it estimates what
+ * the flash sees: LittleFS rewrites the partly filled last block of a file
+ * on every append, so each open for append costs that tail again.
+ */
+
+#ifndef _NATIVE_LITTLEFS_H_
+#define _NATIVE_LITTLEFS_H_
+
+#include <Arduino.h>
+
+#include <filesystem>
+
+#define FAKE_LITTLEFS_BLOCK 8192  // ESP8266 LittleFS block size
+
+class File {
+   private:
+    FILE* _f = nullptr;
+
+   public:
+    File() {}
+    explicit File(FILE* f) : _f(f) {}
+
+    explicit operator bool() const { return _f != nullptr; }
+
+    size_t read(uint8_t* buf, size_t size);
+
+    size_t write(const uint8_t* buf, size_t size);
+
+    size_t write(uint8_t c) { return write(&c, 1); }
+
+    bool seek(uint32_t pos) {
+        return _f && pos <= size() && fseek(_f, pos, SEEK_SET) == 0;
+    }
+
+    size_t position() const { return _f ? ftell(_f) : 0; }
+
+    size_t size() const {
+        if (!_f) return 0;
+        long pos = ftell(_f);
+        fseek(_f, 0, SEEK_END);
+        long end = ftell(_f);
+        fseek(_f, pos, SEEK_SET);
+        return end;
+    }
+
+    int available() { return _f ? size() - position() : 0; }
+
+    void close() {
+        if (_f) fclose(_f);
+        _f = nullptr;
+    }
+};
+
+class Dir {
+   private:
+    std::filesystem::directory_iterator _it;
+    std::filesystem::directory_iterator _end;
+    std::string _name;
+    bool _started = false;
+
+   public:
+    Dir() {}
+    explicit Dir(const std::string& path) {
+        std::error_code error;
+        _it = std::filesystem::directory_iterator(path, error);
+    }
+
+    bool next() {
+        if (_started && _it != _end) _it++;
+        _started = true;
+        if (_it == _end) return false;
+        _name = _it->path().filename().string();
+        return true;
+    }
+
+    String fileName() const { return String(_name); }
+};
+
+class FS {
+   private:
+    std::string _root;
+
+    std::string path(const String& p) const {
+        return root() + (p.c_str()[0] == '/' ? "" : "/") + p.c_str();
+    }
+
+   public:
+    uint32_t bytesWritten = 0;  // bytes the code wrote
+    uint32_t flashBytes = 0;    // estimated bytes programmed, see above
+    uint32_t appends = 0;       // opens for writing
+    uint32_t bytesRead = 0;     // bytes the code read
+
+    const std::string& root() const {
+        if (_root.empty()) {
+            char dir[] = "/tmp/littlefs-XXXXXX";
+            const_cast<FS*>(this)->_root = mkdtemp(dir);
+        }
+        return _root;
+    }
+
+    bool begin() { return true; }
+
+    /**
+     * Remove every file, e.g. between tests.
+     */
+    bool format() {
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(root())) {
+            std::filesystem::remove_all(entry.path(), error);
+        }
+        bytesWritten = flashBytes = appends = bytesRead = 0;
+        return true;
+    }
+
+    File open(const String& p, const char* mode) {
+        std::string full = path(p);
+        if (mode[0] == 'a' || mode[0] == 'w') {
+            std::error_code error;
+            size_t size = mode[0] == 'a' && std::filesystem::exists(full)
+                              ? std::filesystem::file_size(full, error)
+                              : 0;
+            flashBytes += size % FAKE_LITTLEFS_BLOCK;  // tail copied again
+            appends++;
+        }
+        std::string m = mode[0] == 'r' ? "rb" : mode[0] == 'a' ? "ab" : "wb";
+        return File(fopen(full.c_str(), m.c_str()));
+    }
+
+    bool exists(const String& p) const {
+        return std::filesystem::exists(path(p));
+    }
+
+    bool mkdir(const String& p) {
+        std::error_code error;
+        return std::filesystem::create_directories(path(p), error);
+    }
+
+    bool remove(const String& p) {
+        std::error_code error;
+        return std::filesystem::remove(path(p), error);
+    }
+
+    Dir openDir(const String& p) { return Dir(path(p)); }
+};
+
+inline FS LittleFS;
+
+inline size_t File::read(uint8_t* buf, size_t size) {
+    if (!_f) return 0;
+    size_t n = fread(buf, 1, size, _f);
+    LittleFS.bytesRead += n;
+    return n;
+}
+
+inline size_t File::write(const uint8_t* buf, size_t size) {
+    if (!_f) return 0;
+    size_t n = fwrite(buf, 1, size, _f);
+    LittleFS.bytesWritten += n;
+    LittleFS.flashBytes += n;
+    return n;
+}
+
+#endif  // _NATIVE_LITTLEFS_H_
@@ -0,0 +1,16 @@
+/**
+ * MqttCredentials.h (native)
+ * Benjamin Hartmann | 10/2026
+ *
+ * Broker settings for the [env:native] host build, see README.
+ */
+
+#ifndef _NATIVE_MQTT_CREDENTIALS_H_
+#define _NATIVE_MQTT_CREDENTIALS_H_
+
+#define MY_MQTT_BROKER "broker.test"
+#define MY_MQTT_PORT 1883
+#define MY_MQTT_USERNAME "test"
+#define MY_MQTT_PASSWORD "test"
+
+#endif  // _NATIVE_MQTT_CREDENTIALS_H_
@@ -0,0 +1,322 @@
+/**
+ * PubSubClient.h (native)
+ * Benjamin Hartmann | 10/2026
+ *
+ * The part of PubSubClient 2.8 MyMqtt uses, following the library: packets
+ * are built in the packet buffer and written to the Client in one write(),
+ * connect() waits for the CONNACK for up to the socket timeout, loop()
+ * keeps the connection alive and delivers incoming publishes. On the
+ * native build the Client is usually an AsyncClient talking to `fakeBroker`.
+ * The waits advance the emulated clock, which only moves when something
+ * advances it.
+ */
+
+#ifndef _NATIVE_PUBSUBCLIENT_H_
+#define _NATIVE_PUBSUBCLIENT_H_
+
+#include <ESP8266WiFi.h>
+
+#include <functional>
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+#define MQTT_MAX_PACKET_SIZE 256
+#define MQTT_MAX_HEADER_SIZE 5
+#define MQTT_KEEPALIVE 15       // s, library default
+#define MQTT_SOCKET_TIMEOUT 15  // s, library default
+
+#define MQTTCONNECT 1 << 4
+#define MQTTPUBLISH 3 << 4
+#define MQTTSUBSCRIBE 8 << 4
+#define MQTTPINGREQ 12 << 4
+#define MQTTPINGRESP 13 << 4
+#define MQTTDISCONNECT 14 << 4
+#define MQTTQOS1 1 << 1
+
+#define MQTT_CALLBACK_SIGNATURE \
+    std::function<void(char*, uint8_t*, unsigned int)> callback
+
+class PubSubClient {
+   private:
+    Client* _client;
+    uint8_t* _buffer = nullptr;
+    uint16_t _bufferSize = 0;
+    uint16_t _keepAlive = MQTT_KEEPALIVE;
+    uint16_t _socketTimeout = MQTT_SOCKET_TIMEOUT;
+    uint16_t _nextMsgId = 0;
+    unsigned long _lastOutActivity = 0;
+    unsigned long _lastInActivity = 0;
+    bool _pingOutstanding = false;
+    MQTT_CALLBACK_SIGNATURE;
+    const char* _domain = nullptr;
+    uint16_t _port = 0;
+    int _state = MQTT_DISCONNECTED;
+
+    /**
+     * Wait for one byte for up to the socket timeout.
+     */
+    bool readByte(uint8_t* result) {
+        unsigned long start = millis();
+        while (!_client->available()) {
+            if (millis() - start >= _socketTimeout * 1000UL) return false;
+            delay(1);
+        }
+        *result = _client->read();
+        return true;
+    }
+
+    /**
+     * Read a whole packet into the buffer.
+     * @return its length, 0 on a timeout
+     */
+    uint32_t readPacket() {
+        uint16_t length = 0;
+        if (!readByte(&_buffer[length++])) return 0;
+        uint32_t remaining = 0;
+        uint32_t multiplier = 1;
+        uint8_t digit;
+        do {
+            if (!readByte(&digit)) return 0;
+            _buffer[length++] = digit;
+            remaining += (digit & 127) * multiplier;
+            multiplier <<= 7;
+        } while (digit & 128);
+        for (uint32_t i = 0; i < remaining; i++) {
+            if (!readByte(&digit)) return 0;
+            if (length < _bufferSize) _buffer[length++] = digit;
+        }
+        _lastInActivity = millis();
+        return length;
+    }
+
+    /**
+     * Prepend the fixed header to the `length` bytes behind the
+     * MQTT_MAX_HEADER_SIZE reserved ones and write the packet.
+     */
+    bool write(uint8_t header, uint16_t length) {
+        uint8_t lengthBytes[4];
+        uint8_t count = 0;
+        uint16_t remaining = length;
+        do {
+            uint8_t digit = remaining & 127;
+            remaining >>= 7;
+            lengthBytes[count++] = remaining ? digit | 128 : digit;
+        } while (remaining);
+
+        uint8_t start = MQTT_MAX_HEADER_SIZE - 1 - count;
+        _buffer[start] = header;
+        memcpy(_buffer + start + 1, lengthBytes, count);
+        size_t size = 1 + count + length;
+        size_t written = _client->write(_buffer + start, size);
+        _lastOutActivity = millis();
+        return written == size;
+    }
+
+    uint16_t writeString(const char* string, uint16_t pos) {
+        uint16_t length = strlen(string);
+        _buffer[pos++] = length >> 8;
+        _buffer[pos++] = length & 0xFF;
+        memcpy(_buffer + pos, string, length);
+        return pos + length;
+    }
+
+   public:
+    PubSubClient(Client& client) : _client(&client) {
+        setBufferSize(MQTT_MAX_PACKET_SIZE);
+    }
+
+    ~PubSubClient() { free(_buffer); }
+
+    PubSubClient& setServer(const char* domain, uint16_t port) {
+        _domain = domain;
+        _port = port;
+        return *this;
+    }
+
+    PubSubClient& setClient(Client& client) {
+        _client = &client;
+        return *this;
+    }
+
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE) {
+        this->callback = callback;
+        return *this;
+    }
+
+    PubSubClient& setKeepAlive(uint16_t keepAlive) {
+        _keepAlive = keepAlive;
+        return *this;
+    }
+
+    PubSubClient& setSocketTimeout(uint16_t timeout) {
+        _socketTimeout = timeout;
+        return *this;
+    }
+
+    bool setBufferSize(uint16_t size) {
+        if (!size) return false;
+        uint8_t* buffer = (uint8_t*)realloc(_buffer, size);
+        if (!buffer) return false;
+        _buffer = buffer;
+        _bufferSize = size;
+        return true;
+    }
+
+    uint16_t getBufferSize() const { return _bufferSize; }
+
+    bool connect(const char* id) {
+        return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr);
+    }
+
+    bool connect(const char* id, const char* user, const char* pass,
+                 const char* willTopic, uint8_t willQos, bool willRetain,
+                 const char* willMessage) {
+        if (connected()) return true;
+        int result = _domain ? _client->connect(_domain, _port)
+                             : _client->connect(IPAddress(), _port);
+        if (result != 1) {
+            _state = MQTT_CONNECT_FAILED;
+            return false;
+        }
+
+        _nextMsgId = 1;
+        uint16_t length = MQTT_MAX_HEADER_SIZE;
+        const uint8_t protocol[] = {0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04};
+        memcpy(_buffer + length, protocol, sizeof(protocol));
+        length += sizeof(protocol);
+        uint8_t flags = 0x02;  // clean session
+        if (willTopic) flags |= 0x04 | willQos << 3 | (willRetain ? 0x20 : 0);
+        if (user) flags |= 0x80 | (pass ? 0x40 : 0);
+        _buffer[length++] = flags;
+        _buffer[length++] = _keepAlive >> 8;
+        _buffer[length++] = _keepAlive & 0xFF;
+        length = writeString(id, length);
+        if (willTopic) {
+            length = writeString(willTopic, length);
+            length = writeString(willMessage, length);
+        }
+        if (user) {
+            length = writeString(user, length);
+            if (pass) length = writeString(pass, length);
+        }
+        write(MQTTCONNECT, length - MQTT_MAX_HEADER_SIZE);
+
+        _lastInActivity = _lastOutActivity = millis();
+        while (!_client->available()) {
+            if (millis() - _lastInActivity >= _socketTimeout * 1000UL) {
+                _state = MQTT_CONNECTION_TIMEOUT;
+                _client->stop();
+                return false;
+            }
+            delay(1);
+        }
+        if (readPacket() == 4) {
+            if (_buffer[3] == 0) {
+                _pingOutstanding = false;
+                _state = MQTT_CONNECTED;
+                return true;
+            }
+            _state = _buffer[3];
+        }
+        _client->stop();
+        return false;
+    }
+
+    bool connected() {
+        if (!_client->connected()) {
+            if (_state == MQTT_CONNECTED) {
+                _state = MQTT_CONNECTION_LOST;
+                _client->flush();
+                _client->stop();
+            }
+            return false;
+        }
+        return _state == MQTT_CONNECTED;
+    }
+
+    int state() const { return _state; }
+
+    void disconnect() {
+        _buffer[0] = MQTTDISCONNECT;
+        _buffer[1] = 0;
+        _client->write(_buffer, 2);
+        _state = MQTT_DISCONNECTED;
+        _client->flush();
+        _client->stop();
+    }
+
+    bool loop() {
+        if (!connected()) return false;
+        unsigned long t = millis();
+        if (t - _lastInActivity > _keepAlive * 1000UL ||
+            t - _lastOutActivity > _keepAlive * 1000UL) {
+            if (_pingOutstanding) {
+                _state = MQTT_CONNECTION_TIMEOUT;
+                _client->stop();
+                return false;
+            }
+            _buffer[0] = MQTTPINGREQ;
+            _buffer[1] = 0;
+            _client->write(_buffer, 2);
+            _lastOutActivity = _lastInActivity = t;
+            _pingOutstanding = true;
+        }
+        if (_client->available()) {
+            uint32_t length = readPacket();
+            uint8_t type = _buffer[0] & 0xF0;
+            if (length && type == MQTTPUBLISH && callback) {
+                uint8_t lengthBytes = 1;
+                while (_buffer[lengthBytes] & 128) lengthBytes++;
+                uint16_t topicLength = _buffer[lengthBytes + 1] << 8 | _buffer[lengthBytes + 2];
+                uint16_t topicStart = lengthBytes + 3;
+                // The library moves the topic one byte down to terminate it
+                memmove(_buffer + topicStart - 1, _buffer + topicStart, topicLength);
+                _buffer[topicStart - 1 + topicLength] = '\0';
+                uint16_t payload = topicStart + topicLength;
+                callback((char*)_buffer + topicStart - 1, _buffer + payload,
+                         length - payload);
+            } else if (length && type == MQTTPINGREQ) {
+                _buffer[0] = MQTTPINGRESP;
+                _buffer[1] = 0;
+                _client->write(_buffer, 2);
+            } else if (length && type == MQTTPINGRESP) {
+                _pingOutstanding = false;
+            }
+        }
+        return true;
+    }
+
+    bool subscribe(const char* topic, uint8_t qos = 0) {
+        if (!connected()) return false;
+        if (_bufferSize < MQTT_MAX_HEADER_SIZE + 4 + strlen(topic) + 1) return false;
+        uint16_t length = MQTT_MAX_HEADER_SIZE;
+        if (++_nextMsgId == 0) _nextMsgId = 1;
+        _buffer[length++] = _nextMsgId >> 8;
+        _buffer[length++] = _nextMsgId & 0xFF;
+        length = writeString(topic, length);
+        _buffer[length++] = qos;
+        return write(MQTTSUBSCRIBE | MQTTQOS1, length - MQTT_MAX_HEADER_SIZE);
+    }
+
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length,
+                 bool retained) {
+        if (!connected()) return false;
+        if (_bufferSize < MQTT_MAX_HEADER_SIZE + 2 + strlen(topic) + length) {
+            return false;
+        }
+        uint16_t pos = writeString(topic, MQTT_MAX_HEADER_SIZE);
+        memcpy(_buffer + pos, payload, length);
+        pos += length;
+        return write(MQTTPUBLISH | (retained ? 1 : 0), pos - MQTT_MAX_HEADER_SIZE);
+    }
+
+    bool publish(const char* topic, const char* payload) {
+        return publish(topic, (const uint8_t*)payload, strlen(payload), false);
+    }
+};
+
+#endif  // _NATIVE_PUBSUBCLIENT_H_
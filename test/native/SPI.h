@@ -0,0 +1,11 @@
+/**
+ * SPI.h (native)
+ * Benjamin Hartmann | 10/2026
+ *
+ * Included by MyDisplay.h, nothing in the host build uses SPI.
+ */
+
+#ifndef _NATIVE_SPI_H_
+#define _NATIVE_SPI_H_
+
+#endif  // _NATIVE_SPI_H_
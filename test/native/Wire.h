@@ -0,0 +1,138 @@
+/**
+ * Wire.h (native)
+ * Benjamin Hartmann | 10/2026
+ *
+ * An emulated I2C bus for the [env:native] host build. Devices are
+ * TwoWireSlave objects attached at their address; a transaction to any
+ * other address is NACKed. Every transfer advances the fake clock by its
+ * time on the wire at the configured clock, and counts per slave, so tests
+ * can assert how many transactions a loop costs.
+ */
+
+#ifndef _NATIVE_WIRE_H_
+#define _NATIVE_WIRE_H_
+
+#include <Arduino.h>
+
+#define WIRE_BUFFER_SIZE 128  // same as the ESP8266 core
+#define WIRE_SLAVES_MAX 8
+
+/**
+ * A device on the emulated bus.
+ */
+class TwoWireSlave {
+   public:
+    uint32_t writes = 0;  // write transactions (register pointer included)
+    uint32_t reads = 0;   // read transactions
+    uint32_t bytes = 0;   // bytes written or read, without addresses
+
+    virtual ~TwoWireSlave() {}
+
+    /**
+     * A write transaction with all its bytes.
+     */
+    virtual void receive(const uint8_t* data, size_t length) = 0;
+
+    /**
+     * Next byte of a read transaction.
+     */
+    virtual uint8_t transmit() = 0;
+};
+
+class TwoWire : public Stream {
+   private:
+    TwoWireSlave* _slaves[128] = {};
+    uint32_t _clock = 100000;
+
+    uint8_t _address = 0;
+    uint8_t _tx[WIRE_BUFFER_SIZE];
+    size_t _txLength = 0;
+    uint8_t _rx[WIRE_BUFFER_SIZE];
+    size_t _rxLength = 0;
+    size_t _rxPos = 0;
+
+    /**
+     * Advance the clock by the time `bytes` plus the address byte take.
+     */
+    void transfer(size_t bytes) {
+        fakeMicros += (bytes + 1) * 9000000ULL / _clock;
+        transactions++;
+    }
+
+   public:
+    uint32_t transactions = 0;
+    uint32_t nacks = 0;  // transactions to an absent device or a hung bus
+
+    void attach(uint8_t address, TwoWireSlave& slave) {
+        _slaves[address & 0x7F] = &slave;
+    }
+
+    void detach(uint8_t address) { _slaves[address & 0x7F] = nullptr; }
+
+    void begin() {}
+    void setClock(uint32_t clock) { _clock = clock; }
+    uint32_t getClock() const { return _clock; }
+
+    void beginTransmission(uint8_t address) {
+        _address = address & 0x7F;
+        _txLength = 0;
+    }
+
+    size_t write(uint8_t c) override {
+        if (_txLength >= sizeof(_tx)) return 0;
+        _tx[_txLength++] = c;
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t length) override {
+        size_t n = 0;
+        while (n < length && write(data[n])) n++;
+        return n;
+    }
+
+    using Print::write;
+
+    /**
+     * @return 0 on success, 2 if the address was NACKed, 4 if SDA is held
+     * low
+     */
+    uint8_t endTransmission(bool stop = true) {
+        transfer(_txLength);
+        if (fakePins.sdaStuck) {
+            nacks++;
+            return 4;
+        }
+        TwoWireSlave* slave = _slaves[_address];
+        if (!slave) {
+            nacks++;
+            return 2;
+        }
+        slave->writes++;
+        slave->bytes += _txLength;
+        slave->receive(_tx, _txLength);
+        return 0;
+    }
+
+    uint8_t requestFrom(uint8_t address, size_t length, bool stop = true) {
+        _rxLength = _rxPos = 0;
+        transfer(length);
+        TwoWireSlave* slave = _slaves[address & 0x7F];
+        if (fakePins.sdaStuck || !slave) {
+            nacks++;
+            return 0;
+        }
+        if (length > sizeof(_rx)) length = sizeof(_rx);
+        slave->reads++;
+        slave->bytes += length;
+        for (; _rxLength < length; _rxLength++) _rx[_rxLength] = slave->transmit();
+        return _rxLength;
+    }
+
+    int available() override { return _rxLength - _rxPos; }
+
+    int read() override { return _rxPos < _rxLength ? _rx[_rxPos++] : -1; }
+};
+
+inline TwoWire Wire;
+
+#endif  // _NATIVE_WIRE_H_
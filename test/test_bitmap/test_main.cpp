@@ -0,0 +1,165 @@
+/**
+ * test_bitmap
+ * Benjamin Hartmann | 10/2026
+ *
+ * MyPackedBitmap against drawBitmap() of the same MyLogos.h bitmap: draw()
+ * of every frame, clipped at the left, right and bottom edge, step()
+ * through the XOR deltas including the wrap from the last frame back to
+ * the first, and the sizes the logo benchmark reports.
+ *
+ *   pio test -e native -f test_bitmap
+ */
+
+#include <unity.h>
+
+#include "MyLogos.h"
+#include "MyLogosPacked.h"
+
+#define BACKGROUND 0xA5  // around the bitmap, must survive draw() and step()
+
+TwoWire wire;
+MyI2CBus bus(I2C_CLOCK, wire);
+MyDisplay display(bus);  // only its GFX canvas, for the reference
+
+struct Logo {
+    const char* name;
+    const uint8_t* bitmap;
+    uint8_t width;
+    uint8_t height;
+    const PackedBitmap& packed;
+};
+
+static const Logo logos[] = {
+    {"adafruit", adafruitLogoBmp, ADAFRUIT_LOGO_WIDTH, ADAFRUIT_LOGO_HEIGHT, adafruitLogoPacked},
+    {"e621", e621_9da280Bmp, E621_9DA280_WIDTH, E621_9DA280_HEIGHT, e621_9da280Packed},
+    {"spinner", spinnerBmp, SPINNER_WIDTH, SPINNER_HEIGHT, spinnerPacked},
+};
+
+// Columns: inside, partly off the left and right edge, fully off both
+static const int16_t columns[] = {0, 37, -5, -15, SCREEN_WIDTH - 8, SCREEN_WIDTH - 1,
+                                  -70, SCREEN_WIDTH};
+
+static uint8_t packed[SCREEN_WIDTH * OLED_PAGES];
+
+/**
+ * Frame `frame` of `logo` drawn by drawBitmap() over the background, into
+ * the display buffer.
+ */
+static const uint8_t* reference(const Logo& logo, int16_t x, uint8_t page,
+                                uint8_t frame) {
+    uint16_t stride = (logo.width + 7) / 8 * logo.height;
+    memset(display.getBuffer(), BACKGROUND, sizeof(packed));
+    display.getCanvas().drawBitmap(x, page * 8, logo.bitmap + frame * stride,
+                                   logo.width, logo.height, SH110X_WHITE,
+                                   SH110X_BLACK);
+    return display.getBuffer();
+}
+
+static void expectFrame(const Logo& logo, int16_t x, uint8_t page,
+                        uint8_t frame) {
+    char message[64];
+    snprintf(message, sizeof(message), "%s frame %u at x %d, page %u",
+             logo.name, frame, x, page);
+    TEST_ASSERT_EQUAL_MEMORY_MESSAGE(reference(logo, x, page, frame), packed,
+                                     sizeof(packed), message);
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+/**
+ * Every frame at every column, also on the last page where taller bitmaps
+ * are cut off at the bottom.
+ */
+void test_draw_clipped() {
+    for (const Logo& logo : logos) {
+        for (uint8_t page : {(uint8_t)0, (uint8_t)3, (uint8_t)(OLED_PAGES - 1)}) {
+            for (int16_t x : columns) {
+                for (uint8_t frame = 0; frame < logo.packed.frames; frame++) {
+                    memset(packed, BACKGROUND, sizeof(packed));
+                    MyPackedBitmap::draw(packed, x, page, logo.packed, frame);
+                    expectFrame(logo, x, page, frame);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * draw() takes the frame number modulo the frame count.
+ */
+void test_draw_frame_out_of_range() {
+    const Logo& spinner = logos[2];
+    memset(packed, BACKGROUND, sizeof(packed));
+    MyPackedBitmap::draw(packed, 10, 1, spinner.packed, spinner.packed.frames + 3);
+    expectFrame(spinner, 10, 1, 3);
+}
+
+/**
+ * Two rounds of step() from frame 0: each delta turns the frame on screen
+ * into the next one, the last back into the first, also where the edges
+ * clip the deltas.
+ */
+void test_step_wraps() {
+    const Logo& spinner = logos[2];
+    uint8_t frames = spinner.packed.frames;
+    TEST_ASSERT_GREATER_THAN(1, frames);
+    for (int16_t x : columns) {
+        memset(packed, BACKGROUND, sizeof(packed));
+        MyPackedBitmap::draw(packed, x, OLED_PAGES - 1, spinner.packed, 0);
+        uint8_t frame = 0;
+        for (uint8_t i = 1; i <= 2 * frames; i++) {
+            frame = MyPackedBitmap::step(packed, x, OLED_PAGES - 1, spinner.packed, frame);
+            TEST_ASSERT_EQUAL_UINT8(i % frames, frame);
+            expectFrame(spinner, x, OLED_PAGES - 1, frame);
+        }
+    }
+}
+
+/**
+ * A still image has nothing to step to and stays as it is.
+ */
+void test_step_still_image() {
+    const Logo& adafruit = logos[0];
+    memset(packed, BACKGROUND, sizeof(packed));
+    MyPackedBitmap::draw(packed, 4, 2, adafruit.packed);
+    TEST_ASSERT_EQUAL_UINT8(0, MyPackedBitmap::step(packed, 4, 2, adafruit.packed, 0));
+    expectFrame(adafruit, 4, 2, 0);
+}
+
+/**
+ * rawSize() is what drawBitmap() stores: whole bytes per row, `height`
+ * rows, also for a height that is not a multiple of a page.
+ */
+void test_sizes() {
+    for (const Logo& logo : logos) {
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(
+            (logo.width + 7) / 8 * logo.height * logo.packed.frames,
+            MyPackedBitmap::rawSize(logo.packed), logo.name);
+        TEST_ASSERT_EQUAL_UINT8_MESSAGE(logo.height, logo.packed.height, logo.name);
+        TEST_ASSERT_EQUAL_UINT8_MESSAGE((logo.height + 7) / 8, logo.packed.pages,
+                                        logo.name);
+    }
+    TEST_ASSERT_EQUAL_UINT16(32, MyPackedBitmap::rawSize(adafruitLogoPacked));
+    TEST_ASSERT_EQUAL_UINT16(256, MyPackedBitmap::rawSize(spinnerPacked));
+
+    static const uint8_t data[10 * 2] = {};
+    const PackedBitmap odd = {10, 12, 2, 1, false, sizeof(data), data, nullptr};
+    TEST_ASSERT_EQUAL_UINT16(2 * 12, MyPackedBitmap::rawSize(odd));
+
+    TEST_ASSERT_EQUAL_UINT16(adafruitLogoPacked.size,
+                             MyPackedBitmap::packedSize(adafruitLogoPacked));
+    TEST_ASSERT_EQUAL_UINT16(spinnerPacked.size + (spinnerPacked.frames + 1) * 2,
+                             MyPackedBitmap::packedSize(spinnerPacked));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_draw_clipped);
+    RUN_TEST(test_draw_frame_out_of_range);
+    RUN_TEST(test_step_wraps);
+    RUN_TEST(test_step_still_image);
+    RUN_TEST(test_sizes);
+    return UNITY_END();
+}
@@ -0,0 +1,350 @@
+/**
+ * test_codec
+ * Benjamin Hartmann | 10/2026
+ *
+ * MyTelemetryCodec on the host: the JSON documents and the CBOR bytes of a
+ * known sample (the bytes are those of tools/telemetry_codec.py), the
+ * decodeCbor() round trip and what it rejects, base64, MyFormat::centi(),
+ * and a benchmark of every encoding per message.
+ *
+ *   pio test -e native -f test_codec
+ */
+
+#include <unity.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "MyTelemetryCodec.h"
+
+#define ITERATIONS 20000
+#define RUNS 9
+
+// A sample with tendency and forecast
+static SensorSnapshot reference() {
+    SensorSnapshot s;
+    s.valid = true;
+    s.sequence = 42;
+    s.epoch = 1760000000;
+    s.temperatureC = 2153;
+    s.temperatureF = 7075;
+    s.humidity = 4520;
+    s.pressure = 101325;
+    s.altitude = 12345;
+    s.derived.dewPoint = 912;
+    s.derived.absoluteHumidity = 856;
+    s.derived.heatIndex = 2150;
+    s.derived.pressureTendency = -120;
+    s.derived.forecast = 'B';
+    s.derived.tendencyValid = true;
+    return s;
+}
+
+// reference() encoded by tools/telemetry_codec.py
+static const uint8_t referenceCbor[] = {
+    0x8D, 0x01, 0x18, 0x2A, 0x1A, 0x68, 0xE7, 0x78, 0x00, 0x19, 0x08, 0x69, 0x19,
+    0x1B, 0xA3, 0x19, 0x11, 0xA8, 0x1A, 0x00, 0x01, 0x8B, 0xCD, 0x19, 0x30, 0x39,
+    0x19, 0x03, 0x90, 0x19, 0x03, 0x58, 0x19, 0x08, 0x66, 0x38, 0x77, 0x18, 0x42};
+
+// reference() below zero, without tendency
+static SensorSnapshot freezing() {
+    SensorSnapshot s = reference();
+    s.temperatureC = -1234;
+    s.temperatureF = -2221;
+    s.altitude = -50;
+    s.derived.pressureTendency = 0;
+    s.derived.forecast = '?';
+    s.derived.tendencyValid = false;
+    return s;
+}
+
+static const uint8_t freezingCbor[] = {
+    0x8B, 0x01, 0x18, 0x2A, 0x1A, 0x68, 0xE7, 0x78, 0x00, 0x39, 0x04, 0xD1,
+    0x39, 0x08, 0xAC, 0x19, 0x11, 0xA8, 0x1A, 0x00, 0x01, 0x8B, 0xCD, 0x38,
+    0x31, 0x19, 0x03, 0x90, 0x19, 0x03, 0x58, 0x19, 0x08, 0x66};
+
+static void assertSameSample(const SensorSnapshot& expected,
+                             const SensorSnapshot& actual) {
+    TEST_ASSERT_TRUE(actual.valid);
+    TEST_ASSERT_EQUAL_UINT32(expected.sequence, actual.sequence);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)expected.epoch, (uint32_t)actual.epoch);
+    TEST_ASSERT_EQUAL_INT32(expected.temperatureC, actual.temperatureC);
+    TEST_ASSERT_EQUAL_INT32(expected.temperatureF, actual.temperatureF);
+    TEST_ASSERT_EQUAL_INT32(expected.humidity, actual.humidity);
+    TEST_ASSERT_EQUAL_INT32(expected.pressure, actual.pressure);
+    TEST_ASSERT_EQUAL_INT32(expected.altitude, actual.altitude);
+    TEST_ASSERT_EQUAL_INT32(expected.derived.dewPoint, actual.derived.dewPoint);
+    TEST_ASSERT_EQUAL_INT32(expected.derived.absoluteHumidity,
+                            actual.derived.absoluteHumidity);
+    TEST_ASSERT_EQUAL_INT32(expected.derived.heatIndex, actual.derived.heatIndex);
+    TEST_ASSERT_EQUAL(expected.derived.tendencyValid, actual.derived.tendencyValid);
+    if (expected.derived.tendencyValid) {
+        TEST_ASSERT_EQUAL_INT32(expected.derived.pressureTendency,
+                                actual.derived.pressureTendency);
+    }
+    TEST_ASSERT_EQUAL(expected.derived.forecast, actual.derived.forecast);
+}
+
+/**
+ * Median host time per call of `encode` over RUNS runs of ITERATIONS, in ns.
+ */
+template <typename Encode>
+static double nanosPerMessage(Encode encode) {
+    std::vector<double> runs;
+    size_t sink = 0;
+    for (uint8_t run = 0; run < RUNS; run++) {
+        uint64_t start = hostNanos();
+        for (uint32_t i = 0; i < ITERATIONS; i++) sink += encode(i);
+        runs.push_back((double)(hostNanos() - start) / ITERATIONS);
+    }
+    TEST_ASSERT_NOT_EQUAL(0, sink);
+    std::sort(runs.begin(), runs.end());
+    return runs[RUNS / 2];
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_format_centi() {
+    char buf[16];
+    TEST_ASSERT_EQUAL_STRING("0.00", MyFormat::centi(0, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("21.53", MyFormat::centi(2153, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("1.05", MyFormat::centi(105, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("-0.05", MyFormat::centi(-5, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("-12.34", MyFormat::centi(-1234, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("21474836.47",
+                             MyFormat::centi(INT32_MAX, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("-21474836.48",
+                             MyFormat::centi(INT32_MIN, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("", MyFormat::centi(2153, buf, 5));  // does not fit
+    TEST_ASSERT_EQUAL_STRING("21.53", MyFormat::centi(2153, buf, 6));
+
+    char worst[FORMAT_CENTI_SIZE];
+    TEST_ASSERT_EQUAL_STRING("-21474836.48",
+                             MyFormat::centi(INT32_MIN, worst, sizeof(worst)));
+}
+
+void test_json() {
+    char buf[TELEMETRY_JSON_SIZE];
+    size_t length = MyTelemetryCodec::formatJson(reference(), buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"v\":1,\"t\":1760000000,\"seq\":42,\"temp\":21.53,\"hum\":45.20,"
+        "\"pres\":1013.25,\"alt\":123.45,\"dew\":9.12,\"ahum\":8.56,\"hi\":21.50,"
+        "\"tend\":-1.20,\"fc\":\"Fine weather\"}",
+        buf);
+    TEST_ASSERT_EQUAL(strlen(buf), length);
+
+    MyTelemetryCodec::formatJson(freezing(), buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"v\":1,\"t\":1760000000,\"seq\":42,\"temp\":-12.34,\"hum\":45.20,"
+        "\"pres\":1013.25,\"alt\":-0.50,\"dew\":9.12,\"ahum\":8.56,\"hi\":21.50}",
+        buf);
+
+    // Too small at every length returns 0, never a cut document
+    for (size_t size = 1; size <= length; size++) {
+        TEST_ASSERT_EQUAL(0, MyTelemetryCodec::formatJson(reference(), buf, size));
+    }
+}
+
+void test_event_json() {
+    char buf[TELEMETRY_JSON_SIZE];
+    size_t length = MyTelemetryCodec::formatEventJson(reference(), buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"sequence\":42,\"temperatureC\":21.53,\"temperatureF\":70.75,"
+        "\"humidity\":45.20,\"pressure\":1013.25,\"altitude\":123.45,"
+        "\"dewPoint\":9.12,\"absoluteHumidity\":8.56,\"heatIndex\":21.50,"
+        "\"pressureTendency\":-1.20,\"forecast\":\"Fine weather\"}",
+        buf);
+    TEST_ASSERT_EQUAL(strlen(buf), length);
+
+    for (size_t size = 1; size <= length; size++) {
+        TEST_ASSERT_EQUAL(0, MyTelemetryCodec::formatEventJson(reference(), buf, size));
+    }
+}
+
+/**
+ * The encoder writes the bytes of the reference encoder, and decodeCbor()
+ * gets every field back.
+ */
+void test_cbor_round_trip() {
+    uint8_t buf[TELEMETRY_CBOR_SIZE];
+    SensorSnapshot decoded;
+
+    size_t length = MyTelemetryCodec::encodeCbor(reference(), buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(sizeof(referenceCbor), length);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(referenceCbor, buf, length);
+    TEST_ASSERT_TRUE(MyTelemetryCodec::decodeCbor(buf, length, decoded));
+    assertSameSample(reference(), decoded);
+
+    length = MyTelemetryCodec::encodeCbor(freezing(), buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(sizeof(freezingCbor), length);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(freezingCbor, buf, length);
+    decoded = reference();  // tendency and forecast must be reset
+    TEST_ASSERT_TRUE(MyTelemetryCodec::decodeCbor(buf, length, decoded));
+    assertSameSample(freezing(), decoded);
+
+    // Extremes of every field, which also take the longest encoding
+    SensorSnapshot extreme = reference();
+    extreme.sequence = UINT32_MAX;
+    extreme.epoch = UINT32_MAX;
+    extreme.temperatureC = INT32_MIN;
+    extreme.temperatureF = INT32_MAX;
+    extreme.altitude = -1;
+    extreme.derived.pressureTendency = INT32_MIN;
+    extreme.derived.forecast = 'Z';
+    length = MyTelemetryCodec::encodeCbor(extreme, buf, sizeof(buf));
+    TEST_ASSERT_NOT_EQUAL(0, length);
+    TEST_ASSERT_TRUE(MyTelemetryCodec::decodeCbor(buf, length, decoded));
+    assertSameSample(extreme, decoded);
+
+    // Too small returns 0
+    for (size_t size = 0; size < sizeof(referenceCbor); size++) {
+        TEST_ASSERT_EQUAL(0, MyTelemetryCodec::encodeCbor(reference(), buf, size));
+    }
+}
+
+void test_cbor_rejects() {
+    uint8_t buf[TELEMETRY_CBOR_SIZE + 1];
+    SensorSnapshot decoded;
+
+    // Truncated anywhere
+    for (size_t length = 0; length < sizeof(referenceCbor); length++) {
+        TEST_ASSERT_FALSE(MyTelemetryCodec::decodeCbor(referenceCbor, length, decoded));
+        TEST_ASSERT_FALSE(decoded.valid);
+    }
+
+    // Trailing garbage
+    memcpy(buf, referenceCbor, sizeof(referenceCbor));
+    buf[sizeof(referenceCbor)] = 0x00;
+    TEST_ASSERT_FALSE(MyTelemetryCodec::decodeCbor(buf, sizeof(referenceCbor) + 1, decoded));
+
+    // Other schema version
+    memcpy(buf, referenceCbor, sizeof(referenceCbor));
+    buf[1] = 0x02;
+    TEST_ASSERT_FALSE(MyTelemetryCodec::decodeCbor(buf, sizeof(referenceCbor), decoded));
+
+    // Wrong item count
+    memcpy(buf, referenceCbor, sizeof(referenceCbor));
+    buf[0] = 0x8C;
+    TEST_ASSERT_FALSE(MyTelemetryCodec::decodeCbor(buf, sizeof(referenceCbor), decoded));
+
+    // Not an array, e.g. a JSON document on the same topic
+    const char* json = "{\"v\":1}";
+    TEST_ASSERT_FALSE(MyTelemetryCodec::decodeCbor((const uint8_t*)json, strlen(json), decoded));
+
+    // Negative where an unsigned sequence number belongs
+    memcpy(buf, referenceCbor, sizeof(referenceCbor));
+    buf[2] = 0x38;
+    TEST_ASSERT_FALSE(MyTelemetryCodec::decodeCbor(buf, sizeof(referenceCbor), decoded));
+
+    // 64 bit argument
+    memcpy(buf, referenceCbor, sizeof(referenceCbor));
+    buf[2] = 0x1B;
+    TEST_ASSERT_FALSE(MyTelemetryCodec::decodeCbor(buf, sizeof(referenceCbor), decoded));
+}
+
+/**
+ * RFC 4648 test vectors.
+ */
+void test_base64() {
+    const char* vectors[][2] = {{"", ""},
+                                {"f", "Zg=="},
+                                {"fo", "Zm8="},
+                                {"foo", "Zm9v"},
+                                {"foob", "Zm9vYg=="},
+                                {"fooba", "Zm9vYmE="},
+                                {"foobar", "Zm9vYmFy"}};
+    char out[16];
+    for (auto& v : vectors) {
+        size_t length = MyTelemetryCodec::base64((const uint8_t*)v[0], strlen(v[0]),
+                                                 out, sizeof(out));
+        TEST_ASSERT_EQUAL_STRING(v[1], out);
+        TEST_ASSERT_EQUAL(strlen(v[1]), length);
+    }
+
+    // Room for the terminator is needed
+    TEST_ASSERT_EQUAL(0, MyTelemetryCodec::base64((const uint8_t*)"foo", 3, out, 4));
+    TEST_ASSERT_EQUAL(4, MyTelemetryCodec::base64((const uint8_t*)"foo", 3, out, 5));
+
+    uint8_t cbor[TELEMETRY_CBOR_SIZE];
+    char text[TELEMETRY_CBOR_SIZE * 4 / 3 + 4];
+    size_t length = MyTelemetryCodec::encodeCbor(reference(), cbor, sizeof(cbor));
+    TEST_ASSERT_EQUAL(52, MyTelemetryCodec::base64(cbor, length, text, sizeof(text)));
+}
+
+/**
+ * Size and host time per message of every encoding. The bounds are loose,
+ * they only catch an encoding that stopped being a few hundred ns of
+ * plain formatting.
+ */
+void test_benchmark() {
+    SensorSnapshot s = reference();
+    char json[TELEMETRY_JSON_SIZE];
+    uint8_t cbor[TELEMETRY_CBOR_SIZE];
+    char text[TELEMETRY_CBOR_SIZE * 4 / 3 + 4];
+    SensorSnapshot decoded;
+
+    // Vary the sequence so nothing is hoisted out of the loop
+    double jsonNs = nanosPerMessage([&](uint32_t i) {
+        s.sequence = i;
+        return MyTelemetryCodec::formatJson(s, json, sizeof(json));
+    });
+    double eventNs = nanosPerMessage([&](uint32_t i) {
+        s.sequence = i;
+        return MyTelemetryCodec::formatEventJson(s, json, sizeof(json));
+    });
+    double cborNs = nanosPerMessage([&](uint32_t i) {
+        s.sequence = i;
+        return MyTelemetryCodec::encodeCbor(s, cbor, sizeof(cbor));
+    });
+    double base64Ns = nanosPerMessage([&](uint32_t i) {
+        s.sequence = i;
+        return MyTelemetryCodec::base64(
+            cbor, MyTelemetryCodec::encodeCbor(s, cbor, sizeof(cbor)), text, sizeof(text));
+    });
+    size_t cborLength = MyTelemetryCodec::encodeCbor(s, cbor, sizeof(cbor));
+    double decodeNs = nanosPerMessage([&](uint32_t i) {
+        return MyTelemetryCodec::decodeCbor(cbor, cborLength, decoded) ? 1 : 0;
+    });
+
+    size_t jsonLength = MyTelemetryCodec::formatJson(s, json, sizeof(json));
+    size_t eventLength = MyTelemetryCodec::formatEventJson(s, json, sizeof(json));
+    size_t base64Length = MyTelemetryCodec::base64(cbor, cborLength, text, sizeof(text));
+    printf("[Codec] json        %4zu bytes %7.1f ns/message host\n", jsonLength, jsonNs);
+    printf("[Codec] events json %4zu bytes %7.1f ns/message host\n", eventLength, eventNs);
+    printf("[Codec] cbor        %4zu bytes %7.1f ns/message host\n", cborLength, cborNs);
+    printf("[Codec] cbor base64 %4zu bytes %7.1f ns/message host\n", base64Length, base64Ns);
+    printf("[Codec] cbor decode            %7.1f ns/message host\n", decodeNs);
+
+    TEST_ASSERT_LESS_THAN(jsonLength / 2, cborLength);
+    TEST_ASSERT_LESS_THAN(jsonLength, base64Length);
+    TEST_ASSERT_LESS_THAN((uint32_t)jsonNs, (uint32_t)cborNs);
+    TEST_ASSERT_LESS_THAN(20000, (uint32_t)jsonNs);
+    TEST_ASSERT_LESS_THAN(20000, (uint32_t)eventNs);
+    TEST_ASSERT_LESS_THAN(5000, (uint32_t)base64Ns);
+    TEST_ASSERT_LESS_THAN(5000, (uint32_t)decodeNs);
+}
+
+/**
+ * The on-device benchmark runs and reports a good round trip, with and
+ * without tendency.
+ */
+void test_print_benchmark() {
+    MyTelemetryCodec::printBenchmark(reference(), 10);
+    MyTelemetryCodec::printBenchmark(freezing(), 10);
+    MyTelemetryCodec::printBenchmark(SensorSnapshot());  // refused, not valid
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_format_centi);
+    RUN_TEST(test_json);
+    RUN_TEST(test_event_json);
+    RUN_TEST(test_cbor_round_trip);
+    RUN_TEST(test_cbor_rejects);
+    RUN_TEST(test_base64);
+    RUN_TEST(test_benchmark);
+    RUN_TEST(test_print_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,169 @@
+/**
+ * test_compensation
+ * Benjamin Hartmann | 10/2026
+ *
+ * Checks MyBmeCompensation against the worked example of the BME280
+ * datasheet (section 8.2), against its own float reference over the whole
+ * operating range, and at the edges (clamping, the division guard, the
+ * altitude table bounds). Also times the integer and the float path.
+ *
+ *   pio test -e native -f test_compensation
+ */
+
+#include <unity.h>
+
+#include "FakeBme280.h"
+#include "MyBmeCompensation.h"
+
+#define TIMING_ITERATIONS 100000
+
+/**
+ * Apply trimming parameters through the register layout.
+ */
+static void setCalibration(MyBmeCompensation& compensation,
+                           const Bme280Calibration& c) {
+    uint8_t a[26];
+    uint8_t b[7];
+    bme280CalibrationBytes(c, a, b);
+    compensation.setCalibration(a, b);
+}
+
+MyBmeCompensation compensation;
+
+void setUp() { setCalibration(compensation, bme280Datasheet); }
+
+void tearDown() {}
+
+void test_datasheet_example() {
+    TEST_ASSERT_EQUAL_INT32(2508, compensation.temperature(519888));
+    TEST_ASSERT_EQUAL_UINT32(100653, compensation.pressure(415148));
+}
+
+/**
+ * Negative and nibble-packed parameters survive the register layout.
+ */
+void test_calibration_parsing() {
+    Bme280Calibration c = bme280Datasheet;
+    c.H4 = -123;
+    c.H5 = -456;
+    c.H6 = -7;
+    MyBmeCompensation negative;
+    setCalibration(negative, c);
+    negative.temperature(519888);
+
+    MyBmeCompensation reference;
+    setCalibration(reference, bme280Datasheet);
+    reference.temperature(519888);
+    TEST_ASSERT_TRUE(negative.humidity(30000) != reference.humidity(30000));
+
+    float t, p, h, a;
+    negative.compensateFloat(519888, 415148, 30000, t, p, h, a);
+    TEST_ASSERT_INT_WITHIN(10, (int32_t)(h * 100), (int32_t)negative.humidity(30000));
+}
+
+/**
+ * The integer path stays within a few LSB of the float reference from
+ * -40 to 85 °C, 300 to 1100 hPa and 0 to 100 %RH.
+ */
+void test_matches_float_reference() {
+    for (int32_t adcT = 380000; adcT <= 640000; adcT += 20000) {
+        for (int32_t adcP = 200000; adcP <= 600000; adcP += 50000) {
+            for (int32_t adcH = 22000; adcH <= 40000; adcH += 3000) {
+                int32_t t = compensation.temperature(adcT);
+                uint32_t p = compensation.pressure(adcP);
+                uint32_t h = compensation.humidity(adcH);
+
+                float ft, fp, fh, fa;
+                compensation.compensateFloat(adcT, adcP, adcH, ft, fp, fh, fa);
+                TEST_ASSERT_INT_WITHIN(1, (int32_t)lroundf(ft * 100), t);
+                TEST_ASSERT_INT_WITHIN(3, (int32_t)lroundf(fp * 100), (int32_t)p);
+                TEST_ASSERT_INT_WITHIN(5, (int32_t)lroundf(fh * 100), (int32_t)h);
+            }
+        }
+    }
+}
+
+void test_humidity_clamps() {
+    compensation.temperature(519888);
+    TEST_ASSERT_EQUAL_UINT32(0, compensation.humidity(0));
+    TEST_ASSERT_EQUAL_UINT32(10000, compensation.humidity(0xFFFF));
+}
+
+/**
+ * Full scale raw values must not overflow (the sanitizers would report
+ * it) and an all-zero calibration must not divide by zero.
+ */
+void test_extreme_inputs() {
+    for (int32_t adcT : {0, 0xFFFFF}) {
+        compensation.temperature(adcT);
+        compensation.pressure(0);
+        compensation.pressure(0xFFFFF);
+        compensation.humidity(0);
+        compensation.humidity(0xFFFF);
+    }
+
+    MyBmeCompensation blank;
+    setCalibration(blank, Bme280Calibration{});
+    blank.temperature(519888);
+    TEST_ASSERT_EQUAL_UINT32(0, blank.pressure(415148));
+}
+
+void test_altitude() {
+    TEST_ASSERT_INT_WITHIN(15, 0, MyBmeCompensation::altitude(101325));
+    for (uint32_t p = 30000; p <= 110000; p += 100) {
+        double reference = 44330.0 * (1.0 - pow(p / 101325.0, 0.1903));
+        int32_t tolerance = p >= 80000 ? 15 : 100;  // cm, see the table
+        TEST_ASSERT_INT_WITHIN(tolerance, (int32_t)lround(reference * 100),
+                               MyBmeCompensation::altitude(p));
+    }
+
+    // Outside the table the ends are held
+    TEST_ASSERT_EQUAL_INT32(bmeAltitudeLut[0], MyBmeCompensation::altitude(0));
+    int32_t top = MyBmeCompensation::altitude(BME_ALTITUDE_LUT_BASE +
+                                              (BME_ALTITUDE_LUT_SIZE - 1) *
+                                                  (1 << BME_ALTITUDE_LUT_SHIFT));
+    TEST_ASSERT_EQUAL_INT32(top, MyBmeCompensation::altitude(200000));
+}
+
+/**
+ * Host timing of both paths, like MySensor::printBenchmark() on the
+ * device. On the host the FPU makes float cheap, so this only reports.
+ */
+void test_timing() {
+    volatile int32_t sink = 0;
+    uint64_t start = hostNanos();
+    for (uint32_t i = 0; i < TIMING_ITERATIONS; i++) {
+        int32_t adcT = 519888 + (i & 0xFF);
+        sink = compensation.temperature(adcT);
+        uint32_t pressure = compensation.pressure(415148 + (i & 0xFF));
+        sink = compensation.humidity(30000 + (i & 0xFF));
+        sink = MyBmeCompensation::altitude(pressure);
+    }
+    uint64_t intNanos = hostNanos() - start;
+
+    float t, p, h, a;
+    start = hostNanos();
+    for (uint32_t i = 0; i < TIMING_ITERATIONS; i++) {
+        compensation.compensateFloat(519888 + (i & 0xFF), 415148 + (i & 0xFF),
+                                     30000 + (i & 0xFF), t, p, h, a);
+        sink = (int32_t)a;
+    }
+    uint64_t floatNanos = hostNanos() - start;
+    (void)sink;
+
+    printf("[Compensation] integer %.1f ns/sample, float %.1f ns/sample (host)\n",
+           (double)intNanos / TIMING_ITERATIONS,
+           (double)floatNanos / TIMING_ITERATIONS);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_datasheet_example);
+    RUN_TEST(test_calibration_parsing);
+    RUN_TEST(test_matches_float_reference);
+    RUN_TEST(test_humidity_clamps);
+    RUN_TEST(test_extreme_inputs);
+    RUN_TEST(test_altitude);
+    RUN_TEST(test_timing);
+    return UNITY_END();
+}
@@ -0,0 +1,81 @@
+/**
+ * test_derived
+ * Benjamin Hartmann | 10/2026
+ *
+ * The 3 hour pressure tendency of MyDerivedMetrics: valid after 18 slots,
+ * reset by a gap in the samples, and unaffected by the wrap of millis()
+ * after 49.7 days.
+ *
+ *   pio test -e native -f test_derived
+ */
+
+#include <unity.h>
+
+#include "MyDerivedMetrics.h"
+
+#define MINUTE 60000UL
+#define PRESSURE 101000  // Pa at the first sample, rising 1 Pa per minute
+
+/**
+ * Feed one sample per minute for `minutes`, starting at millis() `start`
+ * as a 32 bit counter like on the ESP8266.
+ * @return minute at which the tendency first became valid, or -1
+ */
+static int32_t feed(MyDerivedMetrics& metrics, uint32_t start,
+                    uint32_t minutes, uint32_t first = 0) {
+    int32_t valid = -1;
+    for (uint32_t m = first; m < first + minutes; m++) {
+        uint32_t now = start + m * MINUTE;
+        const DerivedMetrics& d = metrics.update(2000, 5000, PRESSURE + m, now);
+        if (d.tendencyValid && valid < 0) valid = m;
+        if (valid >= 0) {
+            TEST_ASSERT_TRUE_MESSAGE(d.tendencyValid, "tendency lost");
+        }
+    }
+    return valid;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+/**
+ * 18 closed 10 minute slots, then the difference to the oldest slot.
+ */
+void test_tendency_after_three_hours() {
+    MyDerivedMetrics metrics;
+    TEST_ASSERT_EQUAL_INT32(180, feed(metrics, 0, 240));
+    // Now PRESSURE + 239, oldest slot holds minutes 50..59 (average 54)
+    TEST_ASSERT_EQUAL_INT32(239 - 54, metrics.get().pressureTendency);
+    TEST_ASSERT_NOT_EQUAL('?', metrics.get().forecast);
+}
+
+/**
+ * Two hours before the wrap of millis() to two hours after it: the slots
+ * run on and the tendency stays valid.
+ */
+void test_tendency_across_millis_wrap() {
+    MyDerivedMetrics metrics;
+    uint32_t start = 0xFFFFFFFFUL - 120 * MINUTE;
+    TEST_ASSERT_EQUAL_INT32(180, feed(metrics, start, 240));
+    TEST_ASSERT_EQUAL_INT32(239 - 54, metrics.get().pressureTendency);
+}
+
+/**
+ * Missed slots break the window, it fills again from there.
+ */
+void test_gap_resets() {
+    MyDerivedMetrics metrics;
+    TEST_ASSERT_EQUAL_INT32(180, feed(metrics, 0, 200));
+    TEST_ASSERT_EQUAL_INT32(-1, feed(metrics, 0, 60, 230));
+    TEST_ASSERT_FALSE(metrics.get().tendencyValid);
+    TEST_ASSERT_EQUAL_INT32(410, feed(metrics, 0, 200, 290));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_tendency_after_three_hours);
+    RUN_TEST(test_tendency_across_millis_wrap);
+    RUN_TEST(test_gap_resets);
+    return UNITY_END();
+}
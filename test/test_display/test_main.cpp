@@ -0,0 +1,283 @@
+/**
+ * test_display
+ * Benjamin Hartmann | 10/2026
+ *
+ * Renders every screen of MyDisplay and the clock and sparkline pages on
+ * the host, flushes it over the emulated bus into a FakeSh1106 and compares
+ * what reached the panel with the golden image in golden/<screen>.pbm.
+ * Also times rendering and flushing of each screen.
+ *
+ *   pio test -e native -f test_display
+ *   UPDATE_GOLDEN=1 pio test -e native -f test_display   rewrite the goldens
+ *   FRAME_DUMP_DIR=/tmp pio test -e native -f test_display   PBM + PNG dumps
+ */
+
+#include <unity.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "FakeSh1106.h"
+#include "GoldenFrame.h"
+#include "MyClockFace.h"
+#include "MyDisplay.h"
+#include "MySparkline.h"
+
+#define TIMING_ITERATIONS 200
+
+TwoWire wire;
+FakeSh1106 panel;
+MyI2CBus bus(I2C_CLOCK, wire);
+MyDisplay display(bus);
+
+typedef std::function<void(MyDisplay& display)> Draw;
+
+static SensorSnapshot sampleSnapshot() {
+    SensorSnapshot s;
+    s.sequence = 42;
+    s.temperatureC = 2153;
+    s.temperatureF = 7075;
+    s.humidity = 4520;
+    s.pressure = 101325;
+    s.altitude = -1002;
+    s.derived.dewPoint = 893;
+    s.derived.pressureTendency = -125;
+    s.derived.forecast = 'B';
+    s.derived.tendencyValid = true;
+    s.valid = true;
+    return s;
+}
+
+static struct tm sampleTime() {
+    struct tm t = {};
+    t.tm_year = 2026 - 1900;
+    t.tm_mon = 9;
+    t.tm_mday = 18;
+    t.tm_hour = 14;
+    t.tm_min = 37;
+    t.tm_sec = 5;
+    t.tm_wday = 0;
+    t.tm_yday = 290;
+    return t;
+}
+
+/**
+ * Median host time of `iterations` runs of `f` in ns.
+ */
+static uint64_t medianNanos(const std::function<void()>& f,
+                            uint16_t iterations = TIMING_ITERATIONS) {
+    std::vector<uint64_t> times(iterations);
+    for (uint64_t& t : times) {
+        uint64_t start = hostNanos();
+        f();
+        t = hostNanos() - start;
+    }
+    std::sort(times.begin(), times.end());
+    return times[iterations / 2];
+}
+
+/**
+ * Time the screen, then draw it once more, flush it and check the panel
+ * against the buffer and the golden image.
+ */
+static void expectScreen(const char* name, const Draw& draw) {
+    uint64_t render = medianNanos([&] {
+        display.clear();
+        draw(display);
+    });
+    uint64_t flush = medianNanos([&] {
+        display.invalidate();
+        display.flush();
+    });
+    uint16_t fullBytes = display.getFrameBytes();
+    uint32_t busTime = display.getFrameTime();  // emulated time at I2C_CLOCK
+    printf("[Display] %-18s render %6.1f µs, flush %6.1f µs host, "
+           "%5u µs bus for %u B\n",
+           name, render / 1000.0, flush / 1000.0, busTime, fullBytes);
+
+    display.clear();
+    draw(display);
+    display.invalidate();
+    TEST_ASSERT_TRUE(display.flush());
+
+    uint8_t frame[SH1106_FRAME_SIZE];
+    panel.frame(frame);
+    TEST_ASSERT_EQUAL_MEMORY_MESSAGE(display.getBuffer(), frame, sizeof(frame),
+                                     "panel RAM differs from the buffer");
+
+    expectGoldenFrame(__FILE__, name, frame);
+}
+
+void setUp() {
+    bus.reserve(millis() + 3600000UL);  // no sensor access pending
+}
+
+void tearDown() {}
+
+void test_sensor_values() {
+    SensorSnapshot s = sampleSnapshot();
+    expectScreen("sensor", [&](MyDisplay& d) { d.drawSensorValues(s); });
+}
+
+void test_sensor_collecting() {
+    SensorSnapshot s = sampleSnapshot();
+    s.derived.tendencyValid = false;
+    expectScreen("sensor-collecting", [&](MyDisplay& d) { d.drawSensorValues(s); });
+}
+
+void test_sensor_offline() {
+    SensorSnapshot s;
+    expectScreen("sensor-offline", [&](MyDisplay& d) { d.drawSensorValues(s); });
+}
+
+void test_wifi_info() {
+    expectScreen("wifi", [](MyDisplay& d) {
+        d.drawWiFiInfo(true, "HomeNet", "192.168.1.42");
+    });
+}
+
+void test_wifi_connecting() {
+    expectScreen("wifi-connecting",
+                 [](MyDisplay& d) { d.drawWiFiInfo(false, "", ""); });
+}
+
+void test_ap_info() {
+    expectScreen("ap", [](MyDisplay& d) {
+        d.drawAPInfo("ESP-Clock", "clock1234", "192.168.4.1");
+    });
+}
+
+void test_time() {
+    expectScreen("time", [](MyDisplay& d) { d.drawTime("Sun 18.10.2026 14:37"); });
+}
+
+void test_clock_face() {
+    MyClockFace face;
+    struct tm t = sampleTime();
+    expectScreen("clock", [&](MyDisplay& d) { face.render(d, t); });
+}
+
+/**
+ * A seconds tick of the clock face only moves the seconds hand, so only
+ * the pages it crosses go out, a small fraction of the full frame: on the
+ * bus (getFrameBytes(), with addressing) and in panel RAM (dataBytes).
+ */
+void test_clock_face_tick() {
+    MyClockFace face;
+    struct tm t = sampleTime();
+    display.clear();
+    face.render(display, t);
+    display.invalidate();
+    TEST_ASSERT_TRUE(display.flush());
+    uint32_t fullBus = display.getFrameBytes();
+
+    uint32_t worstBus = 0, worstRam = 0;
+    for (uint8_t tick = 0; tick < 60; tick++) {
+        t.tm_sec = (t.tm_sec + 1) % 60;
+        display.clear();
+        face.render(display, t);
+        uint32_t before = panel.dataBytes;
+        TEST_ASSERT_TRUE(display.flush());
+        uint32_t ram = panel.dataBytes - before;
+        TEST_ASSERT_GREATER_THAN(0, ram);
+        TEST_ASSERT_LESS_THAN(display.getFrameBytes(), ram);
+        worstBus = std::max(worstBus, (uint32_t)display.getFrameBytes());
+        worstRam = std::max(worstRam, ram);
+
+        uint8_t frame[SH1106_FRAME_SIZE];
+        panel.frame(frame);
+        TEST_ASSERT_EQUAL_MEMORY(display.getBuffer(), frame, sizeof(frame));
+    }
+    printf("[Display] clock tick         at most %u of %u B bus, "
+           "%u of %u B RAM\n",
+           worstBus, fullBus, worstRam, SH1106_FRAME_SIZE);
+    TEST_ASSERT_LESS_THAN(fullBus / 8, worstBus);
+    TEST_ASSERT_LESS_THAN(SH1106_FRAME_SIZE / 8, worstRam);
+}
+
+void test_sparkline() {
+    MySensorHistory history;
+    TEST_ASSERT_TRUE(history.begin());
+    SensorSnapshot s = sampleSnapshot();
+    for (uint16_t second = 1; second <= 500; second++) {
+        s.millis = second * 1000UL;
+        s.temperatureC = 2100 + (int32_t)(80 * sin(second / 60.0));
+        s.humidity = 4500 + second;
+        s.pressure = 101300 - second / 4;
+        history.add(s);
+    }
+    MySparkline sparkline(history);
+    expectScreen("sparkline", [&](MyDisplay& d) { sparkline.render(d); });
+}
+
+/**
+ * The display shows the same frame as the buffer after a flush that had
+ * to yield to the sensor and was finished on a later call.
+ */
+void test_sliced_flush() {
+    SensorSnapshot s = sampleSnapshot();
+    display.clear();
+    display.drawSensorValues(s);
+    display.invalidate();
+
+    bus.reserve(millis() + 1);  // room for about one chunk
+    uint8_t calls = 1;
+    while (!display.flush()) {
+        bus.reserve(millis() + 1);
+        calls++;
+        TEST_ASSERT_LESS_THAN(100, calls);
+    }
+    TEST_ASSERT_GREATER_THAN(1, calls);
+
+    uint8_t frame[SH1106_FRAME_SIZE];
+    panel.frame(frame);
+    TEST_ASSERT_EQUAL_MEMORY(display.getBuffer(), frame, sizeof(frame));
+}
+
+/**
+ * A flush the panel does not acknowledge leaves the shadow alone and does
+ * not count as a frame; the next flush sends what is missing.
+ */
+void test_flush_nack() {
+    SensorSnapshot s = sampleSnapshot();
+    display.clear();
+    display.drawSensorValues(s);
+    display.invalidate();
+
+    wire.detach(0x3C);
+    uint32_t failures = display.getFailures();
+    TEST_ASSERT_FALSE(display.flush());
+    TEST_ASSERT_EQUAL_UINT32(failures + 1, display.getFailures());
+    TEST_ASSERT_TRUE(display.isFlushing());
+
+    wire.attach(0x3C, panel);
+    uint32_t before = panel.dataBytes;
+    TEST_ASSERT_TRUE(display.flush());
+    TEST_ASSERT_EQUAL_UINT32(SCREEN_WIDTH * OLED_PAGES, panel.dataBytes - before);
+
+    uint8_t frame[SH1106_FRAME_SIZE];
+    panel.frame(frame);
+    TEST_ASSERT_EQUAL_MEMORY(display.getBuffer(), frame, sizeof(frame));
+}
+
+int main(int argc, char** argv) {
+    wire.attach(0x3C, panel);
+    bus.begin();
+    display.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_sensor_values);
+    RUN_TEST(test_sensor_collecting);
+    RUN_TEST(test_sensor_offline);
+    RUN_TEST(test_wifi_info);
+    RUN_TEST(test_wifi_connecting);
+    RUN_TEST(test_ap_info);
+    RUN_TEST(test_time);
+    RUN_TEST(test_clock_face);
+    RUN_TEST(test_clock_face_tick);
+    RUN_TEST(test_sparkline);
+    RUN_TEST(test_sliced_flush);
+    RUN_TEST(test_flush_nack);
+    return UNITY_END();
+}
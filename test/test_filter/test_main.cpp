@@ -0,0 +1,153 @@
+/**
+ * test_filter
+ * Benjamin Hartmann | 10/2026
+ *
+ * Host benchmark of MySensorFilter: the cost of one new sample through
+ * each configuration, and of the calls that see no new sample, which
+ * must not run the chain. Also checks what each stage does to a spike and
+ * that an outage starts the filter over.
+ *
+ *   pio test -e native -f test_filter
+ */
+
+#include <unity.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "MySensorFilter.h"
+
+#define SAMPLES 20000
+#define RUNS 9
+
+static const SensorFilterConfig* configs[] = {
+    &sensorFilterRaw, &sensorFilterClean, &sensorFilterSmooth};
+
+/**
+ * Noisy synthetic sample `i`, with a spike every 50 samples, as in
+ * MySensorFilter::printBenchmark().
+ */
+static SensorSnapshot noisy(uint32_t i) {
+    SensorSnapshot s;
+    s.valid = true;
+    s.sequence = i + 1;
+    s.temperatureC = 2150 + (i * 7 % 13) - 6;
+    s.humidity = 4500 + (i * 11 % 17) - 8;
+    s.pressure = 101325 + (i % 50 == 0 ? 900 : (i * 5 % 9) - 4);
+    return s;
+}
+
+/**
+ * Median host time per new sample over RUNS runs of SAMPLES, in ns.
+ */
+static double nanosPerSample(const SensorFilterConfig& config) {
+    std::vector<SensorSnapshot> input;
+    for (uint32_t i = 0; i < SAMPLES; i++) input.push_back(noisy(i));
+
+    std::vector<double> runs;
+    int32_t sink = 0;
+    for (uint8_t run = 0; run < RUNS; run++) {
+        MySensorFilter filter(config);
+        uint64_t start = hostNanos();
+        for (const SensorSnapshot& s : input) sink += filter.update(s).temperatureC;
+        runs.push_back((double)(hostNanos() - start) / SAMPLES);
+    }
+    TEST_ASSERT_NOT_EQUAL(0, sink);
+    std::sort(runs.begin(), runs.end());
+    return runs[RUNS / 2];
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+/**
+ * Cost of one new sample per configuration. The bound is loose, it only
+ * catches a chain that stopped being constant work per sample.
+ */
+void test_sample_cost() {
+    for (const SensorFilterConfig* config : configs) {
+        double ns = nanosPerSample(*config);
+        printf("[Filter] %-6s %7.1f ns/sample host\n", config->name, ns);
+        TEST_ASSERT_LESS_THAN_MESSAGE(5000, (uint32_t)ns, config->name);
+    }
+}
+
+/**
+ * Calls without a new sequence number return the last result and cost a
+ * fraction of a new sample.
+ */
+void test_same_sequence_is_free() {
+    MySensorFilter filter(sensorFilterSmooth);
+    for (uint32_t i = 0; i < 20; i++) filter.update(noisy(i));
+    SensorSnapshot last = filter.get();
+    SensorSnapshot same = noisy(19);
+    same.temperatureC += 500;  // ignored, the sequence is not new
+
+    int32_t sink = 0;
+    uint64_t start = hostNanos();
+    for (uint32_t i = 0; i < SAMPLES; i++) sink += filter.update(same).temperatureC;
+    double repeat = (double)(hostNanos() - start) / SAMPLES;
+    double sample = nanosPerSample(sensorFilterSmooth);
+    printf("[Filter] smooth %7.1f ns/sample, %5.1f ns per call without one\n",
+           sample, repeat);
+
+    TEST_ASSERT_EQUAL_INT32(last.temperatureC * SAMPLES, sink);
+    TEST_ASSERT_EQUAL_INT32(last.temperatureC, filter.get().temperatureC);
+    TEST_ASSERT_LESS_THAN((uint32_t)sample, (uint32_t)(repeat * 4));
+}
+
+/**
+ * A single spike passes raw, is held back by clean and smooth.
+ */
+void test_spike() {
+    int32_t spike[3];
+    for (uint8_t c = 0; c < 3; c++) {
+        MySensorFilter filter(*configs[c]);
+        for (uint32_t i = 1; i < 50; i++) filter.update(noisy(i));
+        spike[c] = filter.update(noisy(50)).pressure;  // +900 Pa
+    }
+    TEST_ASSERT_GREATER_THAN(102000, spike[0]);
+    TEST_ASSERT_LESS_THAN(101335, spike[1]);
+    TEST_ASSERT_LESS_THAN(101335, spike[2]);
+}
+
+/**
+ * After the sensor was offline, the first samples are taken as they are
+ * instead of being rejected as a jump from the values before the outage.
+ */
+void test_outage_resets() {
+    MySensorFilter filter(sensorFilterClean);
+    for (uint32_t i = 1; i < 50; i++) filter.update(noisy(i));
+
+    SensorSnapshot offline;
+    TEST_ASSERT_FALSE(filter.update(offline).valid);
+
+    SensorSnapshot s = noisy(100);
+    s.pressure += 1200;  // e.g. carried upstairs while unplugged
+    TEST_ASSERT_EQUAL_INT32(s.pressure, filter.update(s).pressure);
+    s.sequence++;
+    TEST_ASSERT_EQUAL_INT32(s.pressure, filter.update(s).pressure);
+}
+
+/**
+ * The on-device benchmark runs on a scratch copy.
+ */
+void test_print_benchmark() {
+    MySensorFilter filter(sensorFilterSmooth);
+    filter.update(noisy(0));
+    SensorSnapshot before = filter.get();
+    filter.printBenchmark();
+    TEST_ASSERT_EQUAL_UINT32(before.sequence, filter.get().sequence);
+    TEST_ASSERT_EQUAL_INT32(before.temperatureC, filter.get().temperatureC);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sample_cost);
+    RUN_TEST(test_same_sequence_is_free);
+    RUN_TEST(test_spike);
+    RUN_TEST(test_outage_resets);
+    RUN_TEST(test_print_benchmark);
+    return UNITY_END();
+}
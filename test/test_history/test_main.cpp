@@ -0,0 +1,265 @@
+/**
+ * test_history
+ * Benjamin Hartmann | 10/2026
+ *
+ * Feeds MySensorHistory with synthetic snapshots and checks the roll-up
+ * from the 1 s tier into minute and hour buckets, gaps, thinning of fast
+ * profiles, the packed buckets, the heap budget, the JSON export and the
+ * millis() wrap after 49.7 days.
+ *
+ *   pio test -e native -f test_history
+ */
+
+#include <unity.h>
+
+#include <string>
+
+#include "MySensorHistory.h"
+
+/**
+ * `ms` is 32 bit like millis() on the ESP8266, also on a 64 bit host.
+ */
+static SensorSnapshot snapshotAt(uint32_t ms, int32_t temperature) {
+    SensorSnapshot s;
+    s.valid = true;
+    s.millis = ms;
+    s.temperatureC = temperature;
+    s.humidity = 4500;
+    s.pressure = 101325;
+    return s;
+}
+
+/**
+ * Add one sample per second for `seconds`, starting at `ms`, the
+ * temperature counting up from `temperature`.
+ * @return millis() after the last sample
+ */
+static uint32_t feed(MySensorHistory& history, uint32_t ms,
+                          uint32_t seconds, int32_t temperature = 2000) {
+    for (uint32_t i = 0; i < seconds; i++, ms += 1000) {
+        history.add(snapshotAt(ms, temperature + i % 60));
+    }
+    return ms;
+}
+
+static uint16_t countGaps(const MyRing<HistorySample>& ring) {
+    uint16_t gaps = 0;
+    for (uint16_t i = 0; i < ring.size(); i++) {
+        gaps += ring.at(i).temperature == HISTORY_EMPTY;
+    }
+    return gaps;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+/**
+ * Every full minute closes one bucket with the min, average and max of its
+ * 60 samples; every full hour one bucket of its 60 minute buckets.
+ */
+void test_roll_up() {
+    MySensorHistory history;
+    TEST_ASSERT_TRUE(history.begin());
+    feed(history, 0, 2 * 3600 + 1);
+
+    TEST_ASSERT_EQUAL_UINT16(HISTORY_SECONDS, history.getSeconds().size());
+    TEST_ASSERT_EQUAL_UINT16(120, history.getMinutes().size());
+    TEST_ASSERT_EQUAL_UINT16(1, history.getHours().size());  // 2nd still open
+
+    // 2000..2059 every minute: average 2029 rounded to 2030, spread rounded
+    // outwards
+    HistoryChannel minute = history.getMinutes().at(0).temperature();
+    TEST_ASSERT_EQUAL_INT16(2030, minute.avg);
+    TEST_ASSERT_TRUE(minute.low() <= 2000 && minute.low() > 2000 - HISTORY_SPREAD_UNIT);
+    TEST_ASSERT_TRUE(minute.high() >= 2059 && minute.high() < 2059 + HISTORY_SPREAD_UNIT);
+
+    HistoryChannel hour = history.getHours().at(0).temperature();
+    TEST_ASSERT_EQUAL_INT16(2030, hour.avg);
+    TEST_ASSERT_TRUE(hour.low() <= 2000 && hour.high() >= 2059);
+    TEST_ASSERT_EQUAL_INT16(4500, history.getHours().at(0).humidity().avg);
+    TEST_ASSERT_EQUAL_INT16(1330, history.getHours().at(0).pressure().avg);
+}
+
+/**
+ * A faster profile keeps one sample per second, a slower one or an outage
+ * leaves gaps in every tier it spans.
+ */
+void test_thinning_and_gaps() {
+    MySensorHistory history;
+    TEST_ASSERT_TRUE(history.begin());
+    for (uint32_t ms = 0; ms < 10000; ms += 100) {
+        history.add(snapshotAt(ms, 2000));
+    }
+    TEST_ASSERT_EQUAL_UINT16(10, history.getSeconds().size());
+
+    feed(history, 10000, 50);                  // to 01:00
+    feed(history, 60000 + 300000, 1);         // 5 min offline
+    TEST_ASSERT_EQUAL_UINT16(300, countGaps(history.getSeconds()));
+    TEST_ASSERT_EQUAL_UINT16(6, history.getMinutes().size());
+    uint8_t empty = 0;
+    for (uint16_t i = 0; i < history.getMinutes().size(); i++) {
+        empty += history.getMinutes().at(i).temperature().avg == HISTORY_EMPTY;
+    }
+    TEST_ASSERT_EQUAL_UINT8(5, empty);
+
+    SensorSnapshot invalid;
+    history.add(invalid);
+    TEST_ASSERT_EQUAL_UINT32(360, history.getLastSecond());
+}
+
+/**
+ * Buckets hold 8 bytes. Averages and spreads survive the packing within
+ * one HISTORY_SPREAD_UNIT, wide spreads and values out of range are
+ * clamped, gaps stay gaps.
+ */
+void test_bucket_packing() {
+    TEST_ASSERT_EQUAL(8, sizeof(HistoryBucket));
+
+    const HistoryChannel t = {-1230, 3, 39};  // -12.3 °C, -12.6 .. -8.4
+    const HistoryChannel h = {10000, 255, 0}; // 100 %RH
+    const HistoryChannel p = {-3270, 16, 1};  // 967.3 hPa
+    HistoryBucket b = HistoryBucket::pack(t, h, p);
+    TEST_ASSERT_EQUAL_INT16(-1230, b.temperature().avg);
+    TEST_ASSERT_EQUAL_INT16(t.low(), b.temperature().low());
+    TEST_ASSERT_EQUAL_INT16(t.high(), b.temperature().high());
+    TEST_ASSERT_EQUAL_INT16(10000, b.humidity().avg);
+    TEST_ASSERT_EQUAL_UINT8(79, b.humidity().below);
+    TEST_ASSERT_EQUAL_INT16(-3270, b.pressure().avg);
+    TEST_ASSERT_EQUAL_UINT8(19, b.pressure().below);  // 16 rounded up
+    TEST_ASSERT_EQUAL_UINT8(1, b.pressure().above);
+
+    const HistoryChannel hot = {15000, 0, 0};  // 150 °C
+    TEST_ASSERT_EQUAL_INT16(10460, HistoryBucket::pack(hot, h, p).temperature().avg);
+
+    const HistoryChannel gap = {HISTORY_EMPTY, 0, 0};
+    HistoryBucket empty = HistoryBucket::pack(gap, gap, gap);
+    TEST_ASSERT_EQUAL_INT16(HISTORY_EMPTY, empty.temperature().avg);
+    TEST_ASSERT_EQUAL_INT16(HISTORY_EMPTY, empty.humidity().avg);
+    TEST_ASSERT_EQUAL_INT16(HISTORY_EMPTY, empty.pressure().avg);
+}
+
+/**
+ * All tiers get their full span within the default budget. With less, the
+ * minute and hour tiers shrink to fit and the 1 s tier stays complete.
+ */
+void test_budget() {
+    MySensorHistory history;
+    TEST_ASSERT_TRUE(history.begin());
+    TEST_ASSERT_TRUE(history.getFootprint() <= SENSOR_HISTORY_BUDGET);
+    TEST_ASSERT_EQUAL_UINT16(HISTORY_SECONDS, history.getSeconds().capacity());
+    TEST_ASSERT_EQUAL_UINT16(HISTORY_MINUTES, history.getMinutes().capacity());
+    TEST_ASSERT_EQUAL_UINT16(HISTORY_HOURS, history.getHours().capacity());
+    history.printFootprint();
+
+    MySensorHistory small(8 * 1024);
+    TEST_ASSERT_TRUE(small.begin());
+    TEST_ASSERT_TRUE(small.getFootprint() <= 8 * 1024);
+    TEST_ASSERT_EQUAL_UINT16(HISTORY_SECONDS, small.getSeconds().capacity());
+    TEST_ASSERT_TRUE(small.getMinutes().capacity() < HISTORY_MINUTES);
+    small.printFootprint();
+}
+
+/**
+ * Export a tier in chunks of `size` bytes, adding `during` samples after
+ * the first chunk, whose length goes to `first`.
+ */
+static std::string exportTier(MySensorHistory& history, HistoryTier tier,
+                              size_t size, uint32_t during = 0,
+                              size_t* first = nullptr) {
+    std::string json;
+    char buffer[256];
+    HistoryExport e = history.beginExport(tier);
+    size_t n;
+    while ((n = history.exportJson(e, buffer, size))) {
+        TEST_ASSERT_TRUE(n <= size);
+        json.append(buffer, n);
+        if (first && json.size() == n) *first = n;
+        if (during) {
+            feed(history, (history.getLastSecond() + 1) * 1000, during);
+            during = 0;
+        }
+    }
+    return json;
+}
+
+static size_t count(const std::string& json, const std::string& part) {
+    size_t found = 0;
+    for (size_t pos = 0; (pos = json.find(part, pos)) != std::string::npos; pos++) found++;
+    return found;
+}
+
+/**
+ * The export comes in whole rows per chunk, oldest first, with gaps as
+ * null. Samples added while it runs neither break nor extend it.
+ */
+void test_export_json() {
+    MySensorHistory history;
+    TEST_ASSERT_TRUE(history.begin());
+    feed(history, 0, 120, 2000);
+    feed(history, 130000, 50, 2100);  // 10 s gap
+
+    std::string seconds = exportTier(history, HISTORY_TIER_SECONDS, HISTORY_ROW_SIZE);
+    TEST_ASSERT_EQUAL(0, seconds.find("{\"tier\":\"seconds\",\"step\":1,\"rows\":"
+                                      "[[2000,4500,101325],"));
+    TEST_ASSERT_EQUAL(170, count(seconds, "[") - 1);
+    TEST_ASSERT_EQUAL(10, count(seconds, "null"));
+    TEST_ASSERT_EQUAL(seconds.size() - 20, seconds.find("[2149,4500,101325]]}"));
+
+    std::string minutes = exportTier(history, HISTORY_TIER_MINUTES, 100);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"tier\":\"minutes\",\"step\":60,\"rows\":["
+        "[2030,2000,2060,4500,4500,4500,101330,101320,101330],"
+        "[2030,2000,2060,4500,4500,4500,101330,101320,101330]]}",
+        minutes.c_str());
+
+    // The 1 s tier is full, new samples overwrite the oldest rows
+    feed(history, 180000, HISTORY_SECONDS);
+    uint32_t last = history.getLastSecond();
+    size_t first;
+    seconds = exportTier(history, HISTORY_TIER_SECONDS, 200, 30, &first);
+    size_t sent = count(seconds.substr(0, first), "[") - 1;  // before the 30
+    TEST_ASSERT_EQUAL(HISTORY_SECONDS - 30 + sent, count(seconds, "[") - 1);
+    TEST_ASSERT_EQUAL(last + 30, history.getLastSecond());
+    TEST_ASSERT_EQUAL(0, count(seconds, ",,"));
+    TEST_ASSERT_EQUAL(0, count(seconds, "[,"));
+
+    HistoryTier tier;
+    TEST_ASSERT_TRUE(MySensorHistory::parseTier("hours", tier));
+    TEST_ASSERT_EQUAL(HISTORY_TIER_HOURS, tier);
+    TEST_ASSERT_FALSE(MySensorHistory::parseTier("days", tier));
+}
+
+/**
+ * Across the millis() wrap the seconds keep counting: no gap, no cleared
+ * tier, and the minute and hour buckets keep closing on time.
+ */
+void test_millis_wrap() {
+    MySensorHistory history;
+    TEST_ASSERT_TRUE(history.begin());
+    uint32_t ms = feed(history, UINT32_MAX - 2 * 3600 * 1000UL, 2 * 3600);
+    uint32_t before = history.getLastSecond();
+    uint16_t minutes = history.getMinutes().size();
+    uint16_t hours = history.getHours().size();
+
+    ms = feed(history, ms, 2 * 3600);  // wraps after a few ms
+    TEST_ASSERT_TRUE(ms < 3 * 3600 * 1000UL);
+    TEST_ASSERT_EQUAL_UINT32(before + 2 * 3600, history.getLastSecond());
+    TEST_ASSERT_EQUAL_UINT16(0, countGaps(history.getSeconds()));
+    TEST_ASSERT_EQUAL_UINT16(minutes + 120, history.getMinutes().size());
+    TEST_ASSERT_EQUAL_UINT16(hours + 2, history.getHours().size());
+    for (uint16_t i = 0; i < history.getMinutes().size(); i++) {
+        TEST_ASSERT_TRUE(history.getMinutes().at(i).temperature().avg != HISTORY_EMPTY);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_roll_up);
+    RUN_TEST(test_thinning_and_gaps);
+    RUN_TEST(test_bucket_packing);
+    RUN_TEST(test_budget);
+    RUN_TEST(test_export_json);
+    RUN_TEST(test_millis_wrap);
+    return UNITY_END();
+}
@@ -0,0 +1,281 @@
+/**
+ * test_log
+ * Benjamin Hartmann | 10/2026
+ *
+ * Runs MySensorLog on a LittleFS backed by a host directory: round trips,
+ * a reboot in between, the worst case record size, a block cut short by a
+ * reset, segment rotation, range scans and reads through a cursor. Also
+ * reports bytes per sample and the estimated flash write amplification for
+ * a day of data.
+ *
+ *   pio test -e native -f test_log
+ */
+
+#include <unity.h>
+
+#include <memory>
+#include <vector>
+
+#include "MySensorLog.h"
+
+#define START_EPOCH 1792000000UL  // 2026-10-14
+#define DAY 86400
+
+struct Logged {
+    uint32_t epoch;
+    HistorySample sample;
+};
+
+static SensorSnapshot snapshotAt(uint32_t epoch, int32_t temperature,
+                                 int32_t humidity, int32_t pressure) {
+    SensorSnapshot s;
+    s.valid = true;
+    s.epoch = epoch;
+    s.temperatureC = temperature;
+    s.humidity = humidity;
+    s.pressure = pressure;
+    return s;
+}
+
+/**
+ * Slowly changing indoor values with sensor noise.
+ */
+static SensorSnapshot realistic(uint32_t epoch) {
+    uint32_t t = epoch - START_EPOCH;
+    return snapshotAt(epoch, 2100 + (int32_t)(150 * sin(t / 7000.0)) + random(-3, 4),
+                      4500 + (int32_t)(300 * sin(t / 11000.0)) + random(-10, 11),
+                      101300 + (int32_t)(200 * sin(t / 40000.0)) + random(-2, 3));
+}
+
+static std::vector<Logged> scanAll(MySensorLog& log, uint32_t from = 0,
+                                   uint32_t to = UINT32_MAX) {
+    std::vector<Logged> samples;
+    log.scan(from, to, [&](uint32_t epoch, const HistorySample& s) {
+        samples.push_back({epoch, s});
+    });
+    return samples;
+}
+
+static void expectSample(const Logged& logged, const SensorSnapshot& s) {
+    HistorySample expected = MySensorHistory::encode(s);
+    TEST_ASSERT_EQUAL_UINT32(s.epoch, logged.epoch);
+    TEST_ASSERT_EQUAL_INT16(expected.temperature, logged.sample.temperature);
+    TEST_ASSERT_EQUAL_INT16(expected.humidity, logged.sample.humidity);
+    TEST_ASSERT_EQUAL_INT16(expected.pressure, logged.sample.pressure);
+}
+
+void setUp() {
+    LittleFS.format();
+    randomSeed(1);
+}
+
+void tearDown() {}
+
+/**
+ * A day at one sample per SENSOR_LOG_INTERVAL comes back unchanged, also
+ * after a reboot, and costs a few bytes per sample.
+ */
+void test_day_round_trip() {
+    std::vector<SensorSnapshot> added;
+    {
+        MySensorLog log;
+        log.begin();
+        for (uint32_t t = 0; t < DAY; t += SENSOR_LOG_INTERVAL) {
+            added.push_back(realistic(START_EPOCH + t));
+            log.add(added.back());
+        }
+        log.flush();
+
+        std::vector<Logged> logged = scanAll(log);
+        TEST_ASSERT_EQUAL_UINT32(added.size(), logged.size());
+        for (size_t i = 0; i < added.size(); i++) expectSample(logged[i], added[i]);
+    }
+
+    MySensorLog rebooted;
+    rebooted.begin();
+    std::vector<Logged> logged = scanAll(rebooted);
+    TEST_ASSERT_EQUAL_UINT32(added.size(), logged.size());
+    expectSample(logged.back(), added.back());
+
+    float bytesPerSample = (float)LittleFS.bytesWritten / added.size();
+    float amplification = (float)LittleFS.flashBytes / LittleFS.bytesWritten;
+    printf("[Log] %u samples/day: %u B, %.2f B/sample (raw 10), %u appends, "
+           "%u B programmed, write amplification %.1fx\n",
+           (unsigned)added.size(), LittleFS.bytesWritten, bytesPerSample,
+           LittleFS.appends, LittleFS.flashBytes, amplification);
+    TEST_ASSERT_TRUE(bytesPerSample < 5);
+    TEST_ASSERT_LESS_OR_EQUAL(DAY / SENSOR_LOG_FLUSH_INTERVAL, LittleFS.appends);
+}
+
+/**
+ * Samples still in the RAM block are included in a scan.
+ */
+void test_scan_includes_buffered() {
+    MySensorLog log;
+    log.begin();
+    for (uint32_t t = 0; t < 100; t += SENSOR_LOG_INTERVAL) {
+        log.add(realistic(START_EPOCH + t));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, LittleFS.appends);
+    TEST_ASSERT_EQUAL_UINT32(10, scanAll(log).size());
+}
+
+/**
+ * Records where every value flips all its bits, then a gap of years: the
+ * largest record encoding, which must still fit the block.
+ */
+void test_worst_case_records() {
+    MySensorLog log;
+    log.begin();
+    std::vector<SensorSnapshot> added;
+    uint32_t epoch = START_EPOCH;
+    for (uint8_t i = 0; i < 51; i++, epoch += SENSOR_LOG_INTERVAL) {
+        int32_t v = i & 1 ? -21846 : 21845;  // 0xAAAA and 0x5555
+        added.push_back(snapshotAt(epoch, v, v, 100000 + v));
+        log.add(added.back());
+    }
+    epoch += 0x7FFFFFF;  // delta-of-delta needs 5 bytes
+    added.push_back(snapshotAt(epoch, -21846, -21846, 100000 - 21846));
+    log.add(added.back());
+    log.flush();
+
+    std::vector<Logged> logged = scanAll(log);
+    TEST_ASSERT_EQUAL_UINT32(added.size(), logged.size());
+    for (size_t i = 0; i < added.size(); i++) expectSample(logged[i], added[i]);
+}
+
+/**
+ * A block cut short by a reset ends its segment; everything before it is
+ * still read, and logging continues after the reboot.
+ */
+void test_truncated_block() {
+    MySensorLog log;
+    log.begin();
+    uint32_t t = 0;
+    for (; t < 3 * SENSOR_LOG_FLUSH_INTERVAL; t += SENSOR_LOG_INTERVAL) {
+        log.add(realistic(START_EPOCH + t));
+    }
+    log.flush();
+    size_t complete = scanAll(log).size();
+
+    std::string segment = LittleFS.root() + SENSOR_LOG_DIR "/00000001.bin";
+    std::filesystem::resize_file(segment, std::filesystem::file_size(segment) - 7);
+
+    MySensorLog rebooted;
+    rebooted.begin();
+    size_t left = scanAll(rebooted).size();
+    TEST_ASSERT_TRUE(left < complete);
+    TEST_ASSERT_TRUE(left >= complete - SENSOR_LOG_FLUSH_INTERVAL / SENSOR_LOG_INTERVAL);
+}
+
+/**
+ * Only SENSOR_LOG_SEGMENTS segments are kept, the oldest go first.
+ */
+void test_rotation() {
+    MySensorLog log;
+    log.begin();
+    uint32_t epoch = START_EPOCH;
+    while (true) {
+        log.add(realistic(epoch));
+        epoch += SENSOR_LOG_INTERVAL;
+        if (LittleFS.exists(SENSOR_LOG_DIR "/00000018.bin")) break;
+    }
+    log.flush();
+
+    uint8_t files = 0;
+    Dir dir = LittleFS.openDir(SENSOR_LOG_DIR);
+    while (dir.next()) files++;
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_LOG_SEGMENTS, files);
+    TEST_ASSERT_FALSE(LittleFS.exists(SENSOR_LOG_DIR "/00000002.bin"));
+    TEST_ASSERT_TRUE(LittleFS.exists(SENSOR_LOG_DIR "/00000003.bin"));
+    TEST_ASSERT_TRUE(scanAll(log).front().epoch > START_EPOCH);
+}
+
+/**
+ * A range scan returns exactly the samples inside it.
+ */
+void test_range_scan() {
+    MySensorLog log;
+    log.begin();
+    for (uint32_t t = 0; t < DAY / 4; t += SENSOR_LOG_INTERVAL) {
+        log.add(realistic(START_EPOCH + t));
+    }
+    uint32_t from = START_EPOCH + 3600;
+    uint32_t to = START_EPOCH + 7200;
+    std::vector<Logged> logged = scanAll(log, from, to);
+    TEST_ASSERT_EQUAL_UINT32(3600 / SENSOR_LOG_INTERVAL + 1, logged.size());
+    TEST_ASSERT_EQUAL_UINT32(from, logged.front().epoch);
+    TEST_ASSERT_EQUAL_UINT32(to, logged.back().epoch);
+
+    log.printRange(from, from + 30);
+}
+
+/**
+ * Reading a day in pieces of 8 through a cursor, with a reboot halfway,
+ * returns every sample once, in order. Each piece reads about one block,
+ * however far into the log it is. Samples still in RAM are read up to the
+ * given end, also when the callback skips them.
+ */
+void test_cursor_read() {
+    std::unique_ptr<MySensorLog> log(new MySensorLog());
+    log->begin();
+    for (uint32_t t = 0; t < DAY; t += SENSOR_LOG_INTERVAL) {
+        log->add(realistic(START_EPOCH + t));
+    }
+    std::vector<Logged> all = scanAll(*log);
+
+    LogCursor cursor = log->recent(0);
+    TEST_ASSERT_EQUAL_UINT32(2, cursor.segment);
+    cursor = {0, 0, 0};
+    std::vector<Logged> read;
+    uint32_t maxRead = 0;
+    uint32_t n;
+    do {
+        if (read.size() == all.size() / 2) {
+            log->flush();  // a clean restart, the cursor was saved
+            log.reset(new MySensorLog());
+            log->begin();
+        }
+        uint32_t bytes = LittleFS.bytesRead;
+        n = log->read(cursor, UINT32_MAX,
+                      [&](uint32_t epoch, const HistorySample& s) {
+                          read.push_back({epoch, s});
+                          return true;
+                      },
+                      8);
+        maxRead = max(maxRead, LittleFS.bytesRead - bytes);
+    } while (n == 8);
+
+    printf("[Log] %u samples read in pieces of 8, max. %u B read per piece\n",
+           (unsigned)read.size(), maxRead);
+    TEST_ASSERT_EQUAL_UINT32(all.size(), read.size());
+    for (size_t i = 0; i < all.size(); i++) {
+        TEST_ASSERT_EQUAL_UINT32(all[i].epoch, read[i].epoch);
+        TEST_ASSERT_EQUAL_INT16(all[i].sample.pressure, read[i].sample.pressure);
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(2 * (SENSOR_LOG_HEADER_SIZE + SENSOR_LOG_BLOCK_SIZE), maxRead);
+
+    // Up to `to` only, and skipped samples move the cursor as well
+    uint32_t last = all.back().epoch;
+    log->add(realistic(last + SENSOR_LOG_INTERVAL));
+    log->add(realistic(last + 2 * SENSOR_LOG_INTERVAL));
+    log->add(realistic(last + 3 * SENSOR_LOG_INTERVAL));
+    n = log->read(cursor, last + 2 * SENSOR_LOG_INTERVAL,
+                  [](uint32_t epoch, const HistorySample& s) { return false; }, 8);
+    TEST_ASSERT_EQUAL_UINT32(0, n);
+    TEST_ASSERT_EQUAL_UINT32(last + 2 * SENSOR_LOG_INTERVAL, cursor.epoch);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_day_round_trip);
+    RUN_TEST(test_scan_includes_buffered);
+    RUN_TEST(test_worst_case_records);
+    RUN_TEST(test_truncated_block);
+    RUN_TEST(test_rotation);
+    RUN_TEST(test_range_scan);
+    RUN_TEST(test_cursor_read);
+    int failures = UNITY_END();
+    std::filesystem::remove_all(LittleFS.root());
+    return failures;
+}
@@ -0,0 +1,506 @@
+/**
+ * test_mqtt
+ * Benjamin Hartmann | 10/2026
+ *
+ * Runs MyMqtt with a MySensorLog against the emulated broker through
+ * broker outages and reboots: samples logged while the broker was away
+ * come back on the backlog topic once, in order, and together with the
+ * live telemetry they cover the whole log. A short outage is replayed from
+ * RAM, a long one from the log without rereading it, and beyond the span
+ * the overflow policy drops or thins the oldest. Reconnect attempts back off
+ * and never block the loop, whatever the broker does. Publishing a
+ * sample does not allocate, checked with a counting operator new, and the
+ * on-device heap test publishes through a loopback client only.
+ *
+ *   pio test -e native -f test_mqtt
+ */
+
+#include <unity.h>
+
+#include <memory>
+#include <new>
+#include <set>
+
+#include "MyMqtt.h"
+
+#define EPOCH_START 1760000000
+#define HEAP_TEST_HOURS 24  // simulated per publish mode
+
+static bool countAllocations = false;
+static uint32_t allocations = 0;
+
+// Not inlined, so GCC does not pair the malloc() in one with the free() in
+// the other and warn about mismatched new/delete.
+__attribute__((noinline)) void* operator new(size_t size) {
+    if (countAllocations) allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t size) noexcept { free(p); }
+
+/**
+ * What survives a reboot is LittleFS, everything else starts over.
+ */
+struct Device {
+    MySensorLog log;
+    MyMqtt mqtt = MyMqtt(log, "ESP8266", "Test", "home/");
+};
+
+static std::unique_ptr<Device> device;
+static unsigned long lastSample = 0;
+static unsigned long longestLoop = 0;  // ms, longest MyMqtt::loop()
+static uint32_t sequence = 0;
+
+static void boot() {
+    device.reset(new Device());
+    device->log.begin();
+    device->mqtt.begin();
+    device->mqtt.setMode(MQTT_PUBLISH_BATCH);  // carries the epoch
+}
+
+/**
+ * A sample every second, with a temperature that changes by more than
+ * the deadband each time so every one goes out live.
+ */
+static void sample() {
+    SensorSnapshot s;
+    s.valid = true;
+    s.sequence = ++sequence;
+    s.millis = millis();
+    s.epoch = EPOCH_START + millis() / 1000;
+    s.temperatureC = 2000 + sequence % 50 * 20;
+    s.humidity = 4500;
+    s.pressure = 101325;
+    device->log.add(s);
+    device->mqtt.track(s);
+    device->mqtt.publishSample(s, "now");
+}
+
+/**
+ * Run the main loop for `ms` of emulated time.
+ */
+static void run(unsigned long ms) {
+    unsigned long end = millis() + ms;
+    while ((long)(millis() - end) < 0) {
+        fakeAdvance(50);
+        if (millis() - lastSample >= 1000) {
+            lastSample += 1000;
+            sample();
+        }
+        unsigned long start = millis();
+        device->mqtt.loop();
+        longestLoop = max(longestLoop, millis() - start);
+    }
+}
+
+static std::vector<uint32_t> liveEpochs() {
+    std::vector<uint32_t> epochs;
+    for (const FakeMqttMessage& m : fakeBroker.on(MQTT_TOPIC_TELEMETRY)) {
+        size_t t = m.payload.find("\"t\":");
+        if (t != std::string::npos) epochs.push_back(strtoul(m.payload.c_str() + t + 4, nullptr, 10));
+    }
+    return epochs;
+}
+
+/**
+ * Epochs of all backlog messages: {"v":1,"s":[[epoch,t,h,p],...]}
+ */
+static std::vector<uint32_t> backlogEpochs() {
+    std::vector<uint32_t> epochs;
+    for (const FakeMqttMessage& m : fakeBroker.on(MQTT_TOPIC_BACKLOG)) {
+        TEST_ASSERT_FALSE(m.retain);
+        size_t pos = m.payload.find("\"s\":[");
+        TEST_ASSERT_NOT_EQUAL(std::string::npos, pos);
+        pos += 4;  // the outer '['
+        while ((pos = m.payload.find('[', pos + 1)) != std::string::npos) {
+            epochs.push_back(strtoul(m.payload.c_str() + pos + 1, nullptr, 10));
+        }
+    }
+    return epochs;
+}
+
+static std::vector<uint32_t> loggedEpochs() {
+    std::vector<uint32_t> epochs;
+    device->log.scan(0, UINT32_MAX, [&](uint32_t epoch, const HistorySample& s) {
+        epochs.push_back(epoch);
+    });
+    return epochs;
+}
+
+/**
+ * First live sample after the outage.
+ */
+static uint32_t outageEnd(uint32_t outageStart) {
+    for (uint32_t epoch : liveEpochs()) {
+        if (epoch > outageStart) return epoch;
+    }
+    return UINT32_MAX;
+}
+
+/**
+ * Every sample logged from `outageStart` until live telemetry resumed was
+ * replayed, and nothing else was.
+ * @return samples replayed more than once
+ */
+static uint32_t expectBacklog(uint32_t outageStart) {
+    uint32_t end = outageEnd(outageStart);
+
+    std::set<uint32_t> replayed;
+    uint32_t duplicates = 0;
+    for (uint32_t epoch : backlogEpochs()) {
+        TEST_ASSERT_GREATER_OR_EQUAL(outageStart, epoch);
+        TEST_ASSERT_LESS_THAN_MESSAGE(end, epoch, "replayed a sample that went out live");
+        duplicates += !replayed.insert(epoch).second;
+    }
+    for (uint32_t epoch : loggedEpochs()) {
+        if (epoch < outageStart || epoch >= end) continue;
+        char message[48];
+        snprintf(message, sizeof(message), "sample %u never replayed", epoch);
+        TEST_ASSERT_TRUE_MESSAGE(replayed.count(epoch), message);
+    }
+    return duplicates;
+}
+
+void setUp() {
+    LittleFS.format();
+    fakeBroker.reset();
+    fakeSetMillis(0);
+    lastSample = 0;
+    longestLoop = 0;
+    sequence = 0;
+    boot();
+}
+
+void tearDown() { device.reset(); }
+
+/**
+ * Half an hour without a broker: the samples logged meanwhile are
+ * replayed once, in order, and nothing that went out live is sent again.
+ */
+void test_broker_outage() {
+    run(60000);
+    TEST_ASSERT_TRUE(device->mqtt.isConnected());
+    TEST_ASSERT_FALSE(device->mqtt.hasBacklog());
+    TEST_ASSERT_EQUAL(0, fakeBroker.on(MQTT_TOPIC_BACKLOG).size());
+
+    fakeBroker.state = BROKER_REFUSING;
+    uint32_t outageStart = EPOCH_START + 61;  // first sample without broker
+    run(1800000);
+    TEST_ASSERT_FALSE(device->mqtt.isConnected());
+    TEST_ASSERT_TRUE(device->mqtt.hasBacklog());
+    TEST_ASSERT_TRUE(LittleFS.exists(MQTT_BACKLOG_FILE));
+
+    fakeBroker.state = BROKER_UP;
+    uint32_t bytesRead = LittleFS.bytesRead;
+    run(90000);
+    TEST_ASSERT_TRUE(device->mqtt.isConnected());
+    TEST_ASSERT_FALSE(device->mqtt.hasBacklog());
+    TEST_ASSERT_FALSE(LittleFS.exists(MQTT_BACKLOG_FILE));
+
+    std::vector<uint32_t> backlog = backlogEpochs();
+    size_t messages = fakeBroker.on(MQTT_TOPIC_BACKLOG).size();
+    bytesRead = LittleFS.bytesRead - bytesRead;
+    printf("[MQTT] %zu samples replayed in %zu messages, %u B read from the log\n",
+           backlog.size(), messages, bytesRead);
+    // Each message from the log reads about its block, none rescans the log
+    TEST_ASSERT_LESS_OR_EQUAL(messages * 2 * (SENSOR_LOG_HEADER_SIZE + SENSOR_LOG_BLOCK_SIZE),
+                              bytesRead);
+    TEST_ASSERT_GREATER_OR_EQUAL(1800 / SENSOR_LOG_INTERVAL, backlog.size());
+    for (size_t i = 1; i < backlog.size(); i++) {
+        TEST_ASSERT_GREATER_THAN(backlog[i - 1], backlog[i]);
+    }
+    TEST_ASSERT_EQUAL(0, expectBacklog(outageStart));
+}
+
+/**
+ * Five minutes without a broker fit the RAM ring: the replay reads nothing
+ * from flash.
+ */
+void test_short_outage() {
+    run(60000);
+    fakeBroker.state = BROKER_REFUSING;
+    uint32_t outageStart = EPOCH_START + 61;
+    run(300000);
+    TEST_ASSERT_TRUE(device->mqtt.hasBacklog());
+
+    fakeBroker.state = BROKER_UP;
+    uint32_t bytesRead = LittleFS.bytesRead;
+    run(90000);
+    TEST_ASSERT_FALSE(device->mqtt.hasBacklog());
+    TEST_ASSERT_EQUAL_UINT32(bytesRead, LittleFS.bytesRead);
+    TEST_ASSERT_LESS_OR_EQUAL(MQTT_QUEUE_RAM, backlogEpochs().size());
+    TEST_ASSERT_EQUAL(0, expectBacklog(outageStart));
+}
+
+/**
+ * Two hours without a broker and a span of ten minutes: drop-oldest
+ * replays the last span of spilled samples and the RAM ring, downsample
+ * all of them, coarser the older they are. Both send every sample of the
+ * newest span and of the ring.
+ */
+void test_overflow_policies() {
+    const uint32_t span = MQTT_QUEUE_SPAN_MIN;
+    const uint32_t outage = 7200;
+    for (const char* command : {"queue drop-oldest 600", "queue downsample 600"}) {
+        setUp();
+        device->mqtt.handleCommand(command, strlen(command));
+        run(60000);
+        fakeBroker.state = BROKER_REFUSING;
+        uint32_t outageStart = EPOCH_START + 61;
+        run(outage * 1000UL);
+        fakeBroker.state = BROKER_UP;
+        run(90000);
+        TEST_ASSERT_FALSE(device->mqtt.hasBacklog());
+
+        std::vector<uint32_t> backlog = backlogEpochs();
+        std::set<uint32_t> replayed(backlog.begin(), backlog.end());
+        TEST_ASSERT_EQUAL(backlog.size(), replayed.size());
+        uint32_t end = outageEnd(outageStart);
+        uint32_t complete = end - span - MQTT_QUEUE_RAM * SENSOR_LOG_INTERVAL;
+        for (uint32_t epoch : loggedEpochs()) {
+            if (epoch < complete || epoch >= end) continue;
+            TEST_ASSERT_TRUE_MESSAGE(replayed.count(epoch), "newest span not replayed in full");
+        }
+        printf("[MQTT] %s: %zu of %u samples replayed, oldest %u s into the outage\n",
+               command, backlog.size(), (end - outageStart) / SENSOR_LOG_INTERVAL,
+               backlog.front() - outageStart);
+        if (strstr(command, "drop-oldest")) {
+            TEST_ASSERT_GREATER_OR_EQUAL(complete - SENSOR_LOG_INTERVAL, backlog.front());
+            TEST_ASSERT_LESS_OR_EQUAL((span + MQTT_QUEUE_RAM * SENSOR_LOG_INTERVAL) / SENSOR_LOG_INTERVAL + 1,
+                                      backlog.size());
+        } else {
+            // 2 h are 12 spans: every 16th sample at the start
+            TEST_ASSERT_LESS_OR_EQUAL(outageStart + 17 * SENSOR_LOG_INTERVAL, backlog.front());
+            TEST_ASSERT_LESS_THAN(outage / SENSOR_LOG_INTERVAL / 2, backlog.size());
+        }
+        tearDown();
+    }
+}
+
+/**
+ * The device reboots while the broker is away: the backlog starts where
+ * the outage did, not at the reboot.
+ */
+void test_reboot_during_outage() {
+    run(60000);
+    fakeBroker.state = BROKER_REFUSING;
+    uint32_t outageStart = EPOCH_START + 61;
+    run(600000);
+
+    device->log.flush();  // a clean restart, as the "reset" command does
+    boot();
+    run(600000);
+    TEST_ASSERT_TRUE(device->mqtt.hasBacklog());
+
+    fakeBroker.state = BROKER_UP;
+    run(90000);
+    TEST_ASSERT_FALSE(device->mqtt.hasBacklog());
+
+    std::vector<uint32_t> backlog = backlogEpochs();
+    TEST_ASSERT_FALSE(backlog.empty());
+    TEST_ASSERT_LESS_OR_EQUAL(outageStart + SENSOR_LOG_INTERVAL, backlog.front());
+    TEST_ASSERT_EQUAL(0, expectBacklog(outageStart));
+}
+
+/**
+ * A reboot while catching up resends at most the samples since the last
+ * cursor save.
+ */
+void test_reboot_while_replaying() {
+    run(60000);
+    fakeBroker.state = BROKER_REFUSING;
+    uint32_t outageStart = EPOCH_START + 61;
+    run(7200000);  // 720 logged samples, 90 backlog messages
+    fakeBroker.state = BROKER_UP;
+
+    while (fakeBroker.on(MQTT_TOPIC_BACKLOG).size() < MQTT_REPLAY_SAVE * 2 + 5) {
+        run(50);
+    }
+    TEST_ASSERT_TRUE(device->mqtt.hasBacklog());
+    device->log.flush();
+    boot();
+    run(120000);
+    TEST_ASSERT_FALSE(device->mqtt.hasBacklog());
+
+    uint32_t duplicates = expectBacklog(outageStart);
+    printf("[MQTT] %u samples sent twice after the reboot\n", duplicates);
+    TEST_ASSERT_LESS_OR_EQUAL(MQTT_REPLAY_SAVE * MQTT_REPLAY_BATCH, duplicates);
+}
+
+/**
+ * The cursor is written once per outage, not per sample.
+ */
+void test_cursor_writes() {
+    run(60000);
+    fakeBroker.state = BROKER_REFUSING;
+    uint32_t appends = LittleFS.appends;
+    run(SENSOR_LOG_FLUSH_INTERVAL * 1000UL - 100000);  // before the log flushes
+    TEST_ASSERT_EQUAL_UINT32(1, LittleFS.appends - appends);
+}
+
+/**
+ * Ten minutes of an unreachable broker host, five of a broker that never
+ * answers CONNACK, two of one that refuses the CONNECT, then it is back:
+ * attempts back off instead of running every loop, no pass of the loop
+ * waits for the broker, nothing goes out before the broker accepted the
+ * connection, and the connection is back within the longest backoff.
+ */
+void test_reconnect() {
+    run(10000);
+    TEST_ASSERT_TRUE(device->mqtt.isConnected());
+    TEST_ASSERT_LESS_THAN(10, longestLoop);
+
+    fakeBroker.state = BROKER_UNREACHABLE;
+    uint32_t attempts = fakeBroker.attempts;
+    run(600000);
+    attempts = fakeBroker.attempts - attempts;
+    printf("[MQTT] %u attempts in 10 min, longest loop %lu ms\n", attempts, longestLoop);
+    TEST_ASSERT_GREATER_OR_EQUAL(600000 / (MQTT_BACKOFF_MAX + MQTT_CONNECT_TIMEOUT), attempts);
+    TEST_ASSERT_LESS_OR_EQUAL(600000 / (MQTT_BACKOFF_MAX / 2) + 7, attempts);
+    TEST_ASSERT_LESS_THAN(10, longestLoop);
+
+    fakeBroker.state = BROKER_SILENT;
+    uint32_t published = fakeBroker.published;
+    run(300000);
+    TEST_ASSERT_LESS_THAN(10, longestLoop);
+    TEST_ASSERT_FALSE(device->mqtt.isConnected());
+
+    fakeBroker.state = BROKER_REJECTING;
+    run(120000);
+    printf("[MQTT] %u CONNECTs refused in 2 min\n", fakeBroker.rejected);
+    TEST_ASSERT_GREATER_THAN(0, fakeBroker.rejected);
+    TEST_ASSERT_LESS_OR_EQUAL(120000 / (MQTT_BACKOFF_MAX / 2) + 1, fakeBroker.rejected);
+    TEST_ASSERT_LESS_THAN(10, longestLoop);
+    TEST_ASSERT_FALSE(device->mqtt.isConnected());
+    TEST_ASSERT_EQUAL_UINT32(published, fakeBroker.published);
+
+    fakeBroker.state = BROKER_UP;
+    unsigned long up = millis();
+    while (!device->mqtt.isConnected()) run(50);
+    printf("[MQTT] Back after %lu ms\n", millis() - up);
+    TEST_ASSERT_LESS_OR_EQUAL(MQTT_BACKOFF_MAX, millis() - up);
+
+    run(5000);
+    TEST_ASSERT_GREATER_THAN(published, fakeBroker.published);
+    TEST_ASSERT_LESS_THAN(10, longestLoop);
+}
+
+/**
+ * The command parser, which the serial "mqtt mode" and "mqtt deadband"
+ * use as well: negative thresholds, trailing garbage in a number and bytes
+ * above 0x7F are rejected with an error acknowledgement.
+ */
+void test_commands() {
+    run(2000);
+    TEST_ASSERT_TRUE(device->mqtt.isConnected());
+    const char* commands[][2] = {
+        {"mode cbor", "ok mode cbor"},
+        {"mode json", "error mode: usage: mode <fields|batch|cbor>"},
+        {"deadband temperature 20 200", "ok deadband temperature 20 200"},
+        {"deadband temperature -5 200", "error deadband: usage: deadband <field> <deadband> <jump>"},
+        {"deadband temperature 20 -1", "error deadband: usage: deadband <field> <deadband> <jump>"},
+        {"deadband temperature 2x 200", "error deadband: usage: deadband <field> <deadband> <jump>"},
+        {"deadband temperature \xb2\xb9 200", "error deadband: usage: deadband <field> <deadband> <jump>"},
+        {"\xa0mode\xa0" "batch", "error \xa0mode\xa0" "batch: unknown command"},
+        {"  ", "error : empty command"},
+        {"queue drop-oldest 3600", "ok queue drop-oldest 3600"},
+        {"queue downsample", "ok queue downsample 3600"},
+        {"queue downsample 60", "error queue: usage: queue <drop-oldest|downsample> [<span s>]"},
+        {"queue newest", "error queue: usage: queue <drop-oldest|downsample> [<span s>]"},
+    };
+    for (auto& c : commands) {
+        device->mqtt.handleCommand(c[0], strlen(c[0]));
+        std::vector<FakeMqttMessage> acks = fakeBroker.on(MQTT_TOPIC_COMMAND_ACK);
+        TEST_ASSERT_FALSE(acks.empty());
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(c[1], acks.back().payload.c_str(), c[0]);
+    }
+    TEST_ASSERT_EQUAL(MQTT_PUBLISH_CBOR, device->mqtt.getMode());
+}
+
+/**
+ * Hours of one-second samples in each publish mode, through the publish
+ * path and the client as in operation, with a drifting temperature so
+ * deadbands, jumps and heartbeats all trigger: not one heap allocation.
+ * The fake broker only counts the messages here, storing them would
+ * allocate.
+ */
+void test_publish_without_allocations() {
+    run(2000);
+    TEST_ASSERT_TRUE(device->mqtt.isConnected());
+
+    countAllocations = true;
+    delete new uint32_t(0);  // the counter works
+    countAllocations = false;
+    TEST_ASSERT_EQUAL_UINT32(1, allocations);
+
+    fakeBroker.keep = false;
+    for (MqttPublishMode m : {MQTT_PUBLISH_FIELDS, MQTT_PUBLISH_BATCH, MQTT_PUBLISH_CBOR}) {
+        device->mqtt.setMode(m);
+        SensorSnapshot s;
+        s.valid = true;
+        s.humidity = 4500;
+        s.pressure = 101325;
+        s.derived.tendencyValid = true;
+        s.derived.forecast = 'B';
+        uint32_t published = fakeBroker.published;
+
+        allocations = 0;
+        countAllocations = true;
+        for (uint32_t second = 0; second < HEAP_TEST_HOURS * 3600UL; second++) {
+            fakeAdvance(1000);
+            s.sequence = ++sequence;
+            s.epoch = EPOCH_START + millis() / 1000;
+            uint32_t ramp = second % 7200 < 3600 ? second % 3600 : 3600 - second % 3600;
+            s.temperatureC = 2000 + ramp / 20 + (second % 10000 == 5000 ? 150 : 0);
+            device->mqtt.publishSample(s, "Sun 18.10.2026 14:37");
+        }
+        countAllocations = false;
+
+        published = fakeBroker.published - published;
+        printf("[MQTT] %-6s %6u messages in %u h, %u allocations\n",
+               MyMqtt::getModeName(m), published, HEAP_TEST_HOURS, allocations);
+        TEST_ASSERT_GREATER_THAN_MESSAGE(HEAP_TEST_HOURS * 10, published, MyMqtt::getModeName(m));
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, allocations, MyMqtt::getModeName(m));
+    }
+}
+
+/**
+ * The on-device heap test publishes through a PubSubClient on the
+ * loopback: the client writes every byte it counts, none of it reaches the
+ * broker, and the live connection and statistics are as before.
+ */
+void test_heap_test_loopback() {
+    run(2000);
+    TEST_ASSERT_TRUE(device->mqtt.isConnected());
+    fakeBroker.keep = false;
+    uint32_t published = fakeBroker.published;
+    uint32_t bytes = fakeBroker.bytes;
+
+    SensorSnapshot s;
+    s.temperatureC = 2000;
+    s.humidity = 4500;
+    s.pressure = 101325;
+    s.epoch = EPOCH_START;
+    TEST_ASSERT_TRUE(device->mqtt.printHeapTest(s, 1));
+    TEST_ASSERT_EQUAL_UINT32(published, fakeBroker.published);
+    TEST_ASSERT_EQUAL_UINT32(bytes, fakeBroker.bytes);
+    TEST_ASSERT_TRUE(device->mqtt.isConnected());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_broker_outage);
+    RUN_TEST(test_short_outage);
+    RUN_TEST(test_overflow_policies);
+    RUN_TEST(test_reboot_during_outage);
+    RUN_TEST(test_reboot_while_replaying);
+    RUN_TEST(test_cursor_writes);
+    RUN_TEST(test_reconnect);
+    RUN_TEST(test_commands);
+    RUN_TEST(test_publish_without_allocations);
+    RUN_TEST(test_heap_test_loopback);
+    return UNITY_END();
+}
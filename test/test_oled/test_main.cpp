@@ -0,0 +1,114 @@
+/**
+ * test_oled
+ * Benjamin Hartmann | 10/2026
+ *
+ * Runs the Adafruit OLED test suite and the OLED and logo benchmarks on the
+ * emulated SH1106: every primitive is drawn the way the visual suite does
+ * it (display() after each shape) and compared with golden/<primitive>.pbm,
+ * and the benchmark path (no display()) has to leave the same frame.
+ *
+ *   pio test -e native -f test_oled
+ *   UPDATE_GOLDEN=1 pio test -e native -f test_oled   rewrite the goldens
+ */
+
+#include <unity.h>
+
+#include "AdafruitOledTestSuite.h"
+#include "FakeSh1106.h"
+#include "GoldenFrame.h"
+
+#define SMOKE_ITERATIONS 5
+
+TwoWire wire;
+FakeSh1106 panel;
+MyI2CBus bus(I2C_CLOCK, wire);
+MyDisplay display(bus);
+
+static uint16_t shown = 0;
+
+static void countFrame(Adafruit_GFX& gfx) {
+    showFrame(gfx);
+    shown++;
+}
+
+void setUp() {
+    bus.reserve(millis() + 3600000UL);  // no sensor access pending
+}
+
+void tearDown() {}
+
+/**
+ * Each primitive animates on the panel and ends in its golden frame.
+ */
+void test_primitives() {
+    Adafruit_GFX& gfx = display.getCanvas();
+    for (const OledPrimitive& primitive : oledPrimitives) {
+        display.clear();
+        resetText(gfx);
+        shown = 0;
+        uint32_t before = panel.dataBytes;
+        uint64_t start = hostNanos();
+        primitive.draw(gfx, countFrame);
+        uint64_t elapsed = hostNanos() - start;
+        printf("[OLED] %-15s %3u frames shown, %7.1f µs host\n",
+               primitive.name, shown, elapsed / 1000.0);
+        TEST_ASSERT_GREATER_THAN_MESSAGE(0, shown, primitive.name);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(shown * SH1106_FRAME_SIZE,
+                                         panel.dataBytes - before,
+                                         primitive.name);
+
+        uint8_t frame[SH1106_FRAME_SIZE];
+        panel.frame(frame);
+        TEST_ASSERT_EQUAL_MEMORY_MESSAGE(display.getBuffer(), frame,
+                                         sizeof(frame), primitive.name);
+        expectGoldenFrame(__FILE__, primitive.name, frame);
+    }
+}
+
+/**
+ * The benchmark times the same drawing code without showing it.
+ */
+void test_benchmark_draws_the_same() {
+    Adafruit_GFX& gfx = display.getCanvas();
+    for (const OledPrimitive& primitive : oledPrimitives) {
+        display.clear();
+        resetText(gfx);
+        primitive.draw(gfx, showFrame);
+        uint8_t shownFrame[SH1106_FRAME_SIZE];
+        memcpy(shownFrame, display.getBuffer(), sizeof(shownFrame));
+
+        uint32_t before = panel.dataBytes;
+        display.clear();
+        resetText(gfx);
+        primitive.draw(gfx, nullptr);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(before, panel.dataBytes, primitive.name);
+        TEST_ASSERT_EQUAL_MEMORY_MESSAGE(shownFrame, display.getBuffer(),
+                                         sizeof(shownFrame), primitive.name);
+    }
+}
+
+/**
+ * Both benchmarks run to the end and leave the panel in sync.
+ */
+void test_benchmarks() {
+    runOledBenchmark(display, SMOKE_ITERATIONS);
+    runLogoBenchmark(display, SMOKE_ITERATIONS);
+    display.invalidate();
+    TEST_ASSERT_TRUE(display.flush());
+
+    uint8_t frame[SH1106_FRAME_SIZE];
+    panel.frame(frame);
+    TEST_ASSERT_EQUAL_MEMORY(display.getBuffer(), frame, sizeof(frame));
+}
+
+int main(int argc, char** argv) {
+    wire.attach(0x3C, panel);
+    bus.begin();
+    display.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_primitives);
+    RUN_TEST(test_benchmark_draws_the_same);
+    RUN_TEST(test_benchmarks);
+    return UNITY_END();
+}
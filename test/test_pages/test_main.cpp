@@ -0,0 +1,114 @@
+/**
+ * test_pages
+ * Benjamin Hartmann | 10/2026
+ *
+ * Runs MyPages transitions on the emulated bus and panel the way loop()
+ * calls it, between two pages whose frames differ in every byte, so each
+ * slide frame is a full flush: a slide and a fade take all of their
+ * PAGE_TRANSITION_STEPS frames within the budget, and the fade goes down
+ * to contrast 0 and back up in even steps.
+ *
+ *   pio test -e native -f test_pages
+ */
+
+#include <unity.h>
+
+#include <vector>
+
+#include "FakeSh1106.h"
+#include "MyPages.h"
+
+#define LOOP_PERIOD 1  // ms between loop() calls
+
+TwoWire wire;
+FakeSh1106 panel;
+MyI2CBus bus(I2C_CLOCK, wire);
+MyDisplay display(bus);
+MyPages pages(display);
+
+static void pattern(MyDisplay& d, uint8_t seed) {
+    uint8_t* buffer = d.getBuffer();
+    for (uint16_t i = 0; i < OLED_FRAME_SIZE; i++) buffer[i] = i * 37 + seed;
+}
+
+static void model(MyRenderScheduler& model) {}
+static void renderA(MyDisplay& d) { pattern(d, 0); }
+static void renderB(MyDisplay& d) { pattern(d, 0x80); }
+
+const Page pageA = {"a", 500, nullptr, model, renderA, nullptr};
+const Page pageB = {"b", 500, nullptr, model, renderB, nullptr};
+
+static std::vector<uint8_t> contrasts;  // after each transition frame
+
+/**
+ * Call loop() until the next transition has run.
+ * @return frames it took, their contrasts in `contrasts`
+ */
+static uint32_t transition() {
+    contrasts.clear();
+    pages.redraw();
+    uint32_t frames = pages.getFrames();
+    bool started = false;
+    for (uint32_t pass = 0; pass < 10000; pass++) {
+        uint32_t before = pages.getFrames();
+        pages.loop();
+        if (pages.getFrames() != before && (started || pages.isTransitioning())) {
+            contrasts.push_back(panel.contrast);
+        }
+        if (pages.isTransitioning()) started = true;
+        if (started && !pages.isTransitioning()) break;
+        fakeAdvance(LOOP_PERIOD);
+    }
+    TEST_ASSERT_TRUE_MESSAGE(started, "no transition");
+    TEST_ASSERT_FALSE(pages.isTransitioning());
+    return pages.getFrames() - frames;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_slide_frames() {
+    pages.setTransition(TRANSITION_SLIDE);
+    uint32_t overruns = pages.getOverruns();
+    const char* from = pages.getCurrent();
+    TEST_ASSERT_EQUAL_UINT32(PAGE_TRANSITION_STEPS, transition());
+    TEST_ASSERT_NOT_EQUAL(0, strcmp(from, pages.getCurrent()));
+    TEST_ASSERT_EQUAL_UINT32(overruns, pages.getOverruns());
+
+    printf("[Pages] slide frame max. %u µs, budget %u µs, full flush %u µs\n",
+           pages.getMaxFrameTime(), pages.getBudget(), display.getFullFlushTime());
+    TEST_ASSERT_GREATER_THAN(20000, pages.getMaxFrameTime());  // the old budget
+    TEST_ASSERT_LESS_OR_EQUAL(pages.getBudget(), pages.getMaxFrameTime());
+
+    uint8_t frame[SH1106_FRAME_SIZE];
+    panel.frame(frame);
+    TEST_ASSERT_EQUAL_MEMORY(display.getBuffer(), frame, sizeof(frame));
+}
+
+void test_fade_frames() {
+    pages.setTransition(TRANSITION_FADE);
+    uint32_t overruns = pages.getOverruns();
+    TEST_ASSERT_EQUAL_UINT32(PAGE_TRANSITION_STEPS, transition());
+    TEST_ASSERT_EQUAL_UINT32(overruns, pages.getOverruns());
+
+    const uint8_t half = PAGE_TRANSITION_STEPS / 2;
+    TEST_ASSERT_EQUAL_UINT32(PAGE_TRANSITION_STEPS, contrasts.size());
+    for (uint8_t step = 1; step <= PAGE_TRANSITION_STEPS; step++) {
+        uint8_t level = step < half ? half - step : step - half;
+        TEST_ASSERT_EQUAL_UINT8(OLED_CONTRAST * level / half, contrasts[step - 1]);
+    }
+}
+
+int main(int argc, char** argv) {
+    wire.attach(0x3C, panel);
+    bus.begin();
+    display.begin();
+    pages.add(pageA);
+    pages.add(pageB);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_slide_frames);
+    RUN_TEST(test_fade_frames);
+    return UNITY_END();
+}
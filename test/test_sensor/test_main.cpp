@@ -0,0 +1,259 @@
+/**
+ * test_sensor
+ * Benjamin Hartmann | 10/2026
+ *
+ * Runs MySensor against a FakeBme280 on the emulated bus, the way loop()
+ * calls it: bring-up, the values of a snapshot, and the bus cost of
+ * sampling, which has to be one burst read of the data block per sample
+ * period no matter how often update() and the snapshot consumers run.
+ *
+ *   pio test -e native -f test_sensor
+ */
+
+#include <unity.h>
+
+#include "FakeBme280.h"
+#include "MySensor.h"
+
+#define LOOP_PERIOD 1  // ms between update() calls
+
+TwoWire wire;
+FakeBme280 chip;
+MyI2CBus bus(I2C_CLOCK, wire);
+MySensor* sensor;
+
+/**
+ * Call update() every LOOP_PERIOD for `ms`.
+ * @return number of new snapshots
+ */
+static uint32_t run(unsigned long ms) {
+    uint32_t samples = 0;
+    unsigned long end = millis() + ms;  // bus transfers advance the clock too
+    while ((long)(millis() - end) < 0) {
+        if (sensor->update()) samples++;
+        fakeAdvance(LOOP_PERIOD);
+    }
+    return samples;
+}
+
+/**
+ * A fresh sensor in the given profile, already ready.
+ */
+static void startSensor(uint8_t profile) {
+    delete sensor;
+    sensor = new MySensor(bus, 0x76, profile);
+    sensor->begin();
+    run(10);
+    TEST_ASSERT_EQUAL_STRING("ready", MySensor::getStateName(sensor->getState()));
+}
+
+void setUp() {
+    wire.attach(0x76, chip);
+    chip.setRaw(519888, 415148, 30000);
+    fakePins.sdaStuck = 0;
+}
+
+void tearDown() {}
+
+void test_bring_up() {
+    delete sensor;
+    sensor = new MySensor(bus);
+    uint32_t resets = chip.resets;
+    sensor->begin();
+    TEST_ASSERT_EQUAL_STRING("probing", MySensor::getStateName(sensor->getState()));
+    TEST_ASSERT_EQUAL_UINT32(resets + 1, chip.resets);
+
+    run(BME280_STARTUP_TIME + 1);
+    TEST_ASSERT_EQUAL_STRING("ready", MySensor::getStateName(sensor->getState()));
+    const SensorProfile& profile = sensorProfiles[SENSOR_DEFAULT_PROFILE];
+    TEST_ASSERT_EQUAL_HEX8(profile.standby << 5 | profile.filter << 2,
+                           chip.getRegister(BME280_REG_CONFIG));
+}
+
+void test_snapshot_values() {
+    startSensor(SENSOR_DEFAULT_PROFILE);
+    run(sensor->getSamplePeriod());
+    const SensorSnapshot& s = sensor->getSnapshot();
+    TEST_ASSERT_TRUE(s.valid);
+    TEST_ASSERT_EQUAL_INT32(2508, s.temperatureC);
+    TEST_ASSERT_EQUAL_INT32(7714, s.temperatureF);
+    TEST_ASSERT_EQUAL_INT32(100653, s.pressure);
+
+    chip.setRaw(500000, 415148, 30000);
+    uint32_t sequence = s.sequence;
+    run(sensor->getSamplePeriod());
+    TEST_ASSERT_EQUAL_UINT32(sequence + 1, s.sequence);
+    TEST_ASSERT_TRUE(s.temperatureC < 2508);
+
+    // Below 0 °C, °F rounds to nearest like above it: 9.284 °F is 9.28, not 9.29
+    chip.setRaw(400064, 415148, 30000);
+    run(sensor->getSamplePeriod());
+    TEST_ASSERT_EQUAL_INT32(-1262, s.temperatureC);
+    TEST_ASSERT_EQUAL_INT32(928, s.temperatureF);
+}
+
+/**
+ * Normal mode: one 8 byte burst read per period and nothing else, however
+ * often update() and the consumers run.
+ */
+void test_one_burst_read_per_period() {
+    for (uint8_t profile = 1; profile < SENSOR_PROFILE_COUNT; profile++) {
+        startSensor(profile);
+        unsigned long period = sensor->getSamplePeriod();
+        run(period);  // settle on the period grid
+
+        uint32_t transactions = sensor->getBusTransactions();
+        uint32_t reads = chip.dataReads;
+        uint32_t bytes = chip.bytes;
+        uint32_t samples = 0;
+        unsigned long end = millis() + 20 * period;
+        while ((long)(millis() - end) < 0) {
+            if (sensor->update()) samples++;
+            const SensorSnapshot& s = sensor->getSnapshot();  // every consumer
+            TEST_ASSERT_TRUE(s.valid);
+            fakeAdvance(LOOP_PERIOD);
+        }
+        printf("[Sensor] %-12s %3lu ms period: %u samples, %u transactions, "
+               "%u B\n",
+               sensorProfiles[profile].name, period, samples,
+               sensor->getBusTransactions() - transactions, chip.bytes - bytes);
+        TEST_ASSERT_EQUAL_UINT32(20, samples);
+        TEST_ASSERT_EQUAL_UINT32(samples, chip.dataReads - reads);
+        TEST_ASSERT_EQUAL_UINT32(samples, sensor->getBusTransactions() - transactions);
+        TEST_ASSERT_EQUAL_UINT32(samples * (1 + 8), chip.bytes - bytes);
+    }
+}
+
+/**
+ * Forced mode: a ctrl_meas write to trigger and one burst read per period.
+ */
+void test_forced_mode_per_period() {
+    startSensor(0);
+    unsigned long period = sensor->getSamplePeriod();
+    run(period);
+
+    uint32_t transactions = sensor->getBusTransactions();
+    uint32_t reads = chip.dataReads;
+    uint32_t triggers = chip.ctrlMeasWrites;
+    uint32_t samples = run(5 * period);
+    TEST_ASSERT_EQUAL_UINT32(5, samples);
+    TEST_ASSERT_EQUAL_UINT32(5, chip.dataReads - reads);
+    TEST_ASSERT_EQUAL_UINT32(5, chip.ctrlMeasWrites - triggers);
+    TEST_ASSERT_EQUAL_UINT32(10, sensor->getBusTransactions() - transactions);
+}
+
+/**
+ * Switching profiles writes ctrl_meas, ctrl_hum, config and ctrl_meas
+ * again as register/value pairs of a single transaction.
+ */
+void test_profile_switch_in_one_write() {
+    startSensor(SENSOR_DEFAULT_PROFILE);
+    uint8_t next = (SENSOR_DEFAULT_PROFILE + 1) % SENSOR_PROFILE_COUNT;
+    const SensorProfile& profile = sensorProfiles[next];
+    uint32_t writes = chip.writes;
+    uint32_t triggers = chip.ctrlMeasWrites;
+
+    TEST_ASSERT_TRUE(sensor->selectProfile(profile.name));
+    TEST_ASSERT_TRUE(sensor->isProfilePending());
+    TEST_ASSERT_EQUAL_STRING(profile.name, sensor->getRequestedProfile().name);
+    TEST_ASSERT_EQUAL_STRING(sensorProfiles[SENSOR_DEFAULT_PROFILE].name,
+                             sensor->getProfile().name);
+    sensor->update();
+    TEST_ASSERT_FALSE(sensor->isProfilePending());
+    TEST_ASSERT_EQUAL_STRING(profile.name, sensor->getProfile().name);
+    TEST_ASSERT_EQUAL_STRING(profile.name, sensor->getRequestedProfile().name);
+    TEST_ASSERT_EQUAL_UINT32(1, chip.writes - writes);
+    TEST_ASSERT_EQUAL_UINT32(2, chip.ctrlMeasWrites - triggers);
+    TEST_ASSERT_EQUAL_HEX8(profile.humidity, chip.getRegister(BME280_REG_CTRL_HUM));
+    TEST_ASSERT_EQUAL_HEX8(profile.standby << 5 | profile.filter << 2,
+                           chip.getRegister(BME280_REG_CONFIG));
+    TEST_ASSERT_EQUAL_HEX8(profile.temperature << 5 | profile.pressure << 2 | profile.mode,
+                           chip.getRegister(BME280_REG_CTRL_MEAS));
+}
+
+/**
+ * A slave holding SDA low at boot (e.g. reset in the middle of a read) is
+ * clocked free before the first probe, so the sensor still comes up.
+ */
+void test_boot_with_stuck_bus() {
+    delete sensor;
+    sensor = new MySensor(bus);
+    fakePins.sdaStuck = 5;
+    uint32_t pulses = fakePins.sclPulses;
+    sensor->begin();
+    TEST_ASSERT_EQUAL_UINT8(0, fakePins.sdaStuck);
+    TEST_ASSERT_EQUAL_UINT32(pulses + 5, fakePins.sclPulses);
+
+    run(BME280_STARTUP_TIME + 1);
+    TEST_ASSERT_EQUAL_STRING("ready", MySensor::getStateName(sensor->getState()));
+    run(sensor->getSamplePeriod());
+    TEST_ASSERT_TRUE(sensor->getSnapshot().valid);
+}
+
+/**
+ * Unplugged while sampling: faulted, then absent. Plugged back in with the
+ * bus hung, the next re-probe clears it and the sensor is ready again.
+ */
+void test_hot_plug_with_stuck_bus() {
+    startSensor(SENSOR_DEFAULT_PROFILE);
+    wire.detach(0x76);
+    run(SENSOR_MAX_FAILURES * sensor->getSamplePeriod() + 100);
+    TEST_ASSERT_EQUAL_STRING("absent", MySensor::getStateName(sensor->getState()));
+    TEST_ASSERT_FALSE(sensor->getSnapshot().valid);
+
+    wire.attach(0x76, chip);
+    fakePins.sdaStuck = 3;
+    run(SENSOR_PROBE_INTERVAL + BME280_STARTUP_TIME + 10);
+    TEST_ASSERT_EQUAL_UINT8(0, fakePins.sdaStuck);
+    TEST_ASSERT_EQUAL_STRING("ready", MySensor::getStateName(sensor->getState()));
+}
+
+/**
+ * Probing a missing sensor on a healthy bus leaves Wire alone; only the
+ * fault that made it go missing clears the bus, once, and on the pass
+ * after the one that reported it.
+ */
+void test_absent_probes_do_not_recover() {
+    startSensor(SENSOR_DEFAULT_PROFILE);
+    wire.detach(0x76);
+    uint32_t recoveries = bus.getRecoveries();
+    while (sensor->getState() == SENSOR_READY) {
+        sensor->update();
+        fakeAdvance(LOOP_PERIOD);
+    }
+    TEST_ASSERT_EQUAL_STRING("faulted", MySensor::getStateName(sensor->getState()));
+    TEST_ASSERT_EQUAL_UINT32(recoveries, bus.getRecoveries());
+
+    run(5 * SENSOR_PROBE_INTERVAL);
+    TEST_ASSERT_EQUAL_STRING("absent", MySensor::getStateName(sensor->getState()));
+    TEST_ASSERT_EQUAL_UINT32(recoveries + 1, bus.getRecoveries());
+    wire.attach(0x76, chip);
+}
+
+/**
+ * SDA stuck while ready: the reads fail, the bus is cleared and the
+ * sensor is probed again at once instead of after SENSOR_PROBE_INTERVAL.
+ */
+void test_stuck_while_ready() {
+    startSensor(SENSOR_DEFAULT_PROFILE);
+    fakePins.sdaStuck = 9;
+    run(SENSOR_MAX_FAILURES * sensor->getSamplePeriod() + 100);
+    TEST_ASSERT_EQUAL_UINT8(0, fakePins.sdaStuck);
+    TEST_ASSERT_EQUAL_STRING("ready", MySensor::getStateName(sensor->getState()));
+}
+
+int main(int argc, char** argv) {
+    bus.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_bring_up);
+    RUN_TEST(test_snapshot_values);
+    RUN_TEST(test_one_burst_read_per_period);
+    RUN_TEST(test_forced_mode_per_period);
+    RUN_TEST(test_profile_switch_in_one_write);
+    RUN_TEST(test_boot_with_stuck_bus);
+    RUN_TEST(test_hot_plug_with_stuck_bus);
+    RUN_TEST(test_absent_probes_do_not_recover);
+    RUN_TEST(test_stuck_while_ready);
+    return UNITY_END();
+}
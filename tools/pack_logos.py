@@ -0,0 +1,235 @@
+"""
+pack_logos.py
+Benjamin Hartmann | 10/2026
+
+Packs the bitmaps of include/MyLogos.h into include/MyLogosPacked.h.
+
+The bitmaps are converted from the drawBitmap() layout (rows, MSB first)
+into the SH1106 page layout (columns of 8 px, LSB at the top) and run-length
+encoded, so MyPackedBitmap can decode them straight into the frame buffer.
+Animations (a NAME_FRAMES define) store the first frame in full and every
+other frame as the XOR with its predecessor, plus one delta from the last
+frame back to the first for loops. A still image that does not get smaller
+is stored unencoded.
+
+Stream format, one control byte followed by its data:
+  0x00-0x7F  c + 1 literal bytes follow
+  0x80-0xFF  the next byte is repeated (c & 0x7F) + 2 times
+
+Runs as a PlatformIO pre-build script (extra_scripts in platformio.ini) and
+only rewrites the header when its content changes. Can also be run by hand:
+  python tools/pack_logos.py [--bench]
+--bench also times the reference decoder on the host.
+"""
+
+import os
+import re
+import sys
+import time
+
+RUN_MIN = 2
+RUN_MAX = 0x7F + RUN_MIN
+LITERAL_MAX = 0x80
+
+LOGOS = "include/MyLogos.h"
+PACKED = "include/MyLogosPacked.h"
+
+
+def parse_logos(text):
+    """Bitmaps of MyLogos.h as (name, prefix, width, height, frames, data)."""
+    defines = dict(re.findall(r"#define\s+(\w+)\s+(\d+)", text))
+    logos = []
+    for name, body in re.findall(
+            r"PROGMEM\s+(\w+)Bmp\[\]\s*=\s*\{(.*?)\};", text, re.S):
+        prefix = re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", name).upper()
+        width = int(defines[prefix + "_WIDTH"])
+        height = int(defines[prefix + "_HEIGHT"])
+        frames = int(defines.get(prefix + "_FRAMES", 1))
+        data = [int(v[1:], 2) if v.startswith("B") else int(v, 0)
+                for v in re.findall(r"0x[0-9a-fA-F]+|B[01]{8}", body)]
+        stride = (width + 7) // 8 * height
+        if len(data) != stride * frames:
+            raise ValueError("%sBmp: %d bytes, expected %d"
+                             % (name, len(data), stride * frames))
+        logos.append((name, prefix, width, height, frames,
+                      [data[f * stride:(f + 1) * stride]
+                       for f in range(frames)]))
+    return logos
+
+
+def to_pages(rows, width, height):
+    """drawBitmap() rows to page layout: pages x width column bytes."""
+    row_bytes = (width + 7) // 8
+    pages = (height + 7) // 8
+    out = []
+    for page in range(pages):
+        for x in range(width):
+            column = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < height and rows[y * row_bytes + x // 8] & (0x80 >> (x & 7)):
+                    column |= 1 << bit
+            out.append(column)
+    return out
+
+
+def encode(data):
+    out = []
+    literal = []
+
+    def flush():
+        if literal:
+            out.append(len(literal) - 1)
+            out.extend(literal)
+            del literal[:]
+
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < RUN_MAX:
+            run += 1
+        # A run of two only pays off if it does not split a literal
+        if run > RUN_MIN or (run == RUN_MIN and not literal):
+            flush()
+            out += [0x80 | (run - RUN_MIN), data[i]]
+            i += run
+        else:
+            literal.append(data[i])
+            i += 1
+            if len(literal) == LITERAL_MAX:
+                flush()
+    flush()
+    return out
+
+
+def decode(stream, size):
+    """Reference decoder, mirrors MyPackedBitmap::unpack()."""
+    out = []
+    i = 0
+    while len(out) < size:
+        c = stream[i]
+        i += 1
+        if c & 0x80:
+            out += [stream[i]] * ((c & 0x7F) + RUN_MIN)
+            i += 1
+        else:
+            out += stream[i:i + c + 1]
+            i += c + 1
+    if len(out) != size or i != len(stream):
+        raise ValueError("stream does not decode to %d bytes" % size)
+    return out
+
+
+def pack(frames):
+    """Streams of one bitmap: the first frame, then the deltas.
+    @return streams, encoded streams and whether they are run-length encoded
+    """
+    streams = [frames[0]]
+    if len(frames) > 1:
+        for f in range(1, len(frames) + 1):
+            prev, cur = frames[f - 1], frames[f % len(frames)]
+            streams.append([a ^ b for a, b in zip(prev, cur)])
+    packed = [encode(s) for s in streams]
+    for raw, enc in zip(streams, packed):
+        assert decode(enc, len(raw)) == raw
+    if len(frames) == 1 and len(packed[0]) >= len(streams[0]):
+        return streams, streams, False
+    return streams, packed, True
+
+
+def c_bytes(data, indent="    "):
+    lines = []
+    for i in range(0, len(data), 12):
+        lines.append(indent + ", ".join("0x%02x" % b for b in data[i:i + 12]))
+    return ",\n".join(lines)
+
+
+def lower_camel(name):
+    return name[0].lower() + name[1:]
+
+
+def generate(logos):
+    out = [
+        "/**",
+        " * MyLogosPacked.h",
+        " * Generated by tools/pack_logos.py from MyLogos.h, do not edit.",
+        " *",
+        " * Run-length encoded page layout bitmaps for MyPackedBitmap.",
+        " */",
+        "",
+        "#ifndef _MY_LOGOS_PACKED_H_",
+        "#define _MY_LOGOS_PACKED_H_",
+        "",
+        "#include \"MyPackedBitmap.h\"",
+        "",
+    ]
+    stats = []
+    for name, prefix, width, height, frames, data in logos:
+        pages = [to_pages(f, width, height) for f in data]
+        streams, packed, rle = pack(pages)
+        offsets = [0]
+        for p in packed:
+            offsets.append(offsets[-1] + len(p))
+        raw = sum(len(f) for f in data)
+        size = offsets[-1]
+        if frames > 1:
+            size += 2 * (len(offsets) - 1)
+
+        var = lower_camel(name) + "Packed"
+        out.append("// %s: %dx%d px, %d frame(s), %d B instead of %d B%s"
+                   % (name + "Bmp", width, height, frames, size, raw,
+                      "" if rle else ", unencoded"))
+        out.append("const uint8_t PROGMEM %sData[] = {" % var)
+        out.append(c_bytes(sum(packed, [])) + "};")
+        if frames > 1:
+            out.append("const uint16_t PROGMEM %sOffsets[] = {%s};"
+                       % (var, ", ".join(str(o) for o in offsets[:-1])))
+        out.append("const PackedBitmap %s = {%d, %d, %d, %d, %s, %d, %sData, %s};"
+                   % (var, width, height, len(pages[0]) // width, frames,
+                      "true" if rle else "false", offsets[-1], var,
+                      var + "Offsets" if frames > 1 else "nullptr"))
+        out.append("")
+        stats.append((name, raw, size, streams, packed, rle))
+    out.append("#endif  // _MY_LOGOS_PACKED_H_")
+    return "\n".join(out) + "\n", stats
+
+
+def bench(stats, iterations=200):
+    for name, raw, size, streams, packed, rle in stats:
+        if not rle:
+            continue
+        start = time.perf_counter()
+        for _ in range(iterations):
+            for stream, enc in zip(streams, packed):
+                decode(enc, len(stream))
+        us = (time.perf_counter() - start) * 1e6 / iterations
+        print("[Logos] %-16s host decode of all streams: %.1f us" % (name, us))
+
+
+def main(project_dir, benchmark=False):
+    with open(os.path.join(project_dir, LOGOS)) as f:
+        header, stats = generate(parse_logos(f.read()))
+
+    for name, raw, size, streams, packed, rle in stats:
+        print("[Logos] %-16s %5d B -> %5d B (%d%%)"
+              % (name, raw, size, size * 100 // raw))
+    if benchmark:
+        bench(stats)
+
+    path = os.path.join(project_dir, PACKED)
+    if os.path.exists(path):
+        with open(path) as f:
+            if f.read() == header:
+                return
+    with open(path, "w") as f:
+        f.write(header)
+    print("[Logos] Wrote " + PACKED)
+
+
+try:
+    Import("env")  # noqa: F821, only defined when run by PlatformIO
+    main(env["PROJECT_DIR"])  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        main(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."),
+             "--bench" in sys.argv)
@@ -0,0 +1,145 @@
+"""
+telemetry_codec.py
+Benjamin Hartmann | 10/2026
+
+Reference encoder and decoder of the telemetry encodings in
+include/MyTelemetryCodec.h, for subscribers and for checking the firmware.
+
+CBOR sample, one array of integers in hundredths of their unit:
+  [v, sequence, epoch, temp C, temp F, hum, pres, alt, dew, ahum, hi, tend, fc]
+tend and fc (Zambretti letter as character code) are missing while the
+pressure tendency is not known yet.
+
+Usage:
+  python tools/telemetry_codec.py <hex or base64>  decode a sample
+  python tools/telemetry_codec.py --bench          compare with JSON on the host
+e.g. mosquitto_sub -t '.../BME280_Telemetry_CBOR' -F %x | xargs -n1 python ...
+"""
+
+import base64
+import binascii
+import json
+import sys
+import time
+
+SCHEMA_VERSION = 1
+FIELDS = ["v", "sequence", "epoch", "temperatureC", "temperatureF", "humidity",
+          "pressure", "altitude", "dewPoint", "absoluteHumidity", "heatIndex",
+          "pressureTendency", "forecast"]
+
+
+def _header(out, major, value):
+    major <<= 5
+    if value < 24:
+        out.append(major | value)
+    elif value <= 0xFF:
+        out += [major | 24, value]
+    elif value <= 0xFFFF:
+        out += [major | 25] + list(value.to_bytes(2, "big"))
+    else:
+        out += [major | 26] + list(value.to_bytes(4, "big"))
+
+
+def _integer(out, value):
+    if value < 0:
+        _header(out, 1, -1 - value)
+    else:
+        _header(out, 0, value)
+
+
+def encode(sample):
+    """Sample dict with raw integer values (as decode() returns) to CBOR."""
+    items = len(FIELDS) if "forecast" in sample else len(FIELDS) - 2
+    out = []
+    _header(out, 4, items)
+    for name in FIELDS[:items]:
+        value = sample[name]
+        _integer(out, ord(value) if name == "forecast" else value)
+    return bytes(out)
+
+
+def decode(data):
+    """CBOR sample to a dict of raw integers, the forecast as letter.
+    Mirrors MyTelemetryCodec::decodeCbor()."""
+    pos = 0
+
+    def header():
+        nonlocal pos
+        initial = data[pos]
+        pos += 1
+        info = initial & 0x1F
+        if info >= 24:
+            if info > 26:
+                raise ValueError("unsupported CBOR item 0x%02x" % initial)
+            n = 1 << (info - 24)
+            info = int.from_bytes(data[pos:pos + n], "big")
+            pos += n
+        return initial >> 5, info
+
+    major, items = header()
+    if major != 4 or items not in (len(FIELDS), len(FIELDS) - 2):
+        raise ValueError("not a telemetry sample")
+    sample = {}
+    for name in FIELDS[:items]:
+        major, value = header()
+        if major == 1:
+            value = -1 - value
+        elif major != 0:
+            raise ValueError("%s is not an integer" % name)
+        sample[name] = value
+    if sample["v"] != SCHEMA_VERSION:
+        raise ValueError("schema version %d" % sample["v"])
+    if pos != len(data):
+        raise ValueError("%d trailing bytes" % (len(data) - pos))
+    if "forecast" in sample:
+        sample["forecast"] = chr(sample["forecast"])
+    return sample
+
+
+def to_json(sample):
+    """The telemetry JSON document of a sample, as MyTelemetryCodec::formatJson()
+    builds it, but with the forecast letter instead of its text."""
+    def centi(v):
+        return "%s%d.%02d" % ("-" if v < 0 else "", abs(v) // 100, abs(v) % 100)
+    keys = [("temp", "temperatureC"), ("hum", "humidity"), ("pres", "pressure"),
+            ("alt", "altitude"), ("dew", "dewPoint"),
+            ("ahum", "absoluteHumidity"), ("hi", "heatIndex")]
+    if "forecast" in sample:
+        keys.append(("tend", "pressureTendency"))
+    text = '{"v":%d,"t":%d,"seq":%d' % (sample["v"], sample["epoch"], sample["sequence"])
+    for key, name in keys:
+        text += ',"%s":%s' % (key, centi(sample[name]))
+    if "forecast" in sample:
+        text += ',"fc":%s' % json.dumps(sample["forecast"])
+    return text + "}"
+
+
+def bench(iterations=20000):
+    sample = {"v": 1, "sequence": 123456, "epoch": 1760000000, "temperatureC": 2153,
+              "temperatureF": 7075, "humidity": 4520, "pressure": 101325,
+              "altitude": 12345, "dewPoint": 893, "absoluteHumidity": 853,
+              "heatIndex": 2140, "pressureTendency": -125, "forecast": "B"}
+    assert decode(encode(sample)) == sample
+    for name, fn in (("json", to_json), ("cbor", encode),
+                     ("cbor base64", lambda s: base64.b64encode(encode(s)))):
+        start = time.perf_counter()
+        for _ in range(iterations):
+            payload = fn(sample)
+        us = (time.perf_counter() - start) * 1e6 / iterations
+        print("[Codec] %-12s %4d B  %.2f us (host)" % (name, len(payload), us))
+
+
+def main(args):
+    if "--bench" in args:
+        bench()
+        return
+    for arg in args:
+        try:
+            data = binascii.unhexlify(arg)
+        except (binascii.Error, ValueError):
+            data = base64.b64decode(arg)
+        print(json.dumps(decode(data)))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])